@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Output throughput (bytes/s of produced text) of "MatrixNiceOutputer" for every "ElementPlacing"
+ * mode on dense and sparse matrices and of "VectorNiceOutputer" for both of its modes. Text goes
+ * to a stream which only counts characters, so the numbers do not include cost of a device.
+ * "outputToSink" compares destinations (std::ofstream and the sinks of "NiceOutputSinks.h") for
+ * a dense matrix written to "/dev/null" or to memory. "outputDenseMatrixParallel" measures
+ * "ParallelMatrixNiceOutputer" with the default number of threads.
+ */
+
+#include "MatrixNiceOutputer.h"
+#include "NiceOutputSinks.h"
+#include "ParallelMatrixNiceOutputer.h"
+#include "VectorNiceOutputer.h"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <benchmark/benchmark.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+
+/**
+ * Stream buffer throwing characters away and counting them.
+ */
+class CountingBuffer: public std::streambuf {
+public:
+
+    inline CountingBuffer(): count_(0) {}
+
+    inline std::size_t getCount() const
+    {
+        return count_;
+    }
+
+protected:
+
+    virtual int_type overflow(int_type c)
+    {
+        ++count_;
+        return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(const char_type*, std::streamsize n)
+    {
+        count_ += static_cast<std::size_t>(n);
+        return n;
+    }
+
+private:
+    std::size_t count_;
+};
+
+/**
+ * Values with various lengths of text, so justifying modes have something to do.
+ */
+template<class Matrix>
+void fillMatrix(Matrix& matrix)
+{
+    boost::mt19937 engine(42);
+    boost::uniform_real<double> values(-1000, 1000);
+    for (std::size_t i = 0; i < matrix.size1(); ++i)
+        for (std::size_t j = 0; j < matrix.size2(); ++j)
+            matrix(i, j) = values(engine);
+}
+
+/**
+ * Outputs a range(0) x range(0) matrix; range(1) is the placing.
+ * @param elementCount Number of stored elements
+ */
+template<class Outputer, class Matrix>
+void outputMatrix(benchmark::State& state, const Matrix& matrix, std::size_t elementCount)
+{
+    Outputer outputer(static_cast<MatrixNiceOutputer::ElementPlacing>(state.range(1)));
+    CountingBuffer buffer;
+    std::ostream output(&buffer);
+    while (state.KeepRunning())
+        outputer(output, matrix);
+    state.SetBytesProcessed(static_cast<int64_t>(buffer.getCount()));
+    state.SetItemsProcessed(state.iterations() * elementCount);
+}
+
+void outputDenseMatrix(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    matrix<double> matr(n, n);
+    fillMatrix(matr);
+    outputMatrix<MatrixNiceOutputer>(state, matr, n * n);
+}
+
+void outputDenseMatrixParallel(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    matrix<double> matr(n, n);
+    fillMatrix(matr);
+    outputMatrix<ParallelMatrixNiceOutputer>(state, matr, n * n);
+}
+
+/**
+ * Sparse matrix with about 1% of non-zeros.
+ */
+void outputSparseMatrix(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    compressed_matrix<double> matr(n, n);
+    boost::mt19937 engine(42);
+    boost::uniform_int<std::size_t> indices(0, n - 1);
+    boost::uniform_real<double> values(-1000, 1000);
+    for (std::size_t k = 0; k < n * n / 100 + 1; ++k)
+        matr(indices(engine), indices(engine)) = values(engine);
+    outputMatrix<MatrixNiceOutputer>(state, matr, matr.nnz());
+}
+
+/**
+ * Outputs a vector of range(0) elements; range(1) is the placing.
+ */
+void outputVector(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    vector<double> vect(n);
+    boost::mt19937 engine(42);
+    boost::uniform_real<double> values(-1000, 1000);
+    for (std::size_t i = 0; i < n; ++i)
+        vect(i) = values(engine);
+
+    VectorNiceOutputer outputer(true, 1, true,
+                                static_cast<VectorNiceOutputer::ElementPlacing>(state.range(1)));
+    CountingBuffer buffer;
+    std::ostream output(&buffer);
+    while (state.KeepRunning())
+        outputer(output, vect);
+    state.SetBytesProcessed(static_cast<int64_t>(buffer.getCount()));
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+enum Destination { OFSTREAM, FILE_SINK, DESCRIPTOR_SINK, ARRAY_SINK };
+
+/**
+ * Outputs a range(0) x range(0) dense matrix BY_COLUMNS reusing buffers; range(1) is the
+ * destination.
+ */
+void outputToSink(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    matrix<double> matr(n, n);
+    fillMatrix(matr);
+
+    std::ofstream file("/dev/null");
+    std::FILE* cFile = std::fopen("/dev/null", "w");
+    int descriptor = ::open("/dev/null", O_WRONLY);
+    FileOutputSink fileSink(cFile);
+    DescriptorOutputSink descriptorSink(descriptor);
+    std::vector<char> array(n * n * 32 + 64);
+    ArrayOutputSink<char> arraySink(&array[0], array.size());
+
+    std::ostream sinkOutput(0);
+    if (state.range(1) == FILE_SINK)
+        sinkOutput.rdbuf(&fileSink);
+    else if (state.range(1) == DESCRIPTOR_SINK)
+        sinkOutput.rdbuf(&descriptorSink);
+    else if (state.range(1) == ARRAY_SINK)
+        sinkOutput.rdbuf(&arraySink);
+    std::ostream& output = state.range(1) == OFSTREAM ? file : sinkOutput;
+
+    MatrixNiceOutputer outputer(MatrixNiceOutputer::BY_COLUMNS);
+    NiceOutputBuffers<char> buffers;
+    CountingBuffer counter;
+    std::ostream countingOutput(&counter);
+    outputer(countingOutput, matr, buffers);
+    while (state.KeepRunning())
+    {
+        arraySink.rewind();
+        outputer(output, matr, buffers);
+        output.flush();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * counter.getCount()));
+
+    output.flush();
+    std::fclose(cFile);
+    ::close(descriptor);
+}
+
+void setMatrixArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "placing"});
+    benchmark->ArgsProduct({ {16, 64, 256, 1024},
+                             {MatrixNiceOutputer::SIMPLE, MatrixNiceOutputer::BY_COLUMNS,
+                              MatrixNiceOutputer::BY_EQUALWIDTH_COLUMNS,
+                              MatrixNiceOutputer::BY_STREAMED_COLUMNS,
+                              MatrixNiceOutputer::COORDINATE_LIST, MatrixNiceOutputer::COMPACT_ROWS} });
+}
+
+void setParallelArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "placing"});
+    benchmark->ArgsProduct({ {1024, 4096},
+                             {MatrixNiceOutputer::SIMPLE, MatrixNiceOutputer::BY_COLUMNS,
+                              MatrixNiceOutputer::BY_EQUALWIDTH_COLUMNS} });
+}
+
+void setSparseArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "placing"});
+    benchmark->ArgsProduct({ {256, 1024, 4096},
+                             {MatrixNiceOutputer::COORDINATE_LIST, MatrixNiceOutputer::COMPACT_ROWS} });
+}
+
+void setSinkArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "destination"});
+    benchmark->ArgsProduct({ {64, 512}, {OFSTREAM, FILE_SINK, DESCRIPTOR_SINK, ARRAY_SINK} });
+}
+
+void setVectorArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "placing"});
+    benchmark->ArgsProduct({ {1 << 10, 1 << 16, 1 << 20},
+                             {VectorNiceOutputer::SIMPLE, VectorNiceOutputer::COMPACT} });
+}
+
+} //namespace
+
+
+BENCHMARK(outputDenseMatrix)->Apply(setMatrixArguments);
+BENCHMARK(outputDenseMatrixParallel)->Apply(setParallelArguments)->UseRealTime();
+BENCHMARK(outputSparseMatrix)->Apply(setSparseArguments);
+BENCHMARK(outputVector)->Apply(setVectorArguments);
+BENCHMARK(outputToSink)->Apply(setSinkArguments);
@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fill throughput of the randomizing strategies: every partial specialization of
+ * "StdDispatchRandomizer::Dispatch_" (dense, constant, packed, banded and sparse containers and
+ * adaptors) for sizes from L1 cache to DRAM, dense fills of "ParallelDispatchRandomizer" and of the
+ * counter-based engine, and sparse fills against number of non-zeros and fill ratio. Every
+ * benchmark reports elements/s ("items_per_second") and bytes/s of stored elements.
+ */
+
+#include "RandomGenerator.h"
+#include "ParallelDispatchRandomizer.h"
+#include "BoxMullerNormalDistribution.h"
+#include "DiagonalsPattern.h"
+#include "PhiloxEngine.h"
+#include "ContainerTraits.h"
+#include <algorithm>
+#include <cstddef>
+#include <complex>
+#include <benchmark/benchmark.h>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/numeric/ublas/banded.hpp>
+#include <boost/numeric/ublas/hermitian.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_sparse.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+
+/* Generators */
+
+struct IndexDistributionCreator {
+    typedef boost::uniform_int<std::size_t> Distribution;
+
+    inline static Distribution create(std::size_t size)
+    {
+        return Distribution(0, size - 1);
+    }
+};
+
+typedef RandomGenerator<boost::mt19937, boost::uniform_real<double>, IndexDistributionCreator> StdGenerator;
+typedef RandomGenerator<boost::mt19937, BoxMullerNormalDistribution<double>, IndexDistributionCreator>
+        NormalGenerator;
+typedef RandomGenerator<boost::mt19937, boost::uniform_real<double>, IndexDistributionCreator,
+                        ParallelDispatchRandomizer> ParallelGenerator;
+typedef RandomGenerator<PhiloxEngine, boost::uniform_real<double>, IndexDistributionCreator> PhiloxGenerator;
+
+template<class Generator>
+struct Distribution_ {
+    inline static typename Generator::ItemDistribution create()
+    {
+        return typename Generator::ItemDistribution(0, 1);
+    }
+};
+
+template<>
+struct Distribution_<NormalGenerator> {
+    inline static BoxMullerNormalDistribution<double> create()
+    {
+        return BoxMullerNormalDistribution<double>(0, 1);
+    }
+};
+
+
+/* Subjects: containers created by size "n" (elements of vectors, rows & columns of matrices) */
+
+const std::size_t BAND = 8;
+
+template<class Matrix>
+struct Subject_ {
+    typedef Matrix Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return container.size1() * container.size2();
+    }
+
+    Container container;
+};
+
+template<class Value>
+struct Subject_<vector<Value> > {
+    typedef vector<Value> Container;
+
+    inline explicit Subject_(std::size_t n): container(n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return container.size();
+    }
+
+    Container container;
+};
+
+template<class Value>
+struct Subject_<scalar_matrix<Value> > {
+    typedef scalar_matrix<Value> Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    /** One value is stored */
+    inline std::size_t getElementCount() const
+    {
+        return 1;
+    }
+
+    Container container;
+};
+
+template<class Type>
+struct IsUnit_ {
+    static const bool value = false;
+};
+
+template<>
+struct IsUnit_<unit_lower> {
+    static const bool value = true;
+};
+
+template<>
+struct IsUnit_<unit_upper> {
+    static const bool value = true;
+};
+
+inline std::size_t getTriangleCount(std::size_t n, bool isUnit)
+{
+    return isUnit ? n * (n - 1) / 2 : n * (n + 1) / 2;
+}
+
+template<class Value, class Type, class Orientation>
+struct Subject_<triangular_matrix<Value,Type,Orientation> > {
+    typedef triangular_matrix<Value,Type,Orientation> Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getTriangleCount(container.size1(), IsUnit_<Type>::value);
+    }
+
+    Container container;
+};
+
+template<class Value, class Type, class Orientation>
+struct Subject_<symmetric_matrix<Value,Type,Orientation> > {
+    typedef symmetric_matrix<Value,Type,Orientation> Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getTriangleCount(container.size1(), false);
+    }
+
+    Container container;
+};
+
+template<class Value, class Type, class Orientation>
+struct Subject_<hermitian_matrix<Value,Type,Orientation> > {
+    typedef hermitian_matrix<Value,Type,Orientation> Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getTriangleCount(container.size1(), false);
+    }
+
+    Container container;
+};
+
+inline std::size_t getBandCount(std::size_t n, std::size_t lower, std::size_t upper)
+{
+    return n * (lower + upper + 1) - lower * (lower + 1) / 2 - upper * (upper + 1) / 2;
+}
+
+template<class Value, class Orientation>
+struct Subject_<banded_matrix<Value,Orientation> > {
+    typedef banded_matrix<Value,Orientation> Container;
+
+    inline explicit Subject_(std::size_t n): container(n, n, BAND, BAND) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getBandCount(container.size1(), BAND, BAND);
+    }
+
+    Container container;
+};
+
+template<class Matrix, class Type>
+struct Subject_<triangular_adaptor<Matrix,Type> > {
+    typedef triangular_adaptor<Matrix,Type> Container;
+
+    inline explicit Subject_(std::size_t n): matrix(n, n), container(matrix) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getTriangleCount(matrix.size1(), false);
+    }
+
+    Matrix matrix;
+    Container container;
+};
+
+template<class Matrix>
+struct Subject_<banded_adaptor<Matrix> > {
+    typedef banded_adaptor<Matrix> Container;
+
+    inline explicit Subject_(std::size_t n): matrix(n, n), container(matrix, BAND, BAND) {}
+
+    inline Container& get()
+    {
+        return container;
+    }
+
+    inline std::size_t getElementCount() const
+    {
+        return getBandCount(matrix.size1(), BAND, BAND);
+    }
+
+    Matrix matrix;
+    Container container;
+};
+
+
+/* Benchmarks */
+
+template<class Generator, class Subject>
+void fill(benchmark::State& state)
+{
+    typename Generator::Engine engine(42);
+    Generator generator(engine, Distribution_<Generator>::create());
+    Subject subject(static_cast<std::size_t>(state.range(0)));
+    while (state.KeepRunning())
+    {
+        generator(subject.get());
+        benchmark::ClobberMemory();
+    }
+    typedef typename Subject::Container::value_type Value;
+    std::size_t count = subject.getElementCount();
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * sizeof(Value));
+}
+
+/**
+ * Sparse containers of size "n" (elements of vectors, rows & columns of matrices) with capacity
+ * "nnz" (the randomizer fills all of it).
+ */
+template<class Vector>
+inline Vector* createSparse(std::size_t n, std::size_t nnz, boost::true_type)
+{
+    return new Vector(n, nnz);
+}
+
+template<class Matrix>
+inline Matrix* createSparse(std::size_t n, std::size_t nnz, boost::false_type)
+{
+    return new Matrix(n, n, nnz);
+}
+
+/**
+ * Sparse containers get "nnz = range(1) / 1000 * size" elements where size is "n" for vectors and
+ * "n * n" for matrices. A fresh container is made for every iteration outside of timing.
+ */
+template<class Container>
+void fillSparse(benchmark::State& state)
+{
+    typedef boost::integral_constant<bool, ContainerTraits<Container>::IS_VECTOR> IsVector;
+
+    boost::mt19937 engine(42);
+    StdGenerator generator(engine, boost::uniform_real<double>(0, 1));
+    std::size_t n = static_cast<std::size_t>(state.range(0)),
+                permille = static_cast<std::size_t>(state.range(1)),
+                size = IsVector::value ? n : n * n,
+                nnz = std::max<std::size_t>(size / 1000 * permille, 1);
+    while (state.KeepRunning())
+    {
+        state.PauseTiming();
+        Container* container = createSparse<Container>(n, nnz, IsVector());
+        state.ResumeTiming();
+        generator(*container);
+        benchmark::DoNotOptimize(container->nnz());
+        state.PauseTiming();
+        delete container;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * nnz);
+    state.SetBytesProcessed(state.iterations() * nnz * sizeof(double));
+    state.counters["nnz"] = static_cast<double>(nnz);
+    state.counters["fill_ratio"] = static_cast<double>(permille) / 1000;
+}
+
+/**
+ * Sparse matrix filled by a structured pattern (a band of 2 * BAND + 1 diagonals).
+ */
+template<class Matrix>
+void fillPattern(benchmark::State& state)
+{
+    boost::mt19937 engine(42);
+    StdGenerator generator(engine, boost::uniform_real<double>(0, 1));
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    DiagonalsPattern pattern(BAND, BAND);
+    Matrix matrix(n, n);
+    while (state.KeepRunning())
+    {
+        generator(matrix, pattern);
+        benchmark::DoNotOptimize(matrix.nnz());
+    }
+    std::size_t nnz = pattern.getNonZeroCount(n, n);
+    state.SetItemsProcessed(state.iterations() * nnz);
+    state.SetBytesProcessed(state.iterations() * nnz * sizeof(double));
+    state.counters["nnz"] = static_cast<double>(nnz);
+}
+
+
+/* Sizes: vectors from 1K to 16M elements, matrices from 32 x 32 to 4096 x 4096 (8 KB to 128 MB) */
+
+void setVectorSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->RangeMultiplier(8)->Range(1 << 10, 1 << 24);
+}
+
+void setMatrixSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->RangeMultiplier(4)->Range(32, 4096);
+}
+
+/* Vector lengths are n, matrices are n x n, fill ratios are in permille */
+
+void setSparseVectorSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "permille"});
+    benchmark->ArgsProduct({ {1 << 12, 1 << 16, 1 << 20}, {1, 10, 100, 500} });
+}
+
+void setSparseMatrixSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"n", "permille"});
+    benchmark->ArgsProduct({ {256, 1024, 4096}, {1, 10, 100} });
+}
+
+typedef matrix<double,row_major> RowMatrix;
+typedef matrix<double,column_major> ColumnMatrix;
+
+} //namespace
+
+
+/* Dense containers */
+
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<vector<double> >)->Apply(setVectorSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<RowMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<ColumnMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<vector_of_vector<double,row_major> >)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, NormalGenerator, Subject_<RowMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, ParallelGenerator, Subject_<RowMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, ParallelGenerator, Subject_<ColumnMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, PhiloxGenerator, Subject_<RowMatrix>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, PhiloxGenerator, Subject_<ColumnMatrix>)->Apply(setMatrixSizes);
+
+/* Constant containers */
+
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<scalar_matrix<double> >)->Arg(1024);
+
+/* Packed matrices & their adaptors */
+
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<triangular_matrix<double,lower,row_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<triangular_matrix<double,lower,column_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<triangular_matrix<double,unit_upper,row_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<symmetric_matrix<double,lower,row_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<symmetric_matrix<double,lower,column_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<hermitian_matrix<std::complex<double>,lower,row_major> >)
+    ->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<triangular_adaptor<RowMatrix,lower> >)->Apply(setMatrixSizes);
+
+/* Banded matrices & their adaptors */
+
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<banded_matrix<double,row_major> >)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<banded_matrix<double,column_major> >)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fill, StdGenerator, Subject_<banded_adaptor<RowMatrix> >)->Apply(setMatrixSizes);
+
+/* Sparse containers */
+
+BENCHMARK_TEMPLATE(fillSparse, mapped_vector<double>)->Apply(setSparseVectorSizes);
+BENCHMARK_TEMPLATE(fillSparse, compressed_vector<double>)->Apply(setSparseVectorSizes);
+BENCHMARK_TEMPLATE(fillSparse, coordinate_vector<double>)->Apply(setSparseVectorSizes);
+BENCHMARK_TEMPLATE(fillSparse, compressed_matrix<double>)->Apply(setSparseMatrixSizes);
+BENCHMARK_TEMPLATE(fillSparse, coordinate_matrix<double>)->Apply(setSparseMatrixSizes);
+BENCHMARK_TEMPLATE(fillPattern, compressed_matrix<double>)->Apply(setMatrixSizes);
+BENCHMARK_TEMPLATE(fillPattern, coordinate_matrix<double>)->Apply(setMatrixSizes);
@@ -18,13 +18,26 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "NumberFormatter.h"
+#include <algorithm>
+#include <cstddef>
 #include <ios>
+#include <ostream>
 #include <string>
-#include <sstream>
+#include <boost/preprocessor/config/limits.hpp>
+#include <boost/preprocessor/repetition/enum.hpp>
+#include <boost/static_assert.hpp>
 
 namespace boost { namespace numeric { namespace ublas {
 
 
+/*
+ * Number of spaces in the padding buffer. It is a macro because the buffer is initialized by
+ * preprocessor repetition.
+ */
+#define LIBUBLASAUX_PADDING_SIZE_ 64
+
+
 /**
  * Base class for "NiceOutputer"s - functors realizing nice & suitable stream output of vectors and
  * matrices. This base class contains common (for "NiceOutputer"s) properties and auxiliary methods.
@@ -66,53 +79,143 @@ public:
 protected:
 
     /**
-     * Auxiliary method. Outputs a vector in a simple way (non-justified) to stream.
+     * Auxiliary method. Appends a vector in a simple way (non-justified) to "chunk" and flushes the
+     * chunk whenever it grows over OUTPUT_CHUNK_SIZE.
      * @param output Output stream
+     * @param chunk Text gathered to be written to the stream
+     * @param formatter Formatter of elements made for the stream
      * @param vector Vector be outputed
      */
     template<class Char, class CharTraits, class Vector>
-    void outputRowSimply(std::basic_ostream<Char,CharTraits>& output, const Vector& vector) const
+    void appendRowSimply(std::basic_ostream<Char,CharTraits>& output,
+                         std::basic_string<Char,CharTraits>& chunk,
+                         const NumberFormatter<Char,CharTraits>& formatter, const Vector& vector) const
     {
         typedef typename Vector::size_type Size;
 
-        output << "(";
-
+        chunk += Char('(');
         Size size = vector.size();
         for (Size i = 0; i + 1 < size; ++i) // cannot use "i < size-1" because Size may be unsigned
-            output << vector(i) << "," << std::basic_string<Char,CharTraits>(getMinSpaces(), ' ');
+        {
+            formatter.append(chunk, vector(i));
+            chunk += Char(',');
+            appendSpaces(chunk, getMinSpaces());
+            flushChunk(output, chunk);
+        }
         if (size >= 1)
-            output << vector(size - 1);
+            formatter.append(chunk, vector(size - 1));
+        chunk += Char(')');
+    }
+
+    /**
+     * Auxiliary function. Appends decimal text of an index to a string whatever formatting flags
+     * a stream has.
+     */
+    template<class Char, class CharTraits>
+    static void appendIndex(std::basic_string<Char,CharTraits>& text, std::size_t index)
+    {
+        Char digits[3 * sizeof(std::size_t)];
+        Char* first = digits + sizeof(digits) / sizeof(Char);
+        do
+        {
+            *--first = Char('0' + index % 10);
+            index /= 10;
+        }
+        while (index != 0);
+        text.append(first, digits + sizeof(digits) / sizeof(Char));
+    }
+
+    /**
+     * Auxiliary function. Appends a text of ASCII characters to a string.
+     */
+    template<class Char, class CharTraits>
+    inline static void appendText(std::basic_string<Char,CharTraits>& text, const char* ascii)
+    {
+        while (*ascii)
+            text += Char(*ascii++);
+    }
+
+    /**
+     * Auxiliary function. Appends spaces to a string copying them from a static padding buffer.
+     */
+    template<class Char, class CharTraits>
+    static void appendSpaces(std::basic_string<Char,CharTraits>& text, StreamSize count)
+    {
+        while (count > 0)
+        {
+            StreamSize size = (std::min)(count, static_cast<StreamSize>(PADDING_SIZE));
+            text.append(Padding_<Char>::SPACES, size);
+            count -= size;
+        }
+    }
 
-        output << ")";
+    /**
+     * Auxiliary function. Writes text gathered in "chunk" to the stream and empties it when it has
+     * grown over OUTPUT_CHUNK_SIZE (or always if "isFinal" is true).
+     */
+    template<class Char, class CharTraits>
+    static void flushChunk(std::basic_ostream<Char,CharTraits>& output,
+                           std::basic_string<Char,CharTraits>& chunk, bool isFinal = false)
+    {
+        if (isFinal || chunk.size() >= OUTPUT_CHUNK_SIZE)
+        {
+            output.write(chunk.data(), chunk.size());
+            chunk.clear();
+        }
     }
 
     /**
      * Auxiliary function. Calculate length of text that will be stream output of a given value.
-     * Temporary string stream is used to do this.
      * @param output Output stream
      * @param value Value to be outputed
+     * @remark Formatting many values, keep one NumberFormatter and its text instead.
      */
     template<class Char, class CharTraits, class Value>
     static StreamSize countValueOutputSize(const std::basic_ostream<Char,CharTraits>& output,
                                            const Value& value)
     {
-        std::basic_ostringstream<Char, CharTraits, std::allocator<Char> > temp;
-        temp.flags(output.flags());
-        temp.imbue(output.getloc());
-        temp.precision(output.precision());
-
-        temp << value;
-        return temp.str().size();
+        std::basic_string<Char,CharTraits> text;
+        return NumberFormatter<Char,CharTraits>(output).append(text, value);
     }
 
 protected:
+    /* Constants */
+
+    /**
+     * Long texts are written to stream by chunks of about this size.
+     */
+    static const std::size_t OUTPUT_CHUNK_SIZE = 1 << 16;
+
+    /**
+     * Number of spaces in the padding buffer.
+     */
+    static const std::size_t PADDING_SIZE = LIBUBLASAUX_PADDING_SIZE_;
+    BOOST_STATIC_ASSERT(PADDING_SIZE > 0 && PADDING_SIZE <= BOOST_PP_LIMIT_REPEAT);
+
     /* Fields */
 
     StreamSize minSpaces_;
     bool isLineFeedAfterAll_;
 
+private:
+    /* Types */
+
+    template<class Char>
+    struct Padding_ {
+        static const Char SPACES[PADDING_SIZE];
+    };
+
 }; //class BaseNiceOutputer
 
+#define LIBUBLASAUX_PADDING_SPACE_(z, n, Char) Char(' ')
+
+template<class Char>
+const Char BaseNiceOutputer::Padding_<Char>::SPACES[BaseNiceOutputer::PADDING_SIZE] =
+    { BOOST_PP_ENUM(LIBUBLASAUX_PADDING_SIZE_, LIBUBLASAUX_PADDING_SPACE_, Char) };
+
+#undef LIBUBLASAUX_PADDING_SPACE_
+#undef LIBUBLASAUX_PADDING_SIZE_
+
 
 }}} //namespace boost::numeric::ublas
 
@@ -0,0 +1,300 @@
+#ifndef __LIBUBLASAUX_BATCHGENERATOR_H__
+#define __LIBUBLASAUX_BATCHGENERATOR_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UniformKernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Generates blocks of random values of a distribution at once. Primary template calls the
+ * distribution for every value. Specializations for common distributions draw a block of raw
+ * engine output and convert it by SIMD kernels (@see UniformKernels). Sequence of values and
+ * number of engine calls are the same as for calling the distribution "count" times.
+ * @author Anton Liaukevich
+ * @brief Batched generation of random values.
+ * @tparam Distribution Probability distribution (Boost.Random "Distribution" concept)
+ */
+template<class Distribution>
+struct BatchGenerator {
+
+    typedef typename Distribution::result_type Value;
+
+    /**
+     * True if there is a faster way than calling distribution for every value.
+     */
+    static const bool IS_BATCHED = false;
+
+    template<class Engine>
+    static void generate(Engine& engine, Distribution& dist, Value* out, std::size_t count)
+    {
+        for (std::size_t k = 0; k < count; ++k)
+            out[k] = dist(engine);
+    }
+};
+
+
+/**
+ * Common part of batched generators. Draws raw engine output by blocks and feeds it to a converter
+ * which stops at values rejected by the distribution. Kernels accept only engines producing 32-bit
+ * unsigned integers.
+ * @author Anton Liaukevich
+ */
+class BaseBatchGenerator {
+public:
+    /* Constants */
+
+    /**
+     * Number of raw values drawn at once.
+     */
+    static const std::size_t BLOCK_SIZE = 256;
+
+    /**
+     * @return true if output of engine can be converted by kernels
+     */
+    template<class Engine>
+    inline static bool isSuitableEngine(const Engine&)
+    {
+        return boost::is_same<typename Engine::result_type, boost::uint32_t>::value;
+    }
+
+    /**
+     * Fills "count" elements placed in memory with a given stride by values generated by "Batch"
+     * (@see BatchGenerator).
+     */
+    template<class Batch, class Engine, class Distribution, class Item>
+    static void fill(Engine& engine, Distribution& dist, Item* data, std::ptrdiff_t stride,
+                     std::size_t count)
+    {
+        typename Batch::Value buffer[BLOCK_SIZE];
+        while (count > 0)
+        {
+            std::size_t blockSize = (std::min)(count, std::size_t(BLOCK_SIZE));
+            Batch::generate(engine, dist, buffer, blockSize);
+            for (std::size_t k = 0; k < blockSize; ++k, data += stride)
+                *data = buffer[k];
+            count -= blockSize;
+        }
+    }
+
+protected:
+
+    /**
+     * Fills "count" values drawing exactly as many raw values as the distribution would.
+     * @param convert Functor "std::size_t (const boost::uint32_t* raw, Value* out, std::size_t n)"
+     * returning number of accepted values
+     */
+    template<class Engine, class Value, class Converter>
+    static void drive(Engine& engine, Value* out, std::size_t count, Converter& convert)
+    {
+        boost::uint32_t raw[BLOCK_SIZE];
+        std::size_t produced = 0;
+        while (produced < count)
+        {
+            std::size_t drawn = (std::min)(std::size_t(BLOCK_SIZE), count - produced);
+            for (std::size_t k = 0; k < drawn; ++k)
+                raw[k] = static_cast<boost::uint32_t>(engine() - (engine.min)());
+
+            std::size_t used = 0;
+            while (used < drawn)
+            {
+                std::size_t accepted = convert(raw + used, out + produced, drawn - used);
+                produced += accepted;
+                used += accepted;
+                if (used < drawn)
+                    ++used; // value rejected by distribution, as in its own loop
+            }
+        }
+    }
+
+    /**
+     * Calls distribution for every value (used when kernels are not applicable).
+     */
+    template<class Engine, class Distribution, class Value>
+    static void generateOneByOne(Engine& engine, Distribution& dist, Value* out, std::size_t count)
+    {
+        for (std::size_t k = 0; k < count; ++k)
+            out[k] = dist(engine);
+    }
+
+    /**
+     * @return Divisor of raw values computed in type "Real", as by Boost.Random
+     */
+    template<class Real, class Engine>
+    inline static Real divisor(const Engine& engine)
+    {
+        return static_cast<Real>(static_cast<boost::uint32_t>((engine.max)() - (engine.min)())) + 1;
+    }
+
+}; //class BaseBatchGenerator
+
+
+/**
+ * Batched generator of uniform_real distributions of "float" and "double".
+ * @author Anton Liaukevich
+ */
+template<class Distribution, class Real>
+struct UniformRealBatchGenerator: public BaseBatchGenerator {
+
+    typedef Real Value;
+
+    static const bool IS_BATCHED = true;
+
+    template<class Engine>
+    static void generate(Engine& engine, Distribution& dist, Value* out, std::size_t count)
+    {
+        Real min = (dist.min)(),
+             max = (dist.max)();
+        // Distribution halves too wide ranges (see generate_uniform_real of Boost.Random)
+        if (!isSuitableEngine(engine) || max / 2 - min / 2 > (std::numeric_limits<Real>::max)() / 2)
+        {
+            generateOneByOne(engine, dist, out, count);
+            return;
+        }
+
+        Converter_ convert(divisor<Real>(engine), max - min, min, max);
+        drive(engine, out, count, convert);
+    }
+
+private:
+
+    struct Converter_ {
+
+        inline Converter_(Real divisor, Real range, Real min, Real max):
+            divisor_(divisor), range_(range), min_(min), max_(max) {}
+
+        inline std::size_t operator()(const boost::uint32_t* raw, Real* out, std::size_t count) const
+        {
+            return UniformKernels::toReal(raw, out, count, divisor_, range_, min_, max_);
+        }
+
+        Real divisor_,
+             range_,
+             min_,
+             max_;
+    };
+};
+
+/**
+ * Batched generator of uniform_int distributions. Kernels implement the "bucket" method used when
+ * range of the distribution is narrower than range of the engine; other cases fall back to the
+ * distribution itself.
+ * @author Anton Liaukevich
+ */
+template<class Distribution, class Int>
+struct UniformIntBatchGenerator: public BaseBatchGenerator {
+
+    typedef Int Value;
+
+    static const bool IS_BATCHED = true;
+
+    template<class Engine>
+    static void generate(Engine& engine, Distribution& dist, Value* out, std::size_t count)
+    {
+        typedef typename boost::make_unsigned<Int>::type Unsigned;
+        boost::uint64_t range  = static_cast<Unsigned>(static_cast<Unsigned>((dist.max)()) -
+                                                       static_cast<Unsigned>((dist.min)())),
+                        brange = static_cast<boost::uint32_t>((engine.max)() - (engine.min)());
+        if (!isSuitableEngine(engine) || range == 0 || brange <= range)
+        {
+            generateOneByOne(engine, dist, out, count);
+            return;
+        }
+
+        boost::uint64_t bucket;
+        if (brange == 0xFFFFFFFFu)
+        {
+            bucket = brange / (range + 1);
+            if (brange % (range + 1) == range)
+                ++bucket;
+        }
+        else
+            bucket = (brange + 1) / (range + 1);
+
+        Converter_ convert(static_cast<double>(bucket), static_cast<double>(range), (dist.min)());
+        drive(engine, out, count, convert);
+    }
+
+private:
+
+    struct Converter_ {
+
+        inline Converter_(double bucket, double range, Int min):
+            bucket_(bucket), range_(range), min_(min) {}
+
+        std::size_t operator()(const boost::uint32_t* raw, Int* out, std::size_t count)
+        {
+            typedef typename boost::make_unsigned<Int>::type Unsigned;
+            std::size_t accepted = UniformKernels::toIndex(raw, quotients_, count, bucket_, range_);
+            for (std::size_t k = 0; k < accepted; ++k)
+                out[k] = static_cast<Int>(static_cast<Unsigned>(min_) +
+                                          static_cast<Unsigned>(quotients_[k]));
+            return accepted;
+        }
+
+        double bucket_,
+               range_;
+        Int min_;
+        double quotients_[BLOCK_SIZE];
+    };
+};
+
+/*
+ * Specializations for distributions of Boost.Random
+ */
+
+template<>
+struct BatchGenerator< boost::random::uniform_real_distribution<double> >:
+    public UniformRealBatchGenerator<boost::random::uniform_real_distribution<double>, double> {};
+
+template<>
+struct BatchGenerator< boost::random::uniform_real_distribution<float> >:
+    public UniformRealBatchGenerator<boost::random::uniform_real_distribution<float>, float> {};
+
+template<>
+struct BatchGenerator< boost::uniform_real<double> >:
+    public UniformRealBatchGenerator<boost::uniform_real<double>, double> {};
+
+template<>
+struct BatchGenerator< boost::uniform_real<float> >:
+    public UniformRealBatchGenerator<boost::uniform_real<float>, float> {};
+
+template<class Int>
+struct BatchGenerator< boost::random::uniform_int_distribution<Int> >:
+    public UniformIntBatchGenerator<boost::random::uniform_int_distribution<Int>, Int> {};
+
+template<class Int>
+struct BatchGenerator< boost::uniform_int<Int> >:
+    public UniformIntBatchGenerator<boost::uniform_int<Int>, Int> {};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_BATCHGENERATOR_H__
@@ -0,0 +1,1212 @@
+#ifndef __LIBUBLASAUX_BINARYSERIALIZER_H__
+#define __LIBUBLASAUX_BINARYSERIALIZER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_sparse.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/hermitian.hpp>
+#include <boost/numeric/ublas/banded.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/vector_of_vector.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Binary stream input/output of vectors and matrices: the counterpart of VectorNiceOutputer and
+ * MatrixNiceOutputer for saving data rather than showing it. A container is written as a 72-byte
+ * header (kind of storage, orientation, triangle type, kind and size of values and indices, sizes
+ * and numbers of stored elements) followed by raw arrays of its storage, each written by one call,
+ * so containers are saved and loaded at the speed of the stream. Reading checks that the header
+ * describes the same kind of container as the one being read (dense vectors of all types are
+ * compatible, as well as dense matrices of the same orientation) and resizes the container; on
+ * mismatch, sizes the container cannot have or truncated data "failbit" of the input stream is set.
+ * Files can also be mapped to memory without reading (@see MappedMatrixFile). This class implements
+ * "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Binary serialization of vectors and matrices.
+ * @remark Data are written in byte order of the machine, which is checked when reading. Values
+ * must be trivially copyable.
+ */
+class BinarySerializer {
+    friend class MappedMatrixFile;
+
+public:
+    /* Real actions */
+
+    /**
+     * Writes a container to a binary stream. It dispatches writing with nested (private)
+     * "Dispatch_" class.
+     */
+    template<class Container>
+    inline static void write(std::ostream& output, const Container& container)
+    {
+        Dispatch_<Container>::write(output, container);
+    }
+
+    /**
+     * Reads a container written by "write" replacing its contents. Sizes the container refuses
+     * ("length_error", "bad_size") set "failbit" as well.
+     */
+    template<class Container>
+    static void read(std::istream& input, Container& container)
+    {
+        Header_ header;
+        if (!readHeader_(input, header))
+            return;
+        try
+        {
+            Dispatch_<Container>::read(input, header, container);
+        }
+        catch (const std::length_error&)
+        {
+            input.setstate(std::ios_base::failbit);
+        }
+        catch (const bad_size&)
+        {
+            input.setstate(std::ios_base::failbit);
+        }
+    }
+
+private:
+    /* Types */
+
+    enum Kind {
+        DENSE = 1,
+        TRIANGULAR,
+        SYMMETRIC,
+        HERMITIAN,
+        BANDED,
+        MAPPED,
+        COMPRESSED,
+        COORDINATE,
+        ZERO,
+        UNIT,
+        IDENTITY,
+        SCALAR
+    };
+
+    enum Orientation { NO_ORIENTATION, ROW_MAJOR, COLUMN_MAJOR };
+
+    enum ValueKind { OTHER_VALUE, SIGNED_VALUE, UNSIGNED_VALUE, REAL_VALUE, COMPLEX_VALUE };
+
+    /**
+     * Header of a serialized container. "count1" and "count2" are numbers of elements of storage
+     * arrays (their meaning depends on the kind of storage).
+     */
+    struct Header_ {
+        unsigned char rank,
+                      kind,
+                      orientation,
+                      triangle,
+                      valueKind,
+                      valueSize,
+                      indexSize,
+                      indexBase;
+        boost::uint64_t size1,
+                        size2,
+                        lower,
+                        upper,
+                        count1,
+                        count2;
+    };
+
+    template<class Value>
+    struct ValueKind_ {
+        static const unsigned char VALUE = is_floating_point<Value>::value ? REAL_VALUE :
+                                           !is_integral<Value>::value ? OTHER_VALUE :
+                                           is_signed<Value>::value ? SIGNED_VALUE : UNSIGNED_VALUE;
+    };
+
+    template<class Real>
+    struct ValueKind_< std::complex<Real> > {
+        static const unsigned char VALUE = COMPLEX_VALUE;
+    };
+
+    template<class Type>
+    struct Triangle_ {
+        static const unsigned char VALUE = 0;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_lower<Z> > {
+        static const unsigned char VALUE = 1;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_unit_lower<Z> > {
+        static const unsigned char VALUE = 2;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_strict_lower<Z> > {
+        static const unsigned char VALUE = 3;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_upper<Z> > {
+        static const unsigned char VALUE = 4;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_unit_upper<Z> > {
+        static const unsigned char VALUE = 5;
+    };
+
+    template<class Z>
+    struct Triangle_< basic_strict_upper<Z> > {
+        static const unsigned char VALUE = 6;
+    };
+
+    /* Constants */
+
+    static const boost::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static const unsigned char VERSION = 1;
+
+    /**
+     * Header consists of magic, byte order mark, FIELD_COUNT_ bytes (version and type fields padded
+     * with zeros) and SIZE_COUNT_ 64-bit sizes: 72 bytes.
+     */
+    static const std::size_t MAGIC_SIZE_ = 4;
+    static const std::size_t FIELD_COUNT_ = 16;
+    static const std::size_t SIZE_COUNT_ = 6;
+    static const std::size_t HEADER_SIZE_ = MAGIC_SIZE_ + sizeof(boost::uint32_t) + FIELD_COUNT_ +
+                                            SIZE_COUNT_ * sizeof(boost::uint64_t);
+
+    /**
+     * Number of elements read at once into arrays whose size is known only from the header
+     */
+    static const std::size_t CHUNK_SIZE_ = 4096;
+
+    /* Header input/output */
+
+    inline static const char* getMagic_()
+    {
+        return "UBLX";
+    }
+
+    inline static unsigned char orientationOf_(row_major_tag)
+    {
+        return ROW_MAJOR;
+    }
+
+    inline static unsigned char orientationOf_(column_major_tag)
+    {
+        return COLUMN_MAJOR;
+    }
+
+    /**
+     * Makes header of a container type, sizes and counts are zero.
+     * @tparam Value Value type of the container
+     */
+    template<class Value>
+    static Header_ makeHeader_(unsigned char rank, Kind kind, unsigned char orientation = NO_ORIENTATION,
+                               unsigned char triangle = 0, std::size_t indexSize = 0,
+                               std::size_t indexBase = 0)
+    {
+        Header_ header;
+        std::memset(&header, 0, sizeof(header));
+        header.rank = rank;
+        header.kind = kind;
+        header.orientation = orientation;
+        header.triangle = triangle;
+        header.valueKind = ValueKind_<Value>::VALUE;
+        header.valueSize = sizeof(Value);
+        header.indexSize = static_cast<unsigned char>(indexSize);
+        header.indexBase = static_cast<unsigned char>(indexBase);
+        return header;
+    }
+
+    static void writeHeader_(std::ostream& output, const Header_& header)
+    {
+        boost::uint32_t byteOrderMark = BYTE_ORDER_MARK;
+        unsigned char fields[FIELD_COUNT_] = { VERSION, header.rank, header.kind, header.orientation,
+                                               header.triangle, header.valueKind, header.valueSize,
+                                               header.indexSize, header.indexBase };
+        boost::uint64_t sizes[SIZE_COUNT_] = { header.size1, header.size2, header.lower, header.upper,
+                                               header.count1, header.count2 };
+        output.write(getMagic_(), MAGIC_SIZE_);
+        output.write(reinterpret_cast<const char*>(&byteOrderMark), sizeof(byteOrderMark));
+        output.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+        output.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    }
+
+    static bool readHeader_(std::istream& input, Header_& header)
+    {
+        char bytes[HEADER_SIZE_];
+        input.read(bytes, HEADER_SIZE_);
+        if (!input)
+            return false;
+        if (!decodeHeader_(bytes, header))
+        {
+            input.setstate(std::ios_base::failbit);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Decodes HEADER_SIZE_ bytes written by writeHeader_.
+     * @return false if they are not a header of this version and byte order
+     */
+    static bool decodeHeader_(const char* bytes, Header_& header)
+    {
+        boost::uint32_t byteOrderMark;
+        unsigned char fields[FIELD_COUNT_];
+        boost::uint64_t sizes[SIZE_COUNT_];
+        std::memcpy(&byteOrderMark, bytes + MAGIC_SIZE_, sizeof(byteOrderMark));
+        std::memcpy(fields, bytes + MAGIC_SIZE_ + sizeof(byteOrderMark), sizeof(fields));
+        std::memcpy(sizes, bytes + MAGIC_SIZE_ + sizeof(byteOrderMark) + sizeof(fields), sizeof(sizes));
+        if (std::memcmp(bytes, getMagic_(), MAGIC_SIZE_) != 0 || byteOrderMark != BYTE_ORDER_MARK ||
+            fields[0] != VERSION)
+            return false;
+        header.rank = fields[1];
+        header.kind = fields[2];
+        header.orientation = fields[3];
+        header.triangle = fields[4];
+        header.valueKind = fields[5];
+        header.valueSize = fields[6];
+        header.indexSize = fields[7];
+        header.indexBase = fields[8];
+        header.size1 = sizes[0];
+        header.size2 = sizes[1];
+        header.lower = sizes[2];
+        header.upper = sizes[3];
+        header.count1 = sizes[4];
+        header.count2 = sizes[5];
+        return true;
+    }
+
+    /**
+     * Checks that a read header describes the expected type of container.
+     * @return false (having set "failbit") if it does not
+     */
+    static bool checkHeader_(std::istream& input, const Header_& header, const Header_& expected)
+    {
+        if (!isSameType_(header, expected))
+        {
+            input.setstate(std::ios_base::failbit);
+            return false;
+        }
+        return true;
+    }
+
+    inline static bool isSameType_(const Header_& header, const Header_& expected)
+    {
+        return header.rank == expected.rank && header.kind == expected.kind &&
+               header.orientation == expected.orientation && header.triangle == expected.triangle &&
+               header.valueKind == expected.valueKind && header.valueSize == expected.valueSize &&
+               header.indexSize == expected.indexSize && header.indexBase == expected.indexBase;
+    }
+
+    /**
+     * Checks a size or a count read from a header against the number of elements a storage array
+     * can hold. Sizes must be checked before resizing (bounded arrays only check them in debug
+     * mode) and counts after reserving (sparse containers clamp the capacity they reserve).
+     * @return false (having set "failbit") if the array is too small
+     */
+    static bool checkCount_(std::istream& input, boost::uint64_t count, std::size_t maxCount)
+    {
+        if (count > maxCount)
+        {
+            input.setstate(std::ios_base::failbit);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Checks that "size1" * "size2" elements of a dense matrix fit into a storage array.
+     */
+    static bool checkSizes_(std::istream& input, boost::uint64_t size1, boost::uint64_t size2,
+                            std::size_t maxCount)
+    {
+        return checkCount_(input, size1, size2 == 0 ? size1 : maxCount / size2);
+    }
+
+    /**
+     * Checks that a seekable stream still holds "count" values of "valueSize" bytes, so forged sizes
+     * do not make a container allocate storage for data which are not there. Streams which cannot
+     * tell their position are not checked.
+     */
+    static bool checkRemaining_(std::istream& input, boost::uint64_t count, std::size_t valueSize)
+    {
+        std::istream::pos_type position = input.tellg();
+        if (position == std::istream::pos_type(-1))
+            return true;
+        input.seekg(0, std::ios_base::end);
+        std::istream::pos_type end = input.tellg();
+        input.seekg(position);
+        if (!input || boost::uint64_t(end - position) / valueSize < count)
+        {
+            input.setstate(std::ios_base::failbit);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Checks a packed storage array before resizing a matrix: "count1" elements of the header must
+     * fit into the array and be held by the stream, and "lineCount" lines of "lineSize" elements
+     * must not be more than them. The exact number of elements is checked after resizing.
+     */
+    template<class Matrix>
+    static bool checkPacked_(std::istream& input, const Header_& header, boost::uint64_t lineCount,
+                             boost::uint64_t lineSize, const Matrix& matr)
+    {
+        return checkCount_(input, header.count1, matr.data().max_size()) &&
+               checkSizes_(input, lineCount, lineSize, std::size_t(header.count1)) &&
+               checkRemaining_(input, header.count1, sizeof(typename Matrix::value_type));
+    }
+
+    /**
+     * Checks storage of a packed triangle. Triangles without the diagonal (unit ones) are the
+     * smallest: "size" * ("size" - 1) / 2 elements, where "size" is the larger size of the matrix.
+     */
+    template<class Matrix>
+    static bool checkTriangle_(std::istream& input, const Header_& header, const Matrix& matr)
+    {
+        boost::uint64_t size = (std::max)(header.size1, header.size2);
+        if (!checkCount_(input, size, matr.data().max_size()))
+            return false;
+        return size % 2 == 0 ? checkPacked_(input, header, size / 2, size == 0 ? 0 : size - 1, matr) :
+                               checkPacked_(input, header, size, (size - 1) / 2, matr);
+    }
+
+    /**
+     * Checks storage of a band: "lower" + 1 + "upper" elements at least for every row of row-major
+     * matrices and every column of column-major ones (the default layout of newer uBLAS), every line
+     * of the larger size in the layout of older Boost versions.
+     */
+    template<class Matrix>
+    static bool checkBand_(std::istream& input, const Header_& header, const Matrix& matr)
+    {
+        if (!checkCount_(input, header.lower, matr.data().max_size()) ||
+            !checkCount_(input, header.upper, matr.data().max_size()))
+            return false;
+        boost::uint64_t lineCount =
+            boost::is_same<typename Matrix::orientation_category, column_major_tag>::value ?
+                header.size2 : header.size1;
+        return checkPacked_(input, header, lineCount, header.lower + 1 + header.upper, matr);
+    }
+
+    /* Bulk input/output of arrays */
+
+    /**
+     * Writes first "count" elements of an array (storage array or pointer) by one call.
+     */
+    template<class Array>
+    inline static void writeValues_(std::ostream& output, const Array& array, std::size_t count)
+    {
+        if (count > 0)
+            output.write(reinterpret_cast<const char*>(&array[0]), count * sizeof(array[0]));
+    }
+
+    template<class Array>
+    inline static void readValues_(std::istream& input, Array& array, std::size_t count)
+    {
+        if (count > 0)
+            input.read(reinterpret_cast<char*>(&array[0]), count * sizeof(array[0]));
+    }
+
+    /**
+     * Reads "count" elements into a vector growing it by chunks, so a forged count does not
+     * allocate more memory than the stream really holds.
+     */
+    template<class Value>
+    static void readChunks_(std::istream& input, std::vector<Value>& array, boost::uint64_t count)
+    {
+        array.clear();
+        if (!checkCount_(input, count, array.max_size()))
+            return;
+        while (array.size() < count && input)
+        {
+            std::size_t first = array.size();
+            array.resize(first + std::size_t((std::min)(count - first, boost::uint64_t(CHUNK_SIZE_))));
+            input.read(reinterpret_cast<char*>(&array[first]), (array.size() - first) * sizeof(Value));
+        }
+    }
+
+    /*
+     * Implementations for kinds of storage
+     */
+
+    /**
+     * Dense vectors (vector, bounded_vector, c_vector) with contiguous storage.
+     */
+    struct DenseVector_ {
+
+        template<class Vector>
+        static void write(std::ostream& output, const Vector& vect)
+        {
+            Header_ header = makeHeader_<typename Vector::value_type>(1, DENSE);
+            header.size1 = header.count1 = vect.size();
+            writeHeader_(output, header);
+            writeValues_(output, vect.data(), vect.size());
+        }
+
+        template<class Vector>
+        static void read(std::istream& input, const Header_& header, Vector& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<typename Vector::value_type>(1, DENSE)) ||
+                !checkCount_(input, header.size1, vect.data().max_size()))
+                return;
+            vect.resize(header.size1, false);
+            readValues_(input, vect.data(), vect.size());
+        }
+    };
+
+    /**
+     * Matrices whose elements make one array in orientation order (matrix, bounded_matrix and
+     * packed triangular, symmetric, hermitian, banded matrices).
+     */
+    struct Packed_ {
+
+        template<class Matrix>
+        static void write(std::ostream& output, const Matrix& matr, Kind kind, unsigned char triangle,
+                          std::size_t lower = 0, std::size_t upper = 0)
+        {
+            typedef typename Matrix::orientation_category Orientation;
+            Header_ header = makeHeader_<typename Matrix::value_type>(2, kind, orientationOf_(Orientation()),
+                                                                      triangle);
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            header.lower = lower;
+            header.upper = upper;
+            header.count1 = matr.data().size();
+            writeHeader_(output, header);
+            writeValues_(output, matr.data(), matr.data().size());
+        }
+
+        /**
+         * Reads storage array of a matrix which has already been resized.
+         */
+        template<class Matrix>
+        static void readData(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (header.count1 != matr.data().size())
+                input.setstate(std::ios_base::failbit);
+            else
+                readValues_(input, matr.data(), matr.data().size());
+        }
+
+        template<class Matrix>
+        static bool check(std::istream& input, const Header_& header, Kind kind, unsigned char triangle)
+        {
+            typedef typename Matrix::orientation_category Orientation;
+            return checkHeader_(input, header,
+                                makeHeader_<typename Matrix::value_type>(2, kind, orientationOf_(Orientation()),
+                                                                         triangle));
+        }
+    };
+
+    /**
+     * Dense matrices stored by separate majors (c_matrix rows, vector_of_vector majors).
+     */
+    struct Majors_ {
+
+        template<class Matrix>
+        static void write(std::ostream& output, const Matrix& matr)
+        {
+            typedef typename Matrix::orientation_category Orientation;
+            Header_ header = makeHeader_<typename Matrix::value_type>(2, DENSE, orientationOf_(Orientation()));
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            header.count1 = matr.size1() * matr.size2();
+            writeHeader_(output, header);
+            for (std::size_t k = 0; k < getMajorCount_(matr); ++k)
+                writeValues_(output, getMajor_(matr, k), getMinorCount_(matr));
+        }
+
+        template<class Matrix>
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            typedef typename Matrix::orientation_category Orientation;
+            if (!checkHeader_(input, header,
+                              makeHeader_<typename Matrix::value_type>(2, DENSE, orientationOf_(Orientation()))) ||
+                !checkMaxSizes_(input, header, matr))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            for (std::size_t k = 0; k < getMajorCount_(matr); ++k)
+            {
+                typename Matrix::value_type* major = getMajor_(matr, k);
+                readValues_(input, major, getMinorCount_(matr));
+            }
+        }
+
+    private:
+
+        template<class Item, std::size_t M, std::size_t N>
+        inline static bool checkMaxSizes_(std::istream& input, const Header_& header, const c_matrix<Item,M,N>&)
+        {
+            return checkCount_(input, header.size1, M) && checkCount_(input, header.size2, N);
+        }
+
+        /**
+         * Majors of vector_of_vector are allocated by resizing.
+         */
+        template<class Item, class Orientation, class Storage>
+        inline static bool checkMaxSizes_(std::istream&, const Header_&, const vector_of_vector<Item,Orientation,Storage>&)
+        {
+            return true;
+        }
+
+        template<class Matrix>
+        inline static std::size_t getMajorCount_(const Matrix& matr)
+        {
+            typedef typename Matrix::orientation_category Orientation;
+            return getMajorCount_(matr, Orientation());
+        }
+
+        template<class Matrix>
+        inline static std::size_t getMajorCount_(const Matrix& matr, row_major_tag)
+        {
+            return matr.size1();
+        }
+
+        template<class Matrix>
+        inline static std::size_t getMajorCount_(const Matrix& matr, column_major_tag)
+        {
+            return matr.size2();
+        }
+
+        template<class Matrix>
+        inline static std::size_t getMinorCount_(const Matrix& matr)
+        {
+            return getMajorCount_(matr) == 0 ? 0 : matr.size1() * matr.size2() / getMajorCount_(matr);
+        }
+
+        template<class Item, std::size_t M, std::size_t N>
+        inline static const Item* getMajor_(const c_matrix<Item,M,N>& matr, std::size_t k)
+        {
+            return matr.data() + k * N;
+        }
+
+        template<class Item, std::size_t M, std::size_t N>
+        inline static Item* getMajor_(c_matrix<Item,M,N>& matr, std::size_t k)
+        {
+            return matr.data() + k * N;
+        }
+
+        template<class Item, class Orientation, class Storage>
+        inline static const Item* getMajor_(const vector_of_vector<Item,Orientation,Storage>& matr, std::size_t k)
+        {
+            return matr.data()[k].begin();
+        }
+
+        template<class Item, class Orientation, class Storage>
+        inline static Item* getMajor_(vector_of_vector<Item,Orientation,Storage>& matr, std::size_t k)
+        {
+            return matr.data()[k].begin();
+        }
+    };
+
+    /**
+     * Sparse containers with associative storage (mapped_vector, mapped_matrix). Keys of the
+     * storage (linear indices of elements) and values are gathered into arrays.
+     */
+    struct Mapped_ {
+
+        template<class Container>
+        static void write(std::ostream& output, const Container& container, const Header_& type)
+        {
+            typedef typename Container::array_type Array;
+            typedef typename Array::key_type Key;
+            typedef typename Container::value_type Value;
+
+            Header_ header = type;
+            header.count1 = container.data().size();
+            writeHeader_(output, header);
+
+            std::vector<Key> keys;
+            std::vector<Value> values;
+            keys.reserve(header.count1);
+            values.reserve(header.count1);
+            for (typename Array::const_iterator it = container.data().begin(); it != container.data().end(); ++it)
+            {
+                keys.push_back(it->first);
+                values.push_back(it->second);
+            }
+            writeValues_(output, keys, keys.size());
+            writeValues_(output, values, values.size());
+        }
+
+        /**
+         * Reads storage of a container which has already been cleared and resized.
+         */
+        template<class Container>
+        static void readData(std::istream& input, const Header_& header, Container& container)
+        {
+            typedef typename Container::array_type Array;
+            typedef typename Array::key_type Key;
+            typedef typename Container::value_type Value;
+
+            std::vector<Key> keys;
+            std::vector<Value> values;
+            readChunks_(input, keys, header.count1);
+            readChunks_(input, values, header.count1);
+            if (!input)
+                return;
+            for (std::size_t k = 0; k < keys.size(); ++k)
+                container.data().insert(container.data().end(), std::make_pair(keys[k], values[k]));
+        }
+    };
+
+    /**
+     * Dispatchering class. Partial specializations of it choose implementation for a container type
+     * (in compile-time), like in StdDispatchRandomizer.
+     */
+    template<class Container>
+    struct Dispatch_ {};
+
+    /*
+     * Partial specializations for vector types
+     */
+
+    template<class Item, class Storage>
+    struct Dispatch_< vector<Item,Storage> >: public DenseVector_ {};
+
+    template<class Item, std::size_t MAX_SIZE>
+    struct Dispatch_< bounded_vector<Item,MAX_SIZE> >: public DenseVector_ {};
+
+    template<class Item, std::size_t SIZE>
+    struct Dispatch_< c_vector<Item,SIZE> > {
+
+        inline static void write(std::ostream& output, const c_vector<Item,SIZE>& vect)
+        {
+            DenseVector_::write(output, vect);
+        }
+
+        static void read(std::istream& input, const Header_& header, c_vector<Item,SIZE>& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(1, DENSE)) || !checkCount_(input, header.size1, SIZE))
+                return;
+            vect.resize(header.size1, false);
+            Item* data = vect.data();
+            readValues_(input, data, vect.size());
+        }
+    };
+
+    template<class Item, class Alloc>
+    struct Dispatch_< zero_vector<Item,Alloc> > {
+
+        inline static void write(std::ostream& output, const zero_vector<Item,Alloc>& vect)
+        {
+            Header_ header = makeHeader_<Item>(1, ZERO);
+            header.size1 = vect.size();
+            writeHeader_(output, header);
+        }
+
+        inline static void read(std::istream& input, const Header_& header, zero_vector<Item,Alloc>& vect)
+        {
+            if (checkHeader_(input, header, makeHeader_<Item>(1, ZERO)))
+                vect.resize(header.size1, false);
+        }
+    };
+
+    template<class Item, class Alloc>
+    struct Dispatch_< unit_vector<Item,Alloc> > {
+
+        inline static void write(std::ostream& output, const unit_vector<Item,Alloc>& vect)
+        {
+            Header_ header = makeHeader_<Item>(1, UNIT);
+            header.size1 = vect.size();
+            header.count1 = vect.index();
+            writeHeader_(output, header);
+        }
+
+        inline static void read(std::istream& input, const Header_& header, unit_vector<Item,Alloc>& vect)
+        {
+            if (checkHeader_(input, header, makeHeader_<Item>(1, UNIT)))
+                vect = unit_vector<Item,Alloc>(header.size1, header.count1);
+        }
+    };
+
+    template<class Item, class Alloc>
+    struct Dispatch_< scalar_vector<Item,Alloc> > {
+
+        static void write(std::ostream& output, const scalar_vector<Item,Alloc>& vect)
+        {
+            Header_ header = makeHeader_<Item>(1, SCALAR);
+            header.size1 = vect.size();
+            writeHeader_(output, header);
+            Item value = vect.size() > 0 ? vect(0) : Item();
+            writeValues_(output, &value, 1);
+        }
+
+        static void read(std::istream& input, const Header_& header, scalar_vector<Item,Alloc>& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(1, SCALAR)))
+                return;
+            Item value;
+            input.read(reinterpret_cast<char*>(&value), sizeof(value));
+            if (input)
+                vect = scalar_vector<Item,Alloc>(header.size1, value);
+        }
+    };
+
+    template<class Item, class Storage>
+    struct Dispatch_< mapped_vector<Item,Storage> > {
+
+        inline static void write(std::ostream& output, const mapped_vector<Item,Storage>& vect)
+        {
+            Header_ header = makeHeader_<Item>(1, MAPPED);
+            header.size1 = vect.size();
+            Mapped_::write(output, vect, header);
+        }
+
+        static void read(std::istream& input, const Header_& header, mapped_vector<Item,Storage>& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(1, MAPPED)))
+                return;
+            vect.resize(header.size1, false);
+            vect.clear();
+            Mapped_::readData(input, header, vect);
+        }
+    };
+
+    template<class Item, std::size_t IB, class IndexArray, class ItemArray>
+    struct Dispatch_< compressed_vector<Item,IB,IndexArray,ItemArray> > {
+
+        typedef compressed_vector<Item,IB,IndexArray,ItemArray> Vector;
+
+        static void write(std::ostream& output, const Vector& vect)
+        {
+            Header_ header = makeHeader_<Item>(1, COMPRESSED, NO_ORIENTATION, 0,
+                                               sizeof(typename IndexArray::value_type), IB);
+            header.size1 = vect.size();
+            header.count1 = vect.filled();
+            writeHeader_(output, header);
+            writeValues_(output, vect.index_data(), vect.filled());
+            writeValues_(output, vect.value_data(), vect.filled());
+        }
+
+        static void read(std::istream& input, const Header_& header, Vector& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(1, COMPRESSED, NO_ORIENTATION, 0,
+                                                               sizeof(typename IndexArray::value_type), IB)))
+                return;
+            vect.resize(header.size1, false);
+            vect.reserve(header.count1, false);
+            if (!checkCount_(input, header.count1, vect.nnz_capacity()))
+                return;
+            readValues_(input, vect.index_data(), header.count1);
+            readValues_(input, vect.value_data(), header.count1);
+            if (input)
+                vect.set_filled(header.count1);
+        }
+    };
+
+    template<class Item, std::size_t IB, class IndexArray, class ItemArray>
+    struct Dispatch_< coordinate_vector<Item,IB,IndexArray,ItemArray> > {
+
+        typedef coordinate_vector<Item,IB,IndexArray,ItemArray> Vector;
+
+        /**
+         * Elements are sorted (and duplicates summed) before writing.
+         */
+        static void write(std::ostream& output, const Vector& vect)
+        {
+            vect.sort();
+            Header_ header = makeHeader_<Item>(1, COORDINATE, NO_ORIENTATION, 0,
+                                               sizeof(typename IndexArray::value_type), IB);
+            header.size1 = vect.size();
+            header.count1 = vect.filled();
+            writeHeader_(output, header);
+            writeValues_(output, vect.index_data(), vect.filled());
+            writeValues_(output, vect.value_data(), vect.filled());
+        }
+
+        static void read(std::istream& input, const Header_& header, Vector& vect)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(1, COORDINATE, NO_ORIENTATION, 0,
+                                                               sizeof(typename IndexArray::value_type), IB)))
+                return;
+            vect.resize(header.size1, false);
+            vect.reserve(header.count1, false);
+            if (!checkCount_(input, header.count1, vect.nnz_capacity()))
+                return;
+            readValues_(input, vect.index_data(), header.count1);
+            readValues_(input, vect.value_data(), header.count1);
+            if (input)
+                vect.set_filled(header.count1, header.count1);
+        }
+    };
+
+    /*
+     * Partial specializations for dense matrix types
+     */
+
+    template<class Item, class Orientation, class Storage>
+    struct Dispatch_< matrix<Item,Orientation,Storage> > {
+
+        inline static void write(std::ostream& output, const matrix<Item,Orientation,Storage>& matr)
+        {
+            Packed_::write(output, matr, DENSE, 0);
+        }
+
+        static void read(std::istream& input, const Header_& header, matrix<Item,Orientation,Storage>& matr)
+        {
+            if (!Packed_::check<matrix<Item,Orientation,Storage> >(input, header, DENSE, 0) ||
+                !checkSizes_(input, header.size1, header.size2, matr.data().max_size()))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, std::size_t M, std::size_t N, class Orientation>
+    struct Dispatch_< bounded_matrix<Item,M,N,Orientation> > {
+
+        inline static void write(std::ostream& output, const bounded_matrix<Item,M,N,Orientation>& matr)
+        {
+            Packed_::write(output, matr, DENSE, 0);
+        }
+
+        static void read(std::istream& input, const Header_& header, bounded_matrix<Item,M,N,Orientation>& matr)
+        {
+            if (!Packed_::check<bounded_matrix<Item,M,N,Orientation> >(input, header, DENSE, 0) ||
+                !checkSizes_(input, header.size1, header.size2, matr.data().max_size()))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, std::size_t M, std::size_t N>
+    struct Dispatch_< c_matrix<Item,M,N> >: public Majors_ {};
+
+    template<class Item, class Orientation, class Storage>
+    struct Dispatch_< vector_of_vector<Item,Orientation,Storage> >: public Majors_ {};
+
+    template<class Item, class Alloc>
+    struct Dispatch_< zero_matrix<Item,Alloc> > {
+
+        inline static void write(std::ostream& output, const zero_matrix<Item,Alloc>& matr)
+        {
+            Header_ header = makeHeader_<Item>(2, ZERO);
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            writeHeader_(output, header);
+        }
+
+        inline static void read(std::istream& input, const Header_& header, zero_matrix<Item,Alloc>& matr)
+        {
+            if (checkHeader_(input, header, makeHeader_<Item>(2, ZERO)))
+                matr.resize(header.size1, header.size2, false);
+        }
+    };
+
+    template<class Item, class Alloc>
+    struct Dispatch_< identity_matrix<Item,Alloc> > {
+
+        inline static void write(std::ostream& output, const identity_matrix<Item,Alloc>& matr)
+        {
+            Header_ header = makeHeader_<Item>(2, IDENTITY);
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            writeHeader_(output, header);
+        }
+
+        inline static void read(std::istream& input, const Header_& header, identity_matrix<Item,Alloc>& matr)
+        {
+            if (checkHeader_(input, header, makeHeader_<Item>(2, IDENTITY)))
+                matr.resize(header.size1, header.size2, false);
+        }
+    };
+
+    template<class Item, class Alloc>
+    struct Dispatch_< scalar_matrix<Item,Alloc> > {
+
+        static void write(std::ostream& output, const scalar_matrix<Item,Alloc>& matr)
+        {
+            Header_ header = makeHeader_<Item>(2, SCALAR);
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            writeHeader_(output, header);
+            Item value = matr.size1() > 0 && matr.size2() > 0 ? matr(0, 0) : Item();
+            writeValues_(output, &value, 1);
+        }
+
+        static void read(std::istream& input, const Header_& header, scalar_matrix<Item,Alloc>& matr)
+        {
+            if (!checkHeader_(input, header, makeHeader_<Item>(2, SCALAR)))
+                return;
+            Item value;
+            input.read(reinterpret_cast<char*>(&value), sizeof(value));
+            if (input)
+                matr = scalar_matrix<Item,Alloc>(header.size1, header.size2, value);
+        }
+    };
+
+    /*
+     * Partial specializations for packed triangular, symmetric, hermitian, banded matrix types
+     */
+
+    template<class Item, class Type, class Orientation, class Storage>
+    struct Dispatch_< triangular_matrix<Item,Type,Orientation,Storage> > {
+
+        typedef triangular_matrix<Item,Type,Orientation,Storage> Matrix;
+
+        inline static void write(std::ostream& output, const Matrix& matr)
+        {
+            Packed_::write(output, matr, TRIANGULAR, Triangle_<Type>::VALUE);
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!Packed_::check<Matrix>(input, header, TRIANGULAR, Triangle_<Type>::VALUE) ||
+                !checkTriangle_(input, header, matr))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, class Type, class Orientation, class Storage>
+    struct Dispatch_< symmetric_matrix<Item,Type,Orientation,Storage> > {
+
+        typedef symmetric_matrix<Item,Type,Orientation,Storage> Matrix;
+
+        inline static void write(std::ostream& output, const Matrix& matr)
+        {
+            Packed_::write(output, matr, SYMMETRIC, Triangle_<Type>::VALUE);
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!Packed_::check<Matrix>(input, header, SYMMETRIC, Triangle_<Type>::VALUE) ||
+                !checkTriangle_(input, header, matr))
+                return;
+            matr.resize(header.size1, false);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, class Type, class Orientation, class Storage>
+    struct Dispatch_< hermitian_matrix<Item,Type,Orientation,Storage> > {
+
+        typedef hermitian_matrix<Item,Type,Orientation,Storage> Matrix;
+
+        inline static void write(std::ostream& output, const Matrix& matr)
+        {
+            Packed_::write(output, matr, HERMITIAN, Triangle_<Type>::VALUE);
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!Packed_::check<Matrix>(input, header, HERMITIAN, Triangle_<Type>::VALUE) ||
+                !checkTriangle_(input, header, matr))
+                return;
+            matr.resize(header.size1, false);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, class Orientation, class Storage>
+    struct Dispatch_< banded_matrix<Item,Orientation,Storage> > {
+
+        typedef banded_matrix<Item,Orientation,Storage> Matrix;
+
+        inline static void write(std::ostream& output, const Matrix& matr)
+        {
+            Packed_::write(output, matr, BANDED, 0, matr.lower(), matr.upper());
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!Packed_::check<Matrix>(input, header, BANDED, 0) ||
+                !checkBand_(input, header, matr))
+                return;
+            // resize() allocates max(size1, size2) lines whatever the orientation is, unlike the
+            // constructor whose layout has been written
+            Matrix temporary(header.size1, header.size2, header.lower, header.upper);
+            matr.swap(temporary);
+            Packed_::readData(input, header, matr);
+        }
+    };
+
+    /**
+     * @remark Adaptors are views of other matrices: serialize matrices they adapt instead.
+     */
+    template<class Matrix, class Type>
+    struct Dispatch_< triangular_adaptor<Matrix,Type> > {};
+
+    template<class Matrix, class Type>
+    struct Dispatch_< symmetric_adaptor<Matrix,Type> > {};
+
+    template<class Matrix, class Type>
+    struct Dispatch_< hermitian_adaptor<Matrix,Type> > {};
+
+    template<class Matrix>
+    struct Dispatch_< banded_adaptor<Matrix> > {};
+
+    /*
+     * Partial specializations for sparse matrix types
+     */
+
+    template<class Item, class Orientation, class Storage>
+    struct Dispatch_< mapped_matrix<Item,Orientation,Storage> > {
+
+        typedef mapped_matrix<Item,Orientation,Storage> Matrix;
+
+        inline static Header_ makeType_()
+        {
+            typedef typename Matrix::orientation_category OrientationCategory;
+            return makeHeader_<Item>(2, MAPPED, orientationOf_(OrientationCategory()));
+        }
+
+        static void write(std::ostream& output, const Matrix& matr)
+        {
+            Header_ header = makeType_();
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            Mapped_::write(output, matr, header);
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!checkHeader_(input, header, makeType_()))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            matr.clear();
+            Mapped_::readData(input, header, matr);
+        }
+    };
+
+    template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
+    struct Dispatch_< compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray> > {
+
+        typedef compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray> Matrix;
+
+        inline static Header_ makeType_()
+        {
+            typedef typename Matrix::orientation_category OrientationCategory;
+            return makeHeader_<Item>(2, COMPRESSED, orientationOf_(OrientationCategory()), 0,
+                                     sizeof(typename IndexArray::value_type), IB);
+        }
+
+        static void write(std::ostream& output, const Matrix& matr)
+        {
+            Header_ header = makeType_();
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            header.count1 = matr.filled1();
+            header.count2 = matr.filled2();
+            writeHeader_(output, header);
+            writeValues_(output, matr.index1_data(), matr.filled1());
+            writeValues_(output, matr.index2_data(), matr.filled2());
+            writeValues_(output, matr.value_data(), matr.filled2());
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!checkHeader_(input, header, makeType_()))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            if (header.count1 > matr.index1_data().size())
+            {
+                input.setstate(std::ios_base::failbit);
+                return;
+            }
+            matr.reserve(header.count2, false);
+            if (!checkCount_(input, header.count2, matr.nnz_capacity()))
+                return;
+            readValues_(input, matr.index1_data(), header.count1);
+            readValues_(input, matr.index2_data(), header.count2);
+            readValues_(input, matr.value_data(), header.count2);
+            if (input)
+                matr.set_filled(header.count1, header.count2);
+        }
+    };
+
+    template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
+    struct Dispatch_< coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray> > {
+
+        typedef coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray> Matrix;
+
+        inline static Header_ makeType_()
+        {
+            typedef typename Matrix::orientation_category OrientationCategory;
+            return makeHeader_<Item>(2, COORDINATE, orientationOf_(OrientationCategory()), 0,
+                                     sizeof(typename IndexArray::value_type), IB);
+        }
+
+        /**
+         * Elements are sorted (and duplicates summed) before writing.
+         */
+        static void write(std::ostream& output, const Matrix& matr)
+        {
+            matr.sort();
+            Header_ header = makeType_();
+            header.size1 = matr.size1();
+            header.size2 = matr.size2();
+            header.count1 = matr.filled();
+            writeHeader_(output, header);
+            writeValues_(output, matr.index1_data(), matr.filled());
+            writeValues_(output, matr.index2_data(), matr.filled());
+            writeValues_(output, matr.value_data(), matr.filled());
+        }
+
+        static void read(std::istream& input, const Header_& header, Matrix& matr)
+        {
+            if (!checkHeader_(input, header, makeType_()))
+                return;
+            matr.resize(header.size1, header.size2, false);
+            matr.reserve(header.count1, false);
+            if (!checkCount_(input, header.count1, matr.nnz_capacity()))
+                return;
+            readValues_(input, matr.index1_data(), header.count1);
+            readValues_(input, matr.index2_data(), header.count1);
+            readValues_(input, matr.value_data(), header.count1);
+            if (input)
+                matr.set_filled(header.count1);
+        }
+    };
+
+    /**
+     * @warning I couldn't create an object of any specialization of "generalized_vector_of_vector"
+     * template therefore it isn't supported.
+     */
+    template<class Item, class Orientation, class Storage>
+    struct Dispatch_< generalized_vector_of_vector<Item,Orientation,Storage> > {};
+
+}; //class BinarySerializer
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_BINARYSERIALIZER_H__
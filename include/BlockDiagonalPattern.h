@@ -0,0 +1,88 @@
+#ifndef __LIBUBLASAUX_BLOCKDIAGONALPATTERN_H__
+#define __LIBUBLASAUX_BLOCKDIAGONALPATTERN_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <boost/numeric/ublas/exception.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Sparsity pattern made of dense square blocks placed along the main diagonal
+ * (@see RandomGenerator#operator()(Container&,const Pattern&)). Blocks which do not fit the matrix
+ * are cut by its bounds.
+ * @author Anton Liaukevich
+ * @brief Block-diagonal sparsity pattern.
+ */
+class BlockDiagonalPattern {
+public:
+    /* Construct/copy/destruct */
+
+    /**
+     * @throw bad_argument If "blockSize" is zero (whatever NDEBUG is)
+     */
+    inline explicit BlockDiagonalPattern(std::size_t blockSize):
+        blockSize_(blockSize)
+    {
+        if (blockSize == 0)
+            bad_argument().raise();
+    }
+
+    /* Getters */
+
+    inline std::size_t getBlockSize() const
+    {
+        return blockSize_;
+    }
+
+    /* "SparsePattern" interface */
+
+    inline std::size_t getNonZeroCount(std::size_t size1, std::size_t size2) const
+    {
+        std::size_t count = 0;
+        for (std::size_t first = 0; first < (std::min)(size1, size2); first += blockSize_)
+            count += (std::min)(blockSize_, size1 - first) * (std::min)(blockSize_, size2 - first);
+        return count;
+    }
+
+    template<class Engine, class Sink>
+    void generate(Engine&, std::size_t size1, std::size_t size2, Sink& sink) const
+    {
+        for (std::size_t i = 0; i < size1; ++i)
+        {
+            std::size_t first = i / blockSize_ * blockSize_,
+                        last  = (std::min)(first + blockSize_, size2);
+            for (std::size_t j = first; j < last; ++j)
+                sink(i, j);
+        }
+    }
+
+private:
+    /* Fields */
+
+    std::size_t blockSize_;
+
+}; //class BlockDiagonalPattern
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_BLOCKDIAGONALPATTERN_H__
@@ -0,0 +1,240 @@
+#ifndef __LIBUBLASAUX_BOXMULLERNORMALDISTRIBUTION_H__
+#define __LIBUBLASAUX_BOXMULLERNORMALDISTRIBUTION_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Normal (Gaussian) distribution generated by the Box-Muller transform. Every pair of raw engine
+ * values gives two normal values; the second one is kept for the next call. Unlike
+ * "boost::normal_distribution" it can be generated by blocks (@see BatchGenerator): raw values are
+ * converted to uniform ones by SIMD kernels (@see UniformKernels), and the transform itself uses the
+ * same scalar code as "operator()", so results do not depend on the way the values are generated.
+ * @author Anton Liaukevich
+ * @brief Normal distribution suitable for batched generation.
+ * @tparam RealType "float" or "double"
+ * @remark Engine must produce integer values.
+ */
+template<class RealType = double>
+class BoxMullerNormalDistribution {
+public:
+    /* Types */
+
+    typedef RealType input_type;
+    typedef RealType result_type;
+
+    /* Construct/copy/destruct */
+
+    inline explicit BoxMullerNormalDistribution(RealType mean = RealType(0),
+                                                RealType sigma = RealType(1)):
+        mean_(mean), sigma_(sigma), hasCached_(false), cached_()
+    {
+        BOOST_ASSERT(sigma >= RealType(0));
+    }
+
+    /* Getters */
+
+    inline RealType mean() const
+    {
+        return mean_;
+    }
+
+    inline RealType sigma() const
+    {
+        return sigma_;
+    }
+
+    inline result_type (min)() const
+    {
+        return -(std::numeric_limits<RealType>::infinity)();
+    }
+
+    inline result_type (max)() const
+    {
+        return (std::numeric_limits<RealType>::infinity)();
+    }
+
+    /* Real actions */
+
+    /**
+     * Drops the cached second value of the last pair.
+     */
+    inline void reset()
+    {
+        hasCached_ = false;
+    }
+
+    template<class Engine>
+    result_type operator()(Engine& engine)
+    {
+        if (hasCached_)
+        {
+            hasCached_ = false;
+            return cached_;
+        }
+
+        double divisor = static_cast<double>((engine.max)() - (engine.min)()) + 1;
+        RealType realDivisor = static_cast<RealType>((engine.max)() - (engine.min)()) + 1;
+        double u1 = toOpenUnit_(static_cast<double>(engine() - (engine.min)()), divisor);
+        RealType u2 = static_cast<RealType>(engine() - (engine.min)()) / realDivisor;
+        RealType first;
+        transform_(static_cast<RealType>(u1), u2, first, cached_);
+        hasCached_ = true;
+        return first;
+    }
+
+    /**
+     * Generates "count" values, the same ones as "count" calls of operator() would give.
+     */
+    template<class Engine>
+    void generate(Engine& engine, result_type* out, std::size_t count)
+    {
+        if (count > 0 && hasCached_)
+        {
+            *out++ = cached_;
+            --count;
+            hasCached_ = false;
+        }
+        if (count == 0)
+            return;
+        if (!BaseBatchGenerator::isSuitableEngine(engine))
+        {
+            for (std::size_t k = 0; k < count; ++k)
+                out[k] = (*this)(engine);
+            return;
+        }
+
+        const std::size_t PAIRS = BaseBatchGenerator::BLOCK_SIZE / 2;
+        boost::uint32_t range = static_cast<boost::uint32_t>((engine.max)() - (engine.min)());
+        double divisor = static_cast<double>(range) + 1;
+        RealType realDivisor = static_cast<RealType>(range) + 1;
+        boost::uint32_t raw1[PAIRS],
+                        raw2[PAIRS];
+        double u1[PAIRS];
+        RealType u2[PAIRS];
+        while (count > 0)
+        {
+            std::size_t pairs = (std::min)(PAIRS, (count + 1) / 2);
+            for (std::size_t k = 0; k < pairs; ++k)
+            {
+                raw1[k] = static_cast<boost::uint32_t>(engine() - (engine.min)());
+                raw2[k] = static_cast<boost::uint32_t>(engine() - (engine.min)());
+            }
+            // u1 = 1 - x / divisor is exact in double and lies in [1 / divisor, 1], so nothing is
+            // rejected and it stays positive after rounding to "float"
+            UniformKernels::toReal(raw1, u1, pairs, divisor, -1.0, 1.0,
+                                   (std::numeric_limits<double>::infinity)());
+            UniformKernels::toReal(raw2, u2, pairs, realDivisor, RealType(1), RealType(0),
+                                   (std::numeric_limits<RealType>::infinity)());
+
+            for (std::size_t k = 0; k < pairs; ++k)
+            {
+                RealType second;
+                transform_(static_cast<RealType>(u1[k]), u2[k], *out++, second);
+                if (--count == 0)
+                {
+                    cached_ = second;
+                    hasCached_ = true;
+                    return;
+                }
+                *out++ = second;
+                --count;
+            }
+        }
+    }
+
+    /* Comparison */
+
+    friend bool operator==(const BoxMullerNormalDistribution& x, const BoxMullerNormalDistribution& y)
+    {
+        return x.mean_ == y.mean_ && x.sigma_ == y.sigma_;
+    }
+
+    friend bool operator!=(const BoxMullerNormalDistribution& x, const BoxMullerNormalDistribution& y)
+    {
+        return !(x == y);
+    }
+
+private:
+
+    /**
+     * Maps a raw value from [0, divisor) to (0, 1] as 1 - x / divisor. It is computed in double
+     * precision since "float" rounds values near "divisor" to it (and u1 to 0). Values of engines
+     * wider than 53 bits may round so too; they are taken as the least step, 1 / divisor.
+     */
+    inline static double toOpenUnit_(double x, double divisor)
+    {
+        return (std::max)(1 - x / divisor, 1 / divisor);
+    }
+
+    /**
+     * Box-Muller transform of uniform values u1 from (0, 1] and u2 from [0, 1).
+     */
+    inline void transform_(RealType u1, RealType u2, RealType& first, RealType& second) const
+    {
+        const RealType TWO_PI = static_cast<RealType>(6.28318530717958647692);
+        volatile RealType radius = std::sqrt(RealType(-2) * std::log(u1)) * sigma_,
+                          angle = TWO_PI * u2;
+        volatile RealType firstScaled = radius * std::cos(angle),
+                          secondScaled = radius * std::sin(angle);
+        first = firstScaled + mean_;
+        second = secondScaled + mean_;
+    }
+
+    /* Fields */
+
+    RealType mean_,
+             sigma_;
+    bool hasCached_;
+    RealType cached_;
+
+}; //template class BoxMullerNormalDistribution
+
+
+/**
+ * BoxMullerNormalDistribution generates blocks by itself.
+ */
+template<class RealType>
+struct BatchGenerator< BoxMullerNormalDistribution<RealType> > {
+
+    typedef RealType Value;
+
+    static const bool IS_BATCHED = true;
+
+    template<class Engine>
+    inline static void generate(Engine& engine, BoxMullerNormalDistribution<RealType>& dist,
+                                Value* out, std::size_t count)
+    {
+        dist.generate(engine, out, count);
+    }
+};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_BOXMULLERNORMALDISTRIBUTION_H__
@@ -0,0 +1,554 @@
+#ifndef __LIBUBLASAUX_CONTAINERTRAITS_H__
+#define __LIBUBLASAUX_CONTAINERTRAITS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <boost/version.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/numeric/ublas/fwd.hpp>
+#include <boost/numeric/ublas/functional.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_sparse.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/hermitian.hpp>
+#include <boost/numeric/ublas/banded.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/vector_of_vector.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/*
+ * Shapes of containers (@see ContainerTraits): which elements are stored
+ */
+
+struct UnknownShape {};
+struct DenseShape {};
+struct PackedShape {};
+struct BandedShape {};
+struct SparseShape {};
+struct ConstantShape {};
+
+/*
+ * Structures of containers (@see ContainerTraits): what values stored elements define
+ */
+
+struct GeneralStructure {};
+struct TriangularStructure {};
+struct SymmetricStructure {};
+struct HermitianStructure {};
+struct ZeroStructure {};
+struct UnitStructure {};
+struct ScalarStructure {};
+struct IdentityStructure {};
+
+
+/**
+ * Traits of a container type not described by any specialization of ContainerTraits. Every
+ * specialization derives from it (or from BaseVectorTraits, BaseMatrixTraits) and redefines only
+ * what differs.
+ * @author Anton Liaukevich
+ * @brief Default container traits.
+ */
+struct BaseContainerTraits {
+
+    typedef UnknownShape Shape;
+    typedef GeneralStructure Structure;
+
+    /**
+     * Functor of the stored triangle of uBLAS ("lower", "unit_upper" etc.) for packed shapes.
+     */
+    typedef void Triangle;
+
+    /**
+     * Functor of storage order of uBLAS ("row_major" or "column_major") for matrices.
+     */
+    typedef void Orientation;
+    typedef unknown_orientation_tag OrientationCategory;
+
+    static const bool IS_VECTOR = false;
+
+    /**
+     * Whether stored elements are kept in one array ("data()") line after line without gaps.
+     */
+    static const bool IS_CONTIGUOUS = false;
+
+    /**
+     * Whether stored elements of every line of storage order (row of a row-major matrix, column of
+     * a column-major one) are adjacent in memory.
+     */
+    static const bool IS_LINE_CONTIGUOUS = false;
+
+    /**
+     * Whether stored elements of every row are placed in memory with a constant stride, so that
+     * they can be reached from the address of the first one.
+     */
+    static const bool IS_ROW_STRIDED = false;
+
+    /**
+     * Whether a sparse container keeps its elements in arrays of sorted indices and of values.
+     */
+    static const bool IS_COMPRESSED = false;
+
+    /**
+     * Index base of index arrays of a sparse container.
+     */
+    static const std::size_t INDEX_BASE = 0;
+};
+
+struct BaseVectorTraits: public BaseContainerTraits {
+
+    static const bool IS_VECTOR = true;
+};
+
+template<class Orientation_>
+struct BaseMatrixTraits: public BaseContainerTraits {
+
+    typedef Orientation_ Orientation;
+    typedef typename Orientation_::orientation_category OrientationCategory;
+};
+
+
+/**
+ * Compile-time description of a container type: its shape, structure, storage order and layout of
+ * storage. It is the only place where uBLAS container templates are enumerated: RandomGenerator
+ * strategies, comparers and TypeReplacer choose their implementation by these traits. Every
+ * specialization also has "Rebind<New>::Answer", the same container template with elements of type
+ * "New". Containers of other types are described by specializing this template once, after that all
+ * of them use the fast implementations the traits allow.
+ * @author Anton Liaukevich
+ * @brief Traits of uBLAS container types.
+ * @tparam Container Container type
+ */
+template<class Container>
+struct ContainerTraits: public BaseContainerTraits {};
+
+/*
+ * Dense vectors
+ */
+
+template<class Item, class Storage>
+struct ContainerTraits< vector<Item,Storage> >: public BaseVectorTraits {
+    typedef DenseShape Shape;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef vector<New,Storage> Answer;
+    };
+};
+
+template<class Item, std::size_t MAX_SIZE>
+struct ContainerTraits< bounded_vector<Item,MAX_SIZE> >: public BaseVectorTraits {
+    typedef DenseShape Shape;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef bounded_vector<New,MAX_SIZE> Answer;
+    };
+};
+
+template<class Item, std::size_t SIZE>
+struct ContainerTraits< c_vector<Item,SIZE> >: public BaseVectorTraits {
+    typedef DenseShape Shape;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef c_vector<New,SIZE> Answer;
+    };
+};
+
+/*
+ * Constant vectors
+ */
+
+template<class Item, class Alloc>
+struct ContainerTraits< zero_vector<Item,Alloc> >: public BaseVectorTraits {
+    typedef ConstantShape Shape;
+    typedef ZeroStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef zero_vector<New,Alloc> Answer;
+    };
+};
+
+template<class Item, class Alloc>
+struct ContainerTraits< unit_vector<Item,Alloc> >: public BaseVectorTraits {
+    typedef ConstantShape Shape;
+    typedef UnitStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef unit_vector<New,Alloc> Answer;
+    };
+};
+
+template<class Item, class Alloc>
+struct ContainerTraits< scalar_vector<Item,Alloc> >: public BaseVectorTraits {
+    typedef ConstantShape Shape;
+    typedef ScalarStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef scalar_vector<New,Alloc> Answer;
+    };
+};
+
+/*
+ * Sparse vectors
+ */
+
+template<class Item, class Storage>
+struct ContainerTraits< mapped_vector<Item,Storage> >: public BaseVectorTraits {
+    typedef SparseShape Shape;
+
+    template<class New>
+    struct Rebind {
+        typedef mapped_vector<New,Storage> Answer;
+    };
+};
+
+template<class Item, std::size_t IB, class IndexArray, class ItemArray>
+struct ContainerTraits< compressed_vector<Item,IB,IndexArray,ItemArray> >: public BaseVectorTraits {
+    typedef SparseShape Shape;
+    static const bool IS_COMPRESSED = true;
+    static const std::size_t INDEX_BASE = IB;
+
+    template<class New>
+    struct Rebind {
+        typedef compressed_vector<New,IB,IndexArray,ItemArray> Answer;
+    };
+};
+
+template<class Item, std::size_t IB, class IndexArray, class ItemArray>
+struct ContainerTraits< coordinate_vector<Item,IB,IndexArray,ItemArray> >: public BaseVectorTraits {
+    typedef SparseShape Shape;
+    static const std::size_t INDEX_BASE = IB;
+
+    template<class New>
+    struct Rebind {
+        typedef coordinate_vector<New,IB,IndexArray,ItemArray> Answer;
+    };
+};
+
+/*
+ * Dense matrices
+ */
+
+template<class Item, class Orientation, class Storage>
+struct ContainerTraits< matrix<Item,Orientation,Storage> >: public BaseMatrixTraits<Orientation> {
+    typedef DenseShape Shape;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef matrix<New,Orientation,Storage> Answer;
+    };
+};
+
+template<class Item, std::size_t M, std::size_t N, class Orientation>
+struct ContainerTraits< bounded_matrix<Item,M,N,Orientation> >: public BaseMatrixTraits<Orientation> {
+    typedef DenseShape Shape;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef bounded_matrix<New,M,N,Orientation> Answer;
+    };
+};
+
+/**
+ * Rows of "c_matrix" are padded up to N elements.
+ */
+template<class Item, std::size_t M, std::size_t N>
+struct ContainerTraits< c_matrix<Item,M,N> >: public BaseMatrixTraits<row_major> {
+    typedef DenseShape Shape;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED = true;
+
+    template<class New>
+    struct Rebind {
+        typedef c_matrix<New,M,N> Answer;
+    };
+};
+
+template<class Item, class Orientation, class Storage>
+struct ContainerTraits< vector_of_vector<Item,Orientation,Storage> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef DenseShape Shape;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED =
+        is_same<typename Orientation::orientation_category, row_major_tag>::value;
+
+    template<class New>
+    struct Rebind {
+        typedef vector_of_vector<New,Orientation,Storage> Answer;
+    };
+};
+
+/*
+ * Constant matrices
+ */
+
+template<class Item, class Alloc>
+struct ContainerTraits< zero_matrix<Item,Alloc> >: public BaseContainerTraits {
+    typedef ConstantShape Shape;
+    typedef ZeroStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef zero_matrix<New,Alloc> Answer;
+    };
+};
+
+template<class Item, class Alloc>
+struct ContainerTraits< identity_matrix<Item,Alloc> >: public BaseContainerTraits {
+    typedef ConstantShape Shape;
+    typedef IdentityStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef identity_matrix<New,Alloc> Answer;
+    };
+};
+
+template<class Item, class Alloc>
+struct ContainerTraits< scalar_matrix<Item,Alloc> >: public BaseContainerTraits {
+    typedef ConstantShape Shape;
+    typedef ScalarStructure Structure;
+
+    template<class New>
+    struct Rebind {
+        typedef scalar_matrix<New,Alloc> Answer;
+    };
+};
+
+/*
+ * Packed triangular, symmetric and hermitian matrices & their adaptors. Only the stored triangle of
+ * a packed matrix is kept in its storage
+ */
+
+template<class Item, class Type, class Orientation, class Storage>
+struct ContainerTraits< triangular_matrix<Item,Type,Orientation,Storage> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef PackedShape Shape;
+    typedef TriangularStructure Structure;
+    typedef Type Triangle;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+    static const bool IS_ROW_STRIDED =
+        is_same<typename Orientation::orientation_category, row_major_tag>::value;
+
+    template<class New>
+    struct Rebind {
+        typedef triangular_matrix<New,Type,Orientation,Storage> Answer;
+    };
+};
+
+template<class Matrix, class Type>
+struct ContainerTraits< triangular_adaptor<Matrix,Type> >: public BaseContainerTraits {
+    typedef PackedShape Shape;
+    typedef TriangularStructure Structure;
+    typedef Type Triangle;
+    typedef typename ContainerTraits<Matrix>::Orientation Orientation;
+    typedef typename ContainerTraits<Matrix>::OrientationCategory OrientationCategory;
+
+    template<class New>
+    struct Rebind {
+        typedef typename ContainerTraits<Matrix>::template Rebind<New>::Answer MatrixAnswer; // recursive!
+        typedef triangular_adaptor<MatrixAnswer,Type> Answer;
+    };
+};
+
+template<class Item, class Type, class Orientation, class Storage>
+struct ContainerTraits< symmetric_matrix<Item,Type,Orientation,Storage> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef PackedShape Shape;
+    typedef SymmetricStructure Structure;
+    typedef Type Triangle;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+
+    template<class New>
+    struct Rebind {
+        typedef symmetric_matrix<New,Type,Orientation,Storage> Answer;
+    };
+};
+
+template<class Matrix, class Type>
+struct ContainerTraits< symmetric_adaptor<Matrix,Type> >: public BaseContainerTraits {
+    typedef PackedShape Shape;
+    typedef SymmetricStructure Structure;
+    typedef Type Triangle;
+    typedef typename ContainerTraits<Matrix>::Orientation Orientation;
+    typedef typename ContainerTraits<Matrix>::OrientationCategory OrientationCategory;
+
+    template<class New>
+    struct Rebind {
+        typedef typename ContainerTraits<Matrix>::template Rebind<New>::Answer MatrixAnswer; // recursive!
+        typedef symmetric_adaptor<MatrixAnswer,Type> Answer;
+    };
+};
+
+template<class Item, class Type, class Orientation, class Storage>
+struct ContainerTraits< hermitian_matrix<Item,Type,Orientation,Storage> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef PackedShape Shape;
+    typedef HermitianStructure Structure;
+    typedef Type Triangle;
+    static const bool IS_CONTIGUOUS = true;
+    static const bool IS_LINE_CONTIGUOUS = true;
+
+    template<class New>
+    struct Rebind {
+        typedef hermitian_matrix<New,Type,Orientation,Storage> Answer;
+    };
+};
+
+template<class Matrix, class Type>
+struct ContainerTraits< hermitian_adaptor<Matrix,Type> >: public BaseContainerTraits {
+    typedef PackedShape Shape;
+    typedef HermitianStructure Structure;
+    typedef Type Triangle;
+    typedef typename ContainerTraits<Matrix>::Orientation Orientation;
+    typedef typename ContainerTraits<Matrix>::OrientationCategory OrientationCategory;
+
+    template<class New>
+    struct Rebind {
+        typedef typename ContainerTraits<Matrix>::template Rebind<New>::Answer MatrixAnswer; // recursive!
+        typedef hermitian_adaptor<MatrixAnswer,Type> Answer;
+    };
+};
+
+/*
+ * Banded matrices & their adaptors
+ */
+
+/**
+ * Every layout of banded storage places a row with a constant stride, except the one of
+ * BOOST_UBLAS_OWN_BANDED where the stride changes on the diagonal. Lines are contiguous only in
+ * the default (LAPACK) layout of newer uBLAS; older Boost versions have the layout of
+ * BOOST_UBLAS_LEGACY_BANDED by default, so the trait is kept for versions known to have the new
+ * one.
+ */
+template<class Item, class Orientation, class Storage>
+struct ContainerTraits< banded_matrix<Item,Orientation,Storage> >: public BaseMatrixTraits<Orientation> {
+    typedef BandedShape Shape;
+#if BOOST_VERSION >= 105800 && !defined(BOOST_UBLAS_OWN_BANDED) && !defined(BOOST_UBLAS_LEGACY_BANDED)
+    static const bool IS_LINE_CONTIGUOUS = true;
+#endif
+#ifndef BOOST_UBLAS_OWN_BANDED
+    static const bool IS_ROW_STRIDED = true;
+#endif
+
+    template<class New>
+    struct Rebind {
+        typedef banded_matrix<New,Orientation,Storage> Answer;
+    };
+};
+
+template<class Matrix>
+struct ContainerTraits< banded_adaptor<Matrix> >: public BaseContainerTraits {
+    typedef BandedShape Shape;
+    typedef typename ContainerTraits<Matrix>::Orientation Orientation;
+    typedef typename ContainerTraits<Matrix>::OrientationCategory OrientationCategory;
+
+    template<class New>
+    struct Rebind {
+        typedef typename ContainerTraits<Matrix>::template Rebind<New>::Answer MatrixAnswer; // recursive!
+        typedef banded_adaptor<MatrixAnswer> Answer;
+    };
+};
+
+/*
+ * Sparse matrices
+ */
+
+template<class Item, class Orientation, class Storage>
+struct ContainerTraits< mapped_matrix<Item,Orientation,Storage> >: public BaseMatrixTraits<Orientation> {
+    typedef SparseShape Shape;
+
+    template<class New>
+    struct Rebind {
+        typedef mapped_matrix<New,Orientation,Storage> Answer;
+    };
+};
+
+template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
+struct ContainerTraits< compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef SparseShape Shape;
+    static const bool IS_COMPRESSED = true;
+    static const std::size_t INDEX_BASE = IB;
+
+    template<class New>
+    struct Rebind {
+        typedef compressed_matrix<New,Orientation,IB,IndexArray,ItemArray> Answer;
+    };
+};
+
+template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
+struct ContainerTraits< coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef SparseShape Shape;
+    static const std::size_t INDEX_BASE = IB;
+
+    template<class New>
+    struct Rebind {
+        typedef coordinate_matrix<New,Orientation,IB,IndexArray,ItemArray> Answer;
+    };
+};
+
+template<class Item, class Orientation, class Storage>
+struct ContainerTraits< generalized_vector_of_vector<Item,Orientation,Storage> >:
+    public BaseMatrixTraits<Orientation>
+{
+    typedef SparseShape Shape;
+
+    template<class New>
+    struct Rebind {
+        typedef generalized_vector_of_vector<New,Orientation,Storage> Answer;
+    };
+};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_CONTAINERTRAITS_H__
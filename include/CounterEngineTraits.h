@@ -0,0 +1,53 @@
+#ifndef __LIBUBLASAUX_COUNTERENGINETRAITS_H__
+#define __LIBUBLASAUX_COUNTERENGINETRAITS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Describes whether a random-generating engine is counter-based, i.e. whether it can be positioned
+ * directly at any element of a container. Randomizers call "seek" before generating every element;
+ * for usual (sequential) engines it does nothing and is optimized out. Counter-based engines
+ * specialize this template (@see PhiloxEngine).
+ * @author Anton Liaukevich
+ * @brief Traits of random-generating engines used by "DispatchRandomizer" strategies.
+ * @tparam Engine Engine type
+ */
+template<class Engine>
+struct CounterEngineTraits {
+
+    static const bool IS_COUNTER_BASED = false;
+
+    /**
+     * Positions engine of a "variate_generator" at element (i, j) of a container.
+     * @param die "variate_generator" object
+     * @param i Row (index of vector element)
+     * @param j Column (zero for vectors)
+     */
+    template<class Die>
+    inline static void seek(Die& /*die*/, boost::uint64_t /*i*/, boost::uint64_t /*j*/) {}
+};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_COUNTERENGINETRAITS_H__
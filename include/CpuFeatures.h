@@ -0,0 +1,105 @@
+#ifndef __LIBUBLASAUX_CPUFEATURES_H__
+#define __LIBUBLASAUX_CPUFEATURES_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SIMD kernels of this library are compiled with per-function target attributes of GCC (and
+ * compatible compilers) on x86-64 and are chosen at runtime. Define LIBUBLASAUX_NO_SIMD to build
+ * only scalar code.
+ */
+#if !defined(LIBUBLASAUX_NO_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#define LIBUBLASAUX_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Runtime detection of instruction sets used by SIMD kernels of this library. This class implements
+ * "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Runtime CPU dispatch for SIMD kernels.
+ */
+class CpuFeatures {
+public:
+    /* Types */
+
+    /**
+     * Instruction sets in ascending order.
+     */
+    enum SimdLevel { SCALAR, AVX2, AVX512 };
+
+    /* Real actions */
+
+    /**
+     * @return The best instruction set supported both by the CPU and by this build.
+     */
+    inline static SimdLevel getSupportedLevel()
+    {
+        static const SimdLevel level = detect_();
+        return level;
+    }
+
+    /**
+     * @return Instruction set kernels actually use: supported one limited by user's setting
+     * (@see setLevelLimit).
+     */
+    inline static SimdLevel getLevel()
+    {
+        SimdLevel supported = getSupportedLevel();
+        return levelLimit_() < supported ? levelLimit_() : supported;
+    }
+
+    /**
+     * Limits instruction set kernels use. Results of kernels do not depend on it; it is useful to
+     * compare or benchmark code paths.
+     * @warning Not thread-safe.
+     */
+    inline static void setLevelLimit(SimdLevel limit)
+    {
+        levelLimit_() = limit;
+    }
+
+private:
+
+    static SimdLevel detect_()
+    {
+#ifdef LIBUBLASAUX_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2;
+#endif
+        return SCALAR;
+    }
+
+    inline static SimdLevel& levelLimit_()
+    {
+        static SimdLevel limit = AVX512;
+        return limit;
+    }
+
+}; //class CpuFeatures
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_CPUFEATURES_H__
@@ -0,0 +1,113 @@
+#ifndef __LIBUBLASAUX_DIAGONALSPATTERN_H__
+#define __LIBUBLASAUX_DIAGONALSPATTERN_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/utility/enable_if.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Sparsity pattern made of whole diagonals (@see RandomGenerator#operator()(Container&,const Pattern&)).
+ * Diagonal with offset "d" consists of elements (i, i + d): main diagonal has offset 0, diagonals
+ * above it have positive offsets and ones below it have negative offsets.
+ * @author Anton Liaukevich
+ * @brief "k-diagonal" sparsity pattern.
+ */
+class DiagonalsPattern {
+public:
+    /* Types */
+
+    typedef std::ptrdiff_t Offset;
+
+    /* Construct/copy/destruct */
+
+    /**
+     * Constructs pattern of a band: "lower" diagonals below the main one, the main diagonal and
+     * "upper" diagonals above it.
+     */
+    inline DiagonalsPattern(std::size_t lower, std::size_t upper)
+    {
+        for (Offset offset = -Offset(lower); offset <= Offset(upper); ++offset)
+            offsets_.push_back(offset);
+    }
+
+    /**
+     * Constructs pattern of arbitrary diagonals given by a range of offsets (in any order, repeated
+     * offsets are ignored). Two integers are not taken for a range: they are "lower" and "upper"
+     * of the constructor above whatever integer type they have.
+     */
+    template<class InputIterator>
+    inline DiagonalsPattern(InputIterator first, InputIterator last,
+                            typename disable_if< is_integral<InputIterator> >::type* = 0):
+        offsets_(first, last)
+    {
+        std::sort(offsets_.begin(), offsets_.end());
+        offsets_.erase(std::unique(offsets_.begin(), offsets_.end()), offsets_.end());
+    }
+
+    /* Getters */
+
+    inline const std::vector<Offset>& getOffsets() const
+    {
+        return offsets_;
+    }
+
+    /* "SparsePattern" interface */
+
+    inline std::size_t getNonZeroCount(std::size_t size1, std::size_t size2) const
+    {
+        std::size_t count = 0;
+        for (std::vector<Offset>::const_iterator it = offsets_.begin(); it != offsets_.end(); ++it)
+        {
+            Offset first = (std::max)(Offset(0), -*it),
+                   last  = (std::min)(Offset(size1), Offset(size2) - *it);
+            if (first < last)
+                count += last - first;
+        }
+        return count;
+    }
+
+    template<class Engine, class Sink>
+    void generate(Engine&, std::size_t size1, std::size_t size2, Sink& sink) const
+    {
+        for (std::size_t i = 0; i < size1; ++i)
+            for (std::vector<Offset>::const_iterator it = offsets_.begin(); it != offsets_.end(); ++it)
+            {
+                Offset j = Offset(i) + *it;
+                if (j >= 0 && j < Offset(size2))
+                    sink(i, std::size_t(j));
+            }
+    }
+
+private:
+    /* Fields */
+
+    std::vector<Offset> offsets_;
+
+}; //class DiagonalsPattern
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_DIAGONALSPATTERN_H__
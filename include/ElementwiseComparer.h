@@ -0,0 +1,436 @@
+#ifndef __LIBUBLASAUX_ELEMENTWISECOMPARER_H__
+#define __LIBUBLASAUX_ELEMENTWISECOMPARER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ContainerTraits.h"
+#include "ErrorKernels.h"
+#include "MismatchReport.h"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/numeric/ublas/traits.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Comparer of vectors and matrices element by element with absolute, relative or ULP tolerance
+ * (@see ErrorKernels#Measure). It makes a single pass over both operands and fills a MismatchReport.
+ * Two containers of the same kind and layout (@see ContainerTraits) are compared only in their
+ * stored region line by line straight from storage: dense vectors and matrices, packed triangular
+ * (without the unit diagonal), symmetric and hermitian matrices (the stored triangle) and banded
+ * matrices with the same bandwidths (the band). Lines of float or double elements are measured by SIMD kernels. All
+ * other vectors, matrices and expressions are compared element by element (matrices row by row).
+ * Elements must be of real or complex floating point types. This class implements "Monostate"
+ * pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Elementwise comparer with structured reports.
+ */
+class ElementwiseComparer {
+public:
+    /* Types */
+
+    typedef ErrorKernels::Measure Measure;
+
+    /**
+     * Type of report of comparing two vectors or matrices.
+     */
+    template<class E1, class E2>
+    struct Report {
+        typedef typename promote_traits<typename E1::value_type,
+                                        typename E2::value_type>::promote_type Value;
+        typedef MismatchReport<typename type_traits<Value>::real_type> Answer;
+    };
+
+    /* Real actions */
+
+    /**
+     * Compares two vectors of the same size.
+     * @param tolerance Maximal error of matching elements
+     */
+    template<class E1, class E2>
+    static typename Report<E1,E2>::Answer
+    compare(const vector_expression<E1>& vector1, const vector_expression<E2>& vector2,
+            Measure measure, typename Report<E1,E2>::Answer::Real tolerance)
+    {
+        BOOST_UBLAS_CHECK(vector1().size() == vector2().size(), bad_size());
+        typename Report<E1,E2>::Answer report(tolerance);
+        compare_(report, vector1(), vector2(), measure,
+                 integral_constant<bool, IsStored_<E1,E2>::VALUE>());
+        return report;
+    }
+
+    /**
+     * Compares two matrices of the same sizes.
+     * @param tolerance Maximal error of matching elements
+     */
+    template<class E1, class E2>
+    static typename Report<E1,E2>::Answer
+    compare(const matrix_expression<E1>& matrix1, const matrix_expression<E2>& matrix2,
+            Measure measure, typename Report<E1,E2>::Answer::Real tolerance)
+    {
+        BOOST_UBLAS_CHECK(matrix1().size1() == matrix2().size1(), bad_size());
+        BOOST_UBLAS_CHECK(matrix1().size2() == matrix2().size2(), bad_size());
+        typename Report<E1,E2>::Answer report(tolerance);
+        compare_(report, matrix1(), matrix2(), measure,
+                 integral_constant<bool, IsStored_<E1,E2>::VALUE>());
+        return report;
+    }
+
+private:
+    /* Types */
+
+    typedef std::pair<std::size_t,std::size_t> Position_;
+
+    /*
+     * Layouts of storage (@see Dispatch_)
+     */
+
+    struct Generic_ {};
+    struct Dense_ {};
+
+    template<class Orientation>
+    struct DenseLayout_ {};
+
+    template<class Structure, class Triangle, class Orientation>
+    struct PackedLayout_ {};
+
+    template<class Orientation>
+    struct BandedLayout_ {};
+
+    struct GenericDispatch_ {
+        typedef Generic_ Layout;
+    };
+
+    /**
+     * Dispatchering class. Its layout is chosen by traits of a container (@see ContainerTraits).
+     * Containers with a layout other than "Generic_" keep their vector in one array (@see getData)
+     * or stored elements of every line of their matrix (row or column, of OrientationType)
+     * contiguously: "getRange(matrix, line)" returns minor indices of stored elements of a line,
+     * "getElement(matrix, i, j)" the address of a stored element and
+     * "isSameShape(matrix1, matrix2)" tells whether two matrices of the layout store the same
+     * elements.
+     */
+    template<
+             class Container,
+             class Traits = ContainerTraits<Container>,
+             class Shape = typename ContainerTraits<Container>::Shape
+            >
+    struct Dispatch_: public GenericDispatch_ {};
+
+    template<class E1, class E2>
+    struct IsStored_ {
+        typedef typename Dispatch_<E1>::Layout Layout;
+        static const bool VALUE = !is_same<Layout,Generic_>::value &&
+                                  is_same<Layout,typename Dispatch_<E2>::Layout>::value;
+    };
+
+    /* Constants */
+
+    /**
+     * Number of errors measured before they are added to a report.
+     */
+    static const std::size_t BLOCK_SIZE_ = 256;
+
+    /* Real actions */
+
+    template<class Real, class E1, class E2>
+    static void compare_(MismatchReport<Real>& report, const vector_expression<E1>& vector1,
+                         const vector_expression<E2>& vector2, Measure measure, true_type)
+    {
+        if (vector1().size() != 0)
+            compareLine_(report, Dispatch_<E1>::getData(vector1()),
+                         Dispatch_<E2>::getData(vector2()), vector1().size(), Position_(0, 0),
+                         false, measure);
+    }
+
+    template<class Real, class E1, class E2>
+    static void compare_(MismatchReport<Real>& report, const vector_expression<E1>& vector1,
+                         const vector_expression<E2>& vector2, Measure measure, false_type)
+    {
+        typedef typename Report<E1,E2>::Value Value;
+        Real errors[BLOCK_SIZE_];
+        for (std::size_t done = 0; done < vector1().size(); done += BLOCK_SIZE_)
+        {
+            std::size_t count = std::min(vector1().size() - done, std::size_t(BLOCK_SIZE_));
+            for (std::size_t k = 0; k < count; ++k)
+                errors[k] = ErrorKernels::getError(Value(vector1()(done + k)),
+                                                   Value(vector2()(done + k)), measure);
+            addErrors_(report, errors, count, Position_(done, 0), false);
+        }
+    }
+
+    template<class Real, class E1, class E2>
+    static void compare_(MismatchReport<Real>& report, const matrix_expression<E1>& matrix1,
+                         const matrix_expression<E2>& matrix2, Measure measure, true_type)
+    {
+        typedef Dispatch_<E1> Dispatch1;
+        typedef typename Dispatch1::OrientationType Orientation;
+        if (!Dispatch1::isSameShape(matrix1(), matrix2()))
+        {
+            compare_(report, matrix1, matrix2, measure, false_type());
+            return;
+        }
+
+        bool isAlongRow = is_same<typename Orientation::orientation_category,
+                                  row_major_tag>::value;
+        std::size_t lineCount = Orientation::size_M(matrix1().size1(), matrix1().size2());
+        for (std::size_t line = 0; line < lineCount; ++line)
+        {
+            std::pair<std::size_t,std::size_t> range = Dispatch1::getRange(matrix1(), line);
+            if (range.first == range.second)
+                continue;
+            std::size_t i = Orientation::index_M(line, range.first),
+                        j = Orientation::index_m(line, range.first);
+            compareLine_(report, Dispatch1::getElement(matrix1(), i, j),
+                         Dispatch_<E2>::getElement(matrix2(), i, j), range.second - range.first,
+                         Position_(i, j), isAlongRow, measure);
+        }
+    }
+
+    template<class Real, class E1, class E2>
+    static void compare_(MismatchReport<Real>& report, const matrix_expression<E1>& matrix1,
+                         const matrix_expression<E2>& matrix2, Measure measure, false_type)
+    {
+        typedef typename Report<E1,E2>::Value Value;
+        Real errors[BLOCK_SIZE_];
+        for (std::size_t i = 0; i < matrix1().size1(); ++i)
+            for (std::size_t done = 0; done < matrix1().size2(); done += BLOCK_SIZE_)
+            {
+                std::size_t count = std::min(matrix1().size2() - done, std::size_t(BLOCK_SIZE_));
+                for (std::size_t k = 0; k < count; ++k)
+                    errors[k] = ErrorKernels::getError(Value(matrix1()(i, done + k)),
+                                                       Value(matrix2()(i, done + k)), measure);
+                addErrors_(report, errors, count, Position_(i, done), true);
+            }
+    }
+
+    /**
+     * Compares successive elements of a line, the first of them having position "first".
+     */
+    template<class Real, class Item1, class Item2>
+    static void compareLine_(MismatchReport<Real>& report, const Item1* first1, const Item2* first2,
+                             std::size_t count, const Position_& first, bool isAlongRow,
+                             Measure measure)
+    {
+        Real errors[BLOCK_SIZE_];
+        for (std::size_t done = 0; done < count; done += BLOCK_SIZE_)
+        {
+            std::size_t blockSize = std::min(count - done, std::size_t(BLOCK_SIZE_));
+            computeErrors_(first1 + done, first2 + done, blockSize, measure, errors);
+            addErrors_(report, errors, blockSize, isAlongRow ?
+                       Position_(first.first, first.second + done) :
+                       Position_(first.first + done, first.second), isAlongRow);
+        }
+    }
+
+    inline static void computeErrors_(const double* first1, const double* first2, std::size_t count,
+                                      Measure measure, double* errors)
+    {
+        ErrorKernels::computeErrors(first1, first2, count, measure, errors);
+    }
+
+    inline static void computeErrors_(const float* first1, const float* first2, std::size_t count,
+                                      Measure measure, float* errors)
+    {
+        ErrorKernels::computeErrors(first1, first2, count, measure, errors);
+    }
+
+    template<class Item1, class Item2, class Real>
+    static void computeErrors_(const Item1* first1, const Item2* first2, std::size_t count,
+                               Measure measure, Real* errors)
+    {
+        typedef typename promote_traits<Item1,Item2>::promote_type Value;
+        for (std::size_t k = 0; k < count; ++k)
+            errors[k] = ErrorKernels::getError(Value(first1[k]), Value(first2[k]), measure);
+    }
+
+    template<class Real>
+    static void addErrors_(MismatchReport<Real>& report, const Real* errors, std::size_t count,
+                           const Position_& first, bool isAlongRow)
+    {
+        std::size_t worst = report.add_(errors, count);
+        if (worst != count)
+            report.worstPosition_ = isAlongRow ? Position_(first.first, first.second + worst) :
+                                                 Position_(first.first + worst, first.second);
+    }
+
+    /*
+     * Dense containers
+     */
+
+    template<class Vector>
+    struct VectorDispatch_ {
+        typedef Dense_ Layout;
+
+        inline static const typename Vector::value_type* getData(const Vector& vect)
+        {
+            return &vect.data()[0];
+        }
+    };
+
+    template<class Matrix, class Orientation>
+    struct DenseDispatch_ {
+        typedef Orientation OrientationType;
+        typedef DenseLayout_<Orientation> Layout;
+
+        template<class Other>
+        inline static bool isSameShape(const Matrix&, const Other&)
+        {
+            return true;
+        }
+
+        inline static std::pair<std::size_t,std::size_t> getRange(const Matrix& matr, std::size_t)
+        {
+            return std::make_pair(std::size_t(0), Orientation::size_m(matr.size1(), matr.size2()));
+        }
+
+        inline static const typename Matrix::value_type* getElement(const Matrix& matr,
+                                                                    std::size_t i, std::size_t j)
+        {
+            return &matr(i, j);
+        }
+    };
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,DenseShape>:
+        public mpl::if_c<Traits::IS_VECTOR ? Traits::IS_CONTIGUOUS : Traits::IS_LINE_CONTIGUOUS,
+                         typename mpl::if_c<Traits::IS_VECTOR,
+                                            VectorDispatch_<Container>,
+                                            DenseDispatch_<Container,typename Traits::Orientation>
+                                           >::type,
+                         GenericDispatch_>::type {};
+
+    /*
+     * Packed triangular, symmetric and hermitian matrices. Their stored elements are the ones
+     * their functor of triangle (of uBLAS) allows to change
+     */
+
+    template<class Matrix, class Structure, class Triangle, class Orientation>
+    struct PackedDispatch_ {
+        typedef Orientation OrientationType;
+        typedef PackedLayout_<Structure,Triangle,Orientation> Layout;
+
+        template<class Other>
+        inline static bool isSameShape(const Matrix&, const Other&)
+        {
+            return true;
+        }
+
+        inline static std::pair<std::size_t,std::size_t> getRange(const Matrix& matr,
+                                                                  std::size_t line)
+        {
+            return getRange_(matr.size1(), matr.size2(), line,
+                             typename Orientation::orientation_category());
+        }
+
+        inline static const typename Matrix::value_type* getElement(const Matrix& matr,
+                                                                    std::size_t i, std::size_t j)
+        {
+            return &matr.data()[Triangle::element(Orientation(), i, matr.size1(), j, matr.size2())];
+        }
+
+    private:
+
+        static std::pair<std::size_t,std::size_t> getRange_(std::size_t size1, std::size_t size2,
+                                                            std::size_t line, row_major_tag)
+        {
+            std::size_t begin = Triangle::mutable_restrict2(line, 0, size1, size2);
+            return std::make_pair(begin, std::max(begin, Triangle::mutable_restrict2(line, size2,
+                                                                                      size1, size2)));
+        }
+
+        static std::pair<std::size_t,std::size_t> getRange_(std::size_t size1, std::size_t size2,
+                                                            std::size_t line, column_major_tag)
+        {
+            std::size_t begin = Triangle::mutable_restrict1(0, line, size1, size2);
+            return std::make_pair(begin, std::max(begin, Triangle::mutable_restrict1(size1, line,
+                                                                                      size1, size2)));
+        }
+    };
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,PackedShape>:
+        public mpl::if_c<Traits::IS_CONTIGUOUS,
+                         PackedDispatch_<Container,typename Traits::Structure,
+                                         typename Traits::Triangle,typename Traits::Orientation>,
+                         GenericDispatch_>::type {};
+
+    /*
+     * Banded matrices (only lines of the default layout of uBLAS are contiguous)
+     */
+
+    template<class Matrix, class Orientation>
+    struct BandedDispatch_ {
+        typedef Orientation OrientationType;
+        typedef BandedLayout_<Orientation> Layout;
+
+        template<class Other>
+        inline static bool isSameShape(const Matrix& matrix1, const Other& matrix2)
+        {
+            return matrix1.lower() == matrix2.lower() && matrix1.upper() == matrix2.upper();
+        }
+
+        inline static std::pair<std::size_t,std::size_t> getRange(const Matrix& matr,
+                                                                  std::size_t line)
+        {
+            return getRange_(line, matr.lower(), matr.upper(),
+                             Orientation::size_m(matr.size1(), matr.size2()),
+                             typename Orientation::orientation_category());
+        }
+
+        inline static const typename Matrix::value_type* getElement(const Matrix& matr,
+                                                                    std::size_t i, std::size_t j)
+        {
+            return &matr(i, j);
+        }
+
+    private:
+
+        static std::pair<std::size_t,std::size_t> getRange_(std::size_t line, std::size_t lower,
+                                                            std::size_t upper, std::size_t size,
+                                                            row_major_tag)
+        {
+            std::size_t begin = std::min(line > lower ? line - lower : 0, size);
+            return std::make_pair(begin, std::min(line + upper + 1, size));
+        }
+
+        static std::pair<std::size_t,std::size_t> getRange_(std::size_t line, std::size_t lower,
+                                                            std::size_t upper, std::size_t size,
+                                                            column_major_tag)
+        {
+            return getRange_(line, upper, lower, size, row_major_tag());
+        }
+    };
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,BandedShape>:
+        public mpl::if_c<Traits::IS_LINE_CONTIGUOUS,
+                         BandedDispatch_<Container,typename Traits::Orientation>,
+                         GenericDispatch_>::type {};
+
+}; //class ElementwiseComparer
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_ELEMENTWISECOMPARER_H__
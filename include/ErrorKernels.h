@@ -0,0 +1,617 @@
+#ifndef __LIBUBLASAUX_ERRORKERNELS_H__
+#define __LIBUBLASAUX_ERRORKERNELS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CpuFeatures.h"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Kernels measuring errors between elements of two contiguous real arrays: absolute error
+ * |x - y|, relative error |x - y| / max(|x|, |y|) or distance in units in the last place (number of
+ * representable numbers between x and y). Equal elements (also equal infinities and zeros of
+ * different signs) have zero error, NaNs and infinite quotients have infinite one. SIMD and scalar
+ * code paths give bit-identical results. This class implements "Monostate" pattern (only static
+ * methods).
+ * @author Anton Liaukevich
+ * @brief SIMD computation of elementwise errors.
+ */
+class ErrorKernels {
+public:
+    /* Types */
+
+    enum Measure { ABSOLUTE, RELATIVE, ULPS };
+
+    /* Real actions */
+
+    /**
+     * Computes errors[k] = getError(x[k], y[k], measure). "Real" is float or double.
+     */
+    template<class Real>
+    static void computeErrors(const Real* x, const Real* y, std::size_t count, Measure measure,
+                              Real* errors)
+    {
+        switch (measure)
+        {
+        case ABSOLUTE:
+            computeErrors_<ABSOLUTE>(x, y, count, errors);
+            break;
+        case RELATIVE:
+            computeErrors_<RELATIVE>(x, y, count, errors);
+            break;
+        default:
+            computeErrors_<ULPS>(x, y, count, errors);
+        }
+    }
+
+    /**
+     * @return Error between two real numbers. ULP distance of types other than float and double is
+     * measured in units in the last place of the greater of the numbers.
+     */
+    template<class Real>
+    static Real getError(Real x, Real y, Measure measure)
+    {
+        if (x != x || y != y)
+            return std::numeric_limits<Real>::infinity();
+        if (x == y)
+            return Real();
+        Real result;
+        if (measure == ABSOLUTE)
+            result = std::abs(x - y);
+        else if (measure == RELATIVE)
+            result = std::abs(x - y) / std::max(std::abs(x), std::abs(y));
+        else
+            result = getUlps_(x, y);
+        return result == result ? result : std::numeric_limits<Real>::infinity();
+    }
+
+    /**
+     * @return Error between two complex numbers: absolute and relative ones use modules, ULP
+     * distance is the greater of distances of real and imaginary parts
+     */
+    template<class Real>
+    static Real getError(const std::complex<Real>& x, const std::complex<Real>& y, Measure measure)
+    {
+        if (measure == ULPS)
+            return std::max(getError(x.real(), y.real(), ULPS), getError(x.imag(), y.imag(), ULPS));
+        if (x.real() != x.real() || x.imag() != x.imag() || y.real() != y.real() ||
+            y.imag() != y.imag())
+            return std::numeric_limits<Real>::infinity();
+        if (x == y)
+            return Real();
+        Real result = std::abs(x - y);
+        if (measure == RELATIVE)
+            result /= std::max(std::abs(x), std::abs(y));
+        return result == result ? result : std::numeric_limits<Real>::infinity();
+    }
+
+private:
+
+    template<Measure MEASURE, class Real>
+    static void computeErrors_(const Real* x, const Real* y, std::size_t count, Real* errors)
+    {
+        std::size_t k = 0;
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            k = computeErrorsAvx512_<MEASURE>(x, y, count, errors);
+        else if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            k = computeErrorsAvx2_<MEASURE>(x, y, count, errors);
+#endif
+        for (; k < count; ++k)
+            errors[k] = getError(x[k], y[k], MEASURE);
+    }
+
+    /*
+     * ULP distances. Bit patterns of float and double are mapped to integers ordered as the numbers
+     * are (both zeros to 0) and the distance is their difference converted to the real type
+     */
+
+    inline static double getUlps_(double x, double y)
+    {
+        return static_cast<double>(countUlps_<boost::int64_t,boost::uint64_t>(x, y));
+    }
+
+    inline static float getUlps_(float x, float y)
+    {
+        return static_cast<float>(countUlps_<boost::int32_t,boost::uint32_t>(x, y));
+    }
+
+    template<class Real>
+    static Real getUlps_(Real x, Real y)
+    {
+        int exponent;
+        std::frexp(std::max(std::abs(x), std::abs(y)), &exponent);
+        exponent = std::max(exponent, std::numeric_limits<Real>::min_exponent);
+        return std::abs(x - y) / std::ldexp(std::numeric_limits<Real>::epsilon(), exponent - 1);
+    }
+
+    template<class Signed, class Unsigned, class Real>
+    inline static Unsigned countUlps_(Real x, Real y)
+    {
+        Signed a = toOrdered_<Signed>(x),
+               b = toOrdered_<Signed>(y);
+        return a > b ? Unsigned(a) - Unsigned(b) : Unsigned(b) - Unsigned(a);
+    }
+
+    template<class Signed, class Real>
+    inline static Signed toOrdered_(Real x)
+    {
+        Signed bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits < 0 ? std::numeric_limits<Signed>::min() - bits : bits;
+    }
+
+#ifdef LIBUBLASAUX_SIMD_X86
+
+    /*
+     * Operations on SIMD registers used by kernels (every kernel is written once for both real types)
+     */
+
+    template<class Real>
+    struct Avx2_ {};
+
+    template<class Real>
+    struct Avx512_ {};
+
+    /*
+     * SIMD kernels. They process whole registers and return number of processed elements
+     */
+
+    template<Measure MEASURE, class Real>
+    __attribute__((target("avx2")))
+    static std::size_t computeErrorsAvx2_(const Real* x, const Real* y, std::size_t count,
+                                          Real* errors)
+    {
+        typedef Avx2_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const Register zero = Simd::zero(),
+                       infinity = Simd::set(std::numeric_limits<Real>::infinity());
+        std::size_t k = 0;
+        for (; k + Simd::WIDTH <= count; k += Simd::WIDTH)
+        {
+            Register a = Simd::load(x + k), b = Simd::load(y + k), error;
+            if (MEASURE == ABSOLUTE)
+                error = Simd::abs(Simd::sub(a, b));
+            else if (MEASURE == RELATIVE)
+                error = Simd::div(Simd::abs(Simd::sub(a, b)), Simd::max(Simd::abs(a), Simd::abs(b)));
+            else
+                error = Simd::ulps(a, b);
+            error = Simd::select(Simd::either(Simd::unordered(a, b), Simd::unordered(error, error)),
+                                 infinity, error);
+            Simd::store(errors + k, Simd::select(Simd::equal(a, b), zero, error));
+        }
+        return k;
+    }
+
+    static const int ROUNDING_ = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    // Unmasked AVX-512 intrinsics of GCC start from an "undefined" vector, which makes
+    // -Wmaybe-uninitialized give false warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    template<Measure MEASURE, class Real>
+    __attribute__((target("avx512f")))
+    static std::size_t computeErrorsAvx512_(const Real* x, const Real* y, std::size_t count,
+                                            Real* errors)
+    {
+        typedef Avx512_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const Register zero = Simd::zero(),
+                       infinity = Simd::set(std::numeric_limits<Real>::infinity());
+        std::size_t k = 0;
+        for (; k + Simd::WIDTH <= count; k += Simd::WIDTH)
+        {
+            Register a = Simd::load(x + k), b = Simd::load(y + k), error;
+            if (MEASURE == ABSOLUTE)
+                error = Simd::abs(Simd::sub(a, b));
+            else if (MEASURE == RELATIVE)
+                error = Simd::div(Simd::abs(Simd::sub(a, b)), Simd::max(Simd::abs(a), Simd::abs(b)));
+            else
+                error = Simd::ulps(a, b);
+            error = Simd::select(Simd::either(Simd::unordered(a, b), Simd::unordered(error, error)),
+                                 infinity, error);
+            Simd::store(errors + k, Simd::select(Simd::equal(a, b), zero, error));
+        }
+        return k;
+    }
+
+#pragma GCC diagnostic pop
+
+#endif //LIBUBLASAUX_SIMD_X86
+
+}; //class ErrorKernels
+
+
+#ifdef LIBUBLASAUX_SIMD_X86
+
+/*
+ * Integer distances are converted to real numbers by halves, which are exact, so only their sum is
+ * rounded (as by a scalar conversion)
+ */
+
+template<>
+struct ErrorKernels::Avx2_<double> {
+    typedef __m256d Register;
+    typedef __m256d Mask;
+    static const std::size_t WIDTH = 4;
+
+    __attribute__((target("avx2"))) inline static Register zero()
+    {
+        return _mm256_setzero_pd();
+    }
+
+    __attribute__((target("avx2"))) inline static Register set(double value)
+    {
+        return _mm256_set1_pd(value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register load(const double* x)
+    {
+        return _mm256_loadu_pd(x);
+    }
+
+    __attribute__((target("avx2"))) inline static void store(double* x, Register value)
+    {
+        _mm256_storeu_pd(x, value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm256_sub_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register div(Register a, Register b)
+    {
+        return _mm256_div_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register max(Register a, Register b)
+    {
+        return _mm256_max_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register abs(Register a)
+    {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask equal(Register a, Register b)
+    {
+        return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask unordered(Register a, Register b)
+    {
+        return _mm256_cmp_pd(a, b, _CMP_UNORD_Q);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask either(Mask a, Mask b)
+    {
+        return _mm256_or_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register select(Mask mask, Register a, Register b)
+    {
+        return _mm256_blendv_pd(b, a, mask);
+    }
+
+    __attribute__((target("avx2"))) inline static Register ulps(Register a, Register b)
+    {
+        __m256i x = toOrdered(_mm256_castpd_si256(a)),
+                y = toOrdered(_mm256_castpd_si256(b)),
+                distance = _mm256_blendv_epi8(_mm256_sub_epi64(y, x), _mm256_sub_epi64(x, y),
+                                              _mm256_cmpgt_epi64(x, y));
+        // Or-ing a 32-bit number into the mantissa of 2^52 gives 2^52 plus this number
+        const __m256i exponent = _mm256_set1_epi64x(static_cast<boost::int64_t>(0x43300000) << 32);
+        const __m256d offset = _mm256_set1_pd(4503599627370496.0);
+        __m256d high = _mm256_sub_pd(_mm256_castsi256_pd(
+                           _mm256_or_si256(_mm256_srli_epi64(distance, 32), exponent)), offset),
+                low = _mm256_sub_pd(_mm256_castsi256_pd(
+                          _mm256_or_si256(_mm256_and_si256(distance, _mm256_set1_epi64x(0xFFFFFFFF)),
+                                          exponent)), offset);
+        return _mm256_add_pd(_mm256_mul_pd(high, _mm256_set1_pd(4294967296.0)), low);
+    }
+
+    __attribute__((target("avx2"))) inline static __m256i toOrdered(__m256i bits)
+    {
+        __m256i negative = _mm256_cmpgt_epi64(_mm256_setzero_si256(), bits);
+        return _mm256_blendv_epi8(bits, _mm256_sub_epi64(
+                   _mm256_set1_epi64x(std::numeric_limits<boost::int64_t>::min()), bits), negative);
+    }
+};
+
+template<>
+struct ErrorKernels::Avx2_<float> {
+    typedef __m256 Register;
+    typedef __m256 Mask;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx2"))) inline static Register zero()
+    {
+        return _mm256_setzero_ps();
+    }
+
+    __attribute__((target("avx2"))) inline static Register set(float value)
+    {
+        return _mm256_set1_ps(value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register load(const float* x)
+    {
+        return _mm256_loadu_ps(x);
+    }
+
+    __attribute__((target("avx2"))) inline static void store(float* x, Register value)
+    {
+        _mm256_storeu_ps(x, value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register div(Register a, Register b)
+    {
+        return _mm256_div_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register max(Register a, Register b)
+    {
+        return _mm256_max_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register abs(Register a)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask equal(Register a, Register b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask unordered(Register a, Register b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_UNORD_Q);
+    }
+
+    __attribute__((target("avx2"))) inline static Mask either(Mask a, Mask b)
+    {
+        return _mm256_or_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register select(Mask mask, Register a, Register b)
+    {
+        return _mm256_blendv_ps(b, a, mask);
+    }
+
+    __attribute__((target("avx2"))) inline static Register ulps(Register a, Register b)
+    {
+        __m256i x = toOrdered(_mm256_castps_si256(a)),
+                y = toOrdered(_mm256_castps_si256(b)),
+                distance = _mm256_sub_epi32(_mm256_max_epi32(x, y), _mm256_min_epi32(x, y));
+        __m256 high = _mm256_cvtepi32_ps(_mm256_srli_epi32(distance, 16)),
+               low = _mm256_cvtepi32_ps(_mm256_and_si256(distance, _mm256_set1_epi32(0xFFFF)));
+        return _mm256_add_ps(_mm256_mul_ps(high, _mm256_set1_ps(65536.0f)), low);
+    }
+
+    __attribute__((target("avx2"))) inline static __m256i toOrdered(__m256i bits)
+    {
+        __m256i negative = _mm256_cmpgt_epi32(_mm256_setzero_si256(), bits);
+        return _mm256_blendv_epi8(bits, _mm256_sub_epi32(
+                   _mm256_set1_epi32(std::numeric_limits<boost::int32_t>::min()), bits), negative);
+    }
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template<>
+struct ErrorKernels::Avx512_<double> {
+    typedef __m512d Register;
+    typedef __mmask8 Mask;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx512f"))) inline static Register zero()
+    {
+        return _mm512_setzero_pd();
+    }
+
+    __attribute__((target("avx512f"))) inline static Register set(double value)
+    {
+        return _mm512_set1_pd(value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register load(const double* x)
+    {
+        return _mm512_loadu_pd(x);
+    }
+
+    __attribute__((target("avx512f"))) inline static void store(double* x, Register value)
+    {
+        _mm512_storeu_pd(x, value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm512_sub_pd(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register div(Register a, Register b)
+    {
+        return _mm512_div_pd(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register max(Register a, Register b)
+    {
+        return _mm512_max_pd(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register abs(Register a)
+    {
+        return _mm512_abs_pd(a);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask equal(Register a, Register b)
+    {
+        return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask unordered(Register a, Register b)
+    {
+        return _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask either(Mask a, Mask b)
+    {
+        return static_cast<Mask>(a | b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register select(Mask mask, Register a, Register b)
+    {
+        return _mm512_mask_blend_pd(mask, b, a);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register ulps(Register a, Register b)
+    {
+        __m512i x = toOrdered(_mm512_castpd_si512(a)),
+                y = toOrdered(_mm512_castpd_si512(b)),
+                distance = _mm512_sub_epi64(_mm512_max_epi64(x, y), _mm512_min_epi64(x, y));
+        const __m512i exponent = _mm512_set1_epi64(static_cast<boost::int64_t>(0x43300000) << 32);
+        const __m512d offset = _mm512_set1_pd(4503599627370496.0);
+        __m512d high = _mm512_sub_pd(_mm512_castsi512_pd(
+                           _mm512_or_si512(_mm512_srli_epi64(distance, 32), exponent)), offset),
+                low = _mm512_sub_pd(_mm512_castsi512_pd(
+                          _mm512_or_si512(_mm512_and_si512(distance, _mm512_set1_epi64(0xFFFFFFFF)),
+                                          exponent)), offset);
+        return _mm512_add_round_pd(_mm512_mul_round_pd(high, _mm512_set1_pd(4294967296.0), ROUNDING_),
+                                   low, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static __m512i toOrdered(__m512i bits)
+    {
+        return _mm512_mask_sub_epi64(bits, _mm512_cmplt_epi64_mask(bits, _mm512_setzero_si512()),
+                                     _mm512_set1_epi64(std::numeric_limits<boost::int64_t>::min()),
+                                     bits);
+    }
+};
+
+template<>
+struct ErrorKernels::Avx512_<float> {
+    typedef __m512 Register;
+    typedef __mmask16 Mask;
+    static const std::size_t WIDTH = 16;
+
+    __attribute__((target("avx512f"))) inline static Register zero()
+    {
+        return _mm512_setzero_ps();
+    }
+
+    __attribute__((target("avx512f"))) inline static Register set(float value)
+    {
+        return _mm512_set1_ps(value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register load(const float* x)
+    {
+        return _mm512_loadu_ps(x);
+    }
+
+    __attribute__((target("avx512f"))) inline static void store(float* x, Register value)
+    {
+        _mm512_storeu_ps(x, value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm512_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register div(Register a, Register b)
+    {
+        return _mm512_div_ps(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register max(Register a, Register b)
+    {
+        return _mm512_max_ps(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register abs(Register a)
+    {
+        return _mm512_abs_ps(a);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask equal(Register a, Register b)
+    {
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask unordered(Register a, Register b)
+    {
+        return _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q);
+    }
+
+    __attribute__((target("avx512f"))) inline static Mask either(Mask a, Mask b)
+    {
+        return static_cast<Mask>(a | b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register select(Mask mask, Register a, Register b)
+    {
+        return _mm512_mask_blend_ps(mask, b, a);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register ulps(Register a, Register b)
+    {
+        __m512i x = toOrdered(_mm512_castps_si512(a)),
+                y = toOrdered(_mm512_castps_si512(b)),
+                distance = _mm512_sub_epi32(_mm512_max_epi32(x, y), _mm512_min_epi32(x, y));
+        __m512 high = _mm512_cvtepi32_ps(_mm512_srli_epi32(distance, 16)),
+               low = _mm512_cvtepi32_ps(_mm512_and_si512(distance, _mm512_set1_epi32(0xFFFF)));
+        return _mm512_add_round_ps(_mm512_mul_round_ps(high, _mm512_set1_ps(65536.0f), ROUNDING_),
+                                   low, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static __m512i toOrdered(__m512i bits)
+    {
+        return _mm512_mask_sub_epi32(bits, _mm512_cmplt_epi32_mask(bits, _mm512_setzero_si512()),
+                                     _mm512_set1_epi32(std::numeric_limits<boost::int32_t>::min()),
+                                     bits);
+    }
+};
+
+#pragma GCC diagnostic pop
+
+#endif //LIBUBLASAUX_SIMD_X86
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_ERRORKERNELS_H__
@@ -0,0 +1,72 @@
+#ifndef __LIBUBLASAUX_FILLORDER_H__
+#define __LIBUBLASAUX_FILLORDER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Order in which StdDispatchRandomizer draws elements of matrices from a sequential engine. With
+ * BY_STORAGE order (the default) a matrix is filled line by line along its storage, i.e. column by
+ * column if its storage is column-major, so every orientation is filled at streaming bandwidth; as a
+ * consequence a seed gives different elements to matrices of different orientations. With BY_ROWS
+ * order elements are always drawn row by row, so a seed gives the same elements to matrices of both
+ * orientations, but column-major matrices are filled through strided access. RandomGenerator#stream
+ * draws elements in the same order as the matrix type would be filled. Counter-based engines (@see CounterEngineTraits) give
+ * the same matrices in both orders and are always used in storage order. This class implements
+ * "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Order of drawing elements of random matrices.
+ */
+class FillOrder {
+public:
+    /* Types */
+
+    enum Order { BY_STORAGE, BY_ROWS };
+
+    /* Real actions */
+
+    inline static Order getOrder()
+    {
+        return order_();
+    }
+
+    /**
+     * Sets order in which "DispatchRandomizer" strategies draw elements of matrices.
+     * @warning Not thread-safe. Set it before starting of random-generating.
+     */
+    inline static void setOrder(Order order)
+    {
+        order_() = order;
+    }
+
+private:
+
+    inline static Order& order_()
+    {
+        static Order order = BY_STORAGE;
+        return order;
+    }
+
+}; //class FillOrder
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_FILLORDER_H__
@@ -0,0 +1,368 @@
+#ifndef __LIBUBLASAUX_INSTRUMENTATION_H__
+#define __LIBUBLASAUX_INSTRUMENTATION_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ContainerTraits.h"
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <boost/cstdint.hpp>
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/thread/tss.hpp>
+#endif
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Counters of an instrumented function for one kind of containers (@see Instrumentation).
+ */
+struct InstrumentationCounters {
+    boost::uint64_t calls,
+                    elements,    ///< Elements generated
+                    collisions,  ///< Sampled positions of sparse elements drawn again
+                    bytes,       ///< Bytes of text written
+                    nanoseconds; ///< Wall time
+};
+
+/**
+ * Optional instrumentation of hot paths. "RandomGenerator::operator()" (GENERATOR site),
+ * "StdDispatchRandomizer::randomize" (RANDOMIZER) and "MatrixNiceOutputer::operator()" (OUTPUTER)
+ * record calls, elements generated, redrawn positions of sparse elements, bytes written and wall
+ * time per kind of containers. Counts recorded during a nested call (randomizer called by
+ * generator) are added to the enclosing call as well. Counters are kept per thread: a thread
+ * queries and resets only its own ones.
+ * Instrumentation is compiled in only if macro LIBUBLASAUX_INSTRUMENTATION is defined (programs
+ * have to be linked with "boost_thread" and "boost_chrono" then). Otherwise probes are empty inline
+ * functions, so they cost nothing, and all counters are zeros. This class implements "Monostate"
+ * pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Per-thread counters and timers of generating and outputing.
+ */
+class Instrumentation {
+public:
+    /* Types */
+
+    typedef InstrumentationCounters Counters;
+
+    enum Site { GENERATOR, RANDOMIZER, OUTPUTER, SITE_COUNT };
+
+    enum Kind { DENSE_VECTOR, DENSE_MATRIX, CONSTANT_VECTOR, CONSTANT_MATRIX, PACKED_MATRIX,
+                BANDED_MATRIX, SPARSE_VECTOR, SPARSE_MATRIX, OTHER_KIND, KIND_COUNT };
+
+private:
+    /**
+     * Kinds of containers by their shapes (@see ContainerTraits)
+     */
+    template<class Shape, bool IS_VECTOR, class Dummy = void>
+    struct ShapeKind_ {
+        static const Kind value = OTHER_KIND;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<DenseShape,true,Dummy> {
+        static const Kind value = DENSE_VECTOR;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<DenseShape,false,Dummy> {
+        static const Kind value = DENSE_MATRIX;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<ConstantShape,true,Dummy> {
+        static const Kind value = CONSTANT_VECTOR;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<ConstantShape,false,Dummy> {
+        static const Kind value = CONSTANT_MATRIX;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<PackedShape,false,Dummy> {
+        static const Kind value = PACKED_MATRIX;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<BandedShape,false,Dummy> {
+        static const Kind value = BANDED_MATRIX;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<SparseShape,true,Dummy> {
+        static const Kind value = SPARSE_VECTOR;
+    };
+
+    template<class Dummy>
+    struct ShapeKind_<SparseShape,false,Dummy> {
+        static const Kind value = SPARSE_MATRIX;
+    };
+
+public:
+
+    /**
+     * Kind of a container type given by its traits (@see ContainerTraits).
+     */
+    template<class Container>
+    struct KindOf {
+        static const Kind value = ShapeKind_<typename ContainerTraits<Container>::Shape,
+                                             ContainerTraits<Container>::IS_VECTOR>::value;
+    };
+
+    class Probe;
+
+    /* Constants */
+
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    static const bool IS_ENABLED = true;
+#else
+    static const bool IS_ENABLED = false;
+#endif
+
+    /* Real actions */
+
+    /**
+     * @return Counters of the calling thread
+     */
+    inline static Counters getCounters(Site site, Kind kind)
+    {
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+        return getRegistry_().counters[site][kind];
+#else
+        Counters zeros = { 0, 0, 0, 0, 0 };
+        (void)site;
+        (void)kind;
+        return zeros;
+#endif
+    }
+
+    /**
+     * @return Sums of counters of the calling thread for all kinds of containers
+     */
+    static Counters getTotal(Site site)
+    {
+        Counters total = { 0, 0, 0, 0, 0 };
+        for (int kind = 0; kind < KIND_COUNT; ++kind)
+        {
+            Counters counters = getCounters(site, static_cast<Kind>(kind));
+            total.calls += counters.calls;
+            total.elements += counters.elements;
+            total.collisions += counters.collisions;
+            total.bytes += counters.bytes;
+            total.nanoseconds += counters.nanoseconds;
+        }
+        return total;
+    }
+
+    /**
+     * Sets all counters of the calling thread to zeros. Calls being recorded now add only what
+     * remains of them.
+     */
+    inline static void reset()
+    {
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+        Registry_& registry = getRegistry_();
+        Counters zeros = { 0, 0, 0, 0, 0 };
+        for (int site = 0; site < SITE_COUNT; ++site)
+            for (int kind = 0; kind < KIND_COUNT; ++kind)
+                registry.counters[site][kind] = zeros;
+#endif
+    }
+
+    /**
+     * Records collisions to calls being recorded by the calling thread.
+     */
+    inline static void addCollisions(boost::uint64_t count);
+
+private:
+
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    struct Registry_ {
+        Counters counters[SITE_COUNT][KIND_COUNT];
+        Probe* innermost; ///< Probe of the innermost call being recorded
+    };
+
+    static Registry_& getRegistry_()
+    {
+        static boost::thread_specific_ptr<Registry_> registry;
+        if (registry.get() == 0)
+            registry.reset(new Registry_()); // counters are zeros
+        return *registry;
+    }
+#endif
+
+}; //class Instrumentation
+
+
+/**
+ * Records a call of an instrumented function from construction to destruction: counts the call and
+ * its wall time, and elements and bytes given to it.
+ */
+class Instrumentation::Probe {
+public:
+
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    inline Probe(Site site, Kind kind):
+        registry_(getRegistry_()), counters_(&registry_.counters[site][kind]),
+        outer_(registry_.innermost), start_(boost::chrono::steady_clock::now())
+    {
+        ++counters_->calls;
+        registry_.innermost = this;
+    }
+
+    inline ~Probe()
+    {
+        counters_->nanoseconds += boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                                      boost::chrono::steady_clock::now() - start_).count();
+        registry_.innermost = outer_;
+    }
+
+    inline void addElements(boost::uint64_t count)
+    {
+        for (Probe* probe = this; probe != 0; probe = probe->outer_)
+            probe->counters_->elements += count;
+    }
+
+    inline void addCollisions(boost::uint64_t count)
+    {
+        for (Probe* probe = this; probe != 0; probe = probe->outer_)
+            probe->counters_->collisions += count;
+    }
+
+    inline void addBytes(boost::uint64_t count)
+    {
+        for (Probe* probe = this; probe != 0; probe = probe->outer_)
+            probe->counters_->bytes += count;
+    }
+#else
+    inline Probe(Site, Kind) {}
+
+    inline void addElements(boost::uint64_t) {}
+
+    inline void addCollisions(boost::uint64_t) {}
+
+    inline void addBytes(boost::uint64_t) {}
+#endif
+
+private:
+
+    Probe(const Probe&);
+    Probe& operator=(const Probe&);
+
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    Registry_& registry_;
+    Counters* counters_;
+    Probe* outer_;
+    boost::chrono::steady_clock::time_point start_;
+#endif
+
+}; //class Instrumentation::Probe
+
+
+inline void Instrumentation::addCollisions(boost::uint64_t count)
+{
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    if (Probe* probe = getRegistry_().innermost)
+        probe->addCollisions(count);
+#else
+    (void)count;
+#endif
+}
+
+
+/**
+ * Counts characters written to a stream during its lifetime and gives their size in bytes to a probe
+ * (@see Instrumentation::Probe). The stream writes through it meanwhile; state of the stream is kept.
+ * If instrumentation is disabled it does nothing.
+ * @tparam Char Type of characters of the stream
+ * @tparam CharTraits Traits of characters of the stream
+ */
+template<class Char, class CharTraits>
+class InstrumentedByteCounter
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+        : public std::basic_streambuf<Char,CharTraits>
+#endif
+{
+public:
+
+#ifdef LIBUBLASAUX_INSTRUMENTATION
+    typedef typename CharTraits::int_type IntType;
+
+    inline InstrumentedByteCounter(std::basic_ostream<Char,CharTraits>& output,
+                                   Instrumentation::Probe& probe):
+        output_(output), probe_(probe), count_(0)
+    {
+        std::ios_base::iostate state = output.rdstate();
+        buffer_ = output.rdbuf(this);
+        output.clear(state);
+    }
+
+    inline ~InstrumentedByteCounter()
+    {
+        std::ios_base::iostate state = output_.rdstate();
+        output_.rdbuf(buffer_);
+        output_.clear(state);
+        probe_.addBytes(count_ * sizeof(Char));
+    }
+
+protected:
+
+    virtual IntType overflow(IntType c)
+    {
+        if (CharTraits::eq_int_type(c, CharTraits::eof()))
+            return CharTraits::not_eof(c);
+        IntType result = buffer_->sputc(CharTraits::to_char_type(c));
+        if (!CharTraits::eq_int_type(result, CharTraits::eof()))
+            ++count_;
+        return result;
+    }
+
+    virtual std::streamsize xsputn(const Char* text, std::streamsize size)
+    {
+        std::streamsize written = buffer_->sputn(text, size);
+        count_ += static_cast<boost::uint64_t>(written);
+        return written;
+    }
+
+    virtual int sync()
+    {
+        return buffer_->pubsync();
+    }
+
+private:
+
+    InstrumentedByteCounter(const InstrumentedByteCounter&);
+    InstrumentedByteCounter& operator=(const InstrumentedByteCounter&);
+
+    std::basic_ostream<Char,CharTraits>& output_;
+    std::basic_streambuf<Char,CharTraits>* buffer_;
+    Instrumentation::Probe& probe_;
+    boost::uint64_t count_;
+#else
+    inline InstrumentedByteCounter(std::basic_ostream<Char,CharTraits>&, Instrumentation::Probe&) {}
+#endif
+
+}; //template class InstrumentedByteCounter
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_INSTRUMENTATION_H__
@@ -0,0 +1,244 @@
+#ifndef __LIBUBLASAUX_MAPPEDMATRIXFILE_H__
+#define __LIBUBLASAUX_MAPPEDMATRIXFILE_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BinarySerializer.h"
+#include <cstddef>
+#include <cstring>
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * File written by BinarySerializer mapped to memory. Dense vectors and matrices and compressed
+ * matrices whose storage arrays are "array_adaptor"s can be attached to the mapping: their arrays
+ * then point straight into it and nothing is read or copied (except arrays which are not aligned
+ * for their type in the file, @see attach). Pages are mapped copy-on-write, so
+ * processes mapping the same file share the page cache until one of them changes an element (the
+ * change stays private to that process and never reaches the file).
+ * @author Anton Liaukevich
+ * @brief Zero-copy loading of serialized vectors and matrices.
+ * @remark Containers attached to the mapping must not outlive this object. Resizing them or
+ * inserting elements which do not fit their storage moves them to their own memory.
+ */
+class MappedMatrixFile: private boost::noncopyable {
+public:
+    /* Types */
+
+    /**
+     * Type of a dense vector which can be attached to the mapping.
+     */
+    template<class Item>
+    struct Vector {
+        typedef vector< Item, array_adaptor<Item> > Answer;
+    };
+
+    /**
+     * Type of a dense matrix which can be attached to the mapping.
+     */
+    template<class Item, class Orientation = row_major>
+    struct Matrix {
+        typedef matrix< Item, Orientation, array_adaptor<Item> > Answer;
+    };
+
+    /**
+     * Type of a compressed (CSR or CSC) matrix which can be attached to the mapping.
+     */
+    template<class Item, class Orientation = row_major, class Index = std::size_t>
+    struct CompressedMatrix {
+        typedef compressed_matrix< Item, Orientation, 0, array_adaptor<Index>, array_adaptor<Item> > Answer;
+    };
+
+    /* Construct/copy/destruct */
+
+    /**
+     * Maps a whole file.
+     * @throw boost::interprocess::interprocess_exception If the file cannot be opened or mapped
+     */
+    explicit MappedMatrixFile(const char* path):
+        file_(path, boost::interprocess::read_only),
+        region_(file_, boost::interprocess::copy_on_write) {}
+
+    /* Field (read-only) access */
+
+    inline const char* getData() const
+    {
+        return static_cast<const char*>(region_.get_address());
+    }
+
+    inline std::size_t getSize() const
+    {
+        return region_.get_size();
+    }
+
+    /* Real actions */
+
+    /**
+     * Attaches a dense vector to the mapping.
+     * @return false if the file does not contain a dense vector of this value type (the vector is
+     * left unchanged)
+     */
+    template<class Item>
+    bool attach(vector< Item, array_adaptor<Item> >& vect) const
+    {
+        BinarySerializer::Header_ header;
+        if (!readHeader_(header, BinarySerializer::makeHeader_<Item>(1, BinarySerializer::DENSE)))
+            return false;
+        char* data = getArray_<Item>(BinarySerializer::HEADER_SIZE_, header.count1);
+        if (data == 0 || header.count1 != header.size1)
+            return false;
+
+        vect.resize(header.size1, false);
+        attachArray_(vect.data(), data, header.count1);
+        return true;
+    }
+
+    /**
+     * Attaches a dense matrix to the mapping.
+     * @return false if the file does not contain a dense matrix of this value type and orientation
+     * (the matrix is left unchanged)
+     */
+    template<class Item, class Orientation>
+    bool attach(matrix< Item, Orientation, array_adaptor<Item> >& matr) const
+    {
+        typedef typename Orientation::orientation_category OrientationCategory;
+
+        BinarySerializer::Header_ header;
+        if (!readHeader_(header, BinarySerializer::makeHeader_<Item>(2, BinarySerializer::DENSE,
+                                 BinarySerializer::orientationOf_(OrientationCategory()))))
+            return false;
+        char* data = getArray_<Item>(BinarySerializer::HEADER_SIZE_, header.count1);
+        if (data == 0 || !isProduct_(header.count1, header.size1, header.size2))
+            return false;
+
+        matr.resize(header.size1, header.size2, false);
+        attachArray_(matr.data(), data, header.count1);
+        return true;
+    }
+
+    /**
+     * Attaches a compressed matrix to the mapping. Its arrays are copied instead if they are
+     * shorter than the matrix requires: when the matrix had been saved with incomplete "index1"
+     * data or had less non-zeros than min(size1, size2). Values are stored right after the indices,
+     * so they are copied too if the indices take a size not multiple of alignment of Item (4-byte
+     * indices of doubles with odd count1 + count2).
+     * @return false if the file does not contain a compressed matrix of this value type,
+     * orientation and index type, is truncated or has more "index1" data or non-zeros than the
+     * matrix can hold (the matrix is left unchanged). Alignment never makes it fail.
+     */
+    template<class Item, class Orientation, class Index>
+    bool attach(compressed_matrix< Item, Orientation, 0, array_adaptor<Index>, array_adaptor<Item> >& matr) const
+    {
+        typedef typename Orientation::orientation_category OrientationCategory;
+
+        BinarySerializer::Header_ header;
+        if (!readHeader_(header, BinarySerializer::makeHeader_<Item>(2, BinarySerializer::COMPRESSED,
+                                 BinarySerializer::orientationOf_(OrientationCategory()), 0,
+                                 sizeof(Index), 0)))
+            return false;
+        std::size_t offset = BinarySerializer::HEADER_SIZE_;
+        char* index1 = getArray_<Index>(offset, header.count1);
+        offset += header.count1 * sizeof(Index);
+        char* index2 = getArray_<Index>(offset, header.count2);
+        offset += header.count2 * sizeof(Index);
+        char* values = getArray_<Item>(offset, header.count2);
+        if (index1 == 0 || index2 == 0 || values == 0 || header.count1 == 0 ||
+            header.count1 > Orientation::size_M(header.size1, header.size2) + 1 ||
+            !isWithinProduct_(header.count2, header.size1, header.size2))
+            return false;
+
+        matr.resize(header.size1, header.size2, false);
+        matr.reserve(header.count2, false);
+        attachArray_(matr.index1_data(), index1, header.count1);
+        attachArray_(matr.index2_data(), index2, header.count2);
+        attachArray_(matr.value_data(), values, header.count2);
+        matr.set_filled(header.count1, header.count2);
+        return true;
+    }
+
+private:
+
+    bool readHeader_(BinarySerializer::Header_& header, const BinarySerializer::Header_& expected) const
+    {
+        return getSize() >= BinarySerializer::HEADER_SIZE_ &&
+               BinarySerializer::decodeHeader_(getData(), header) &&
+               BinarySerializer::isSameType_(header, expected);
+    }
+
+    /**
+     * @return true if "count" is "size1" * "size2" (which may overflow)
+     */
+    inline static bool isProduct_(boost::uint64_t count, boost::uint64_t size1, boost::uint64_t size2)
+    {
+        return size1 == 0 || size2 == 0 ? count == 0 : count % size1 == 0 && count / size1 == size2;
+    }
+
+    /**
+     * @return true if "count" is not more than "size1" * "size2" (which may overflow): "reserve" of
+     * a compressed matrix does not give more capacity.
+     */
+    inline static bool isWithinProduct_(boost::uint64_t count, boost::uint64_t size1, boost::uint64_t size2)
+    {
+        return count == 0 || size1 == 0 || (count - 1) / size1 < size2;
+    }
+
+    /**
+     * @return Address of an array of "count" values at "offset" bytes from beginning of the file or
+     * 0 if the array does not fit the file. The array may be not aligned for Value.
+     */
+    template<class Value>
+    char* getArray_(std::size_t offset, boost::uint64_t count) const
+    {
+        if (offset > getSize() || count > (getSize() - offset) / sizeof(Value))
+            return 0;
+        return static_cast<char*>(region_.get_address()) + offset;
+    }
+
+    /**
+     * Makes a storage array of a container refer to the mapped array if they have the same length
+     * and the mapped array is aligned for Value, else copies the mapped array to it.
+     */
+    template<class Value>
+    static void attachArray_(array_adaptor<Value>& array, char* data, std::size_t count)
+    {
+        if (array.size() == count && reinterpret_cast<std::size_t>(data) % alignment_of<Value>::value == 0)
+            array.resize(count, reinterpret_cast<Value*>(data));
+        else if (count > 0)
+            std::memcpy(&*array.begin(), data, count * sizeof(Value));
+    }
+
+    /* Fields */
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+
+}; //class MappedMatrixFile
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_MAPPEDMATRIXFILE_H__
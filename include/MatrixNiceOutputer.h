@@ -19,9 +19,14 @@
  */
 
 #include "BaseNiceOutputer.h"
+#include "Instrumentation.h"
+#include "NiceOutputBuffers.h"
+#include "NumberFormatter.h"
+#include <algorithm>
+#include <cstddef>
 #include <ostream>
+#include <string>
 #include <vector>
-#include <boost/format.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
@@ -36,7 +41,28 @@ class MatrixNiceOutputer: public BaseNiceOutputer {
 public:
     /* Types */
 
-    enum ElementPlacing { SIMPLE, BY_COLUMNS, BY_EQUALWIDTH_COLUMNS };
+    /**
+     * BY_COLUMNS and BY_EQUALWIDTH_COLUMNS format a matrix of up to FORMATTED_ITEMS elements once
+     * and keep its text; larger matrices are formatted twice (to measure and to output) by blocks of
+     * about FORMATTED_ITEMS elements, so their text is never kept whole.
+     * BY_STREAMED_COLUMNS gives the same text as BY_COLUMNS formatting every element twice and
+     * keeping text of one row: memory used does not depend on number of rows.
+     * COORDINATE_LIST and COMPACT_ROWS output only elements the matrix stores (all elements of
+     * dense matrices), visiting them by matrix iterators, so time is proportional to number of
+     * non-zeros of sparse matrices (examples are for "minSpaces" = 1, which is the number of spaces
+     * after commas between indices and elements):
+     * COORDINATE_LIST puts element per line: "((0, 2): 1.5,\n (3, 1): 2)";
+     * COMPACT_ROWS puts non-empty row per line: "(0: (2: 1.5, 4: 7),\n 3: (1: 2))".
+     */
+    enum ElementPlacing { SIMPLE, BY_COLUMNS, BY_EQUALWIDTH_COLUMNS, BY_STREAMED_COLUMNS,
+                          COORDINATE_LIST, COMPACT_ROWS };
+
+    /* Constants */
+
+    /**
+     * Maximal number of elements whose text justifying placings keep at once.
+     */
+    static const std::size_t FORMATTED_ITEMS = 1 << 16;
 
     /* Construct/copy/destruct */
 
@@ -72,145 +98,458 @@ public:
      * boost::numeric::ublas library
      */
     template<class Char, class CharTraits, class Matrix>
-    void operator()(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
+    inline void operator()(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
     {
-        /* Output matrix sizes, new line after them */
-        typedef boost::basic_format<Char,CharTraits> Format;
-        output << Format("[%1%, %2%]\n") % matrix.size1() % matrix.size2();
+        NiceOutputBuffers<Char,CharTraits> buffers;
+        (*this)(output, matrix, buffers);
+    }
+
+    /**
+     * Outputs a matrix to the stream in a nice look using memory of given buffers. Output of
+     * matrices of the same shape with the same buffers does no heap allocation once the buffers have
+     * grown (@see NiceOutputBuffers).
+     * @param output Output stream
+     * @param matrix A matrix object to be outputed
+     * @param buffers Scratch buffers
+     * @remark Calls and bytes written are recorded by instrumentation if it is enabled
+     * (@see Instrumentation).
+     */
+    template<class Char, class CharTraits, class Matrix>
+    void operator()(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                    NiceOutputBuffers<Char,CharTraits>& buffers) const
+    {
+        Instrumentation::Probe probe(Instrumentation::OUTPUTER, Instrumentation::KindOf<Matrix>::value);
+        InstrumentedByteCounter<Char,CharTraits> byteCounter(output, probe);
+
+        std::basic_string<Char,CharTraits>& chunk = buffers.chunk_;
+        startOutput(output, chunk, matrix);
 
         if (matrix.size1() == 0)
-            output << "()";
+            appendText(chunk, "()");
         else if (getPlacing() == SIMPLE)
-            doSimply(output, matrix);
+            doSimply(output, matrix, buffers);
         else if (getPlacing() == BY_COLUMNS)
-            doJustifiedColumns(output, matrix);
+            doJustifiedColumns(output, matrix, buffers, false);
         else if (getPlacing() == BY_EQUALWIDTH_COLUMNS)
-            doEqualWidthColumns(output, matrix);
+            doJustifiedColumns(output, matrix, buffers, true);
+        else if (getPlacing() == BY_STREAMED_COLUMNS)
+            doStreamedColumns(output, matrix, buffers);
+        else if (getPlacing() == COORDINATE_LIST || getPlacing() == COMPACT_ROWS)
+            doStoredElements(output, matrix, buffers);
 
-        if (isLineFeedAfterAll())
-            output << "\n";
+        finishOutput(output, chunk);
     }
 
+protected:
+    /* Types */
+
+    typedef std::vector<StreamSize> ColumnWidths_;
+
+    /**
+     * Text of elements of consecutive rows of a matrix, formatted once and kept in one string of
+     * the buffers.
+     */
+    template<class Char, class CharTraits>
+    class FormattedRows_ {
+    public:
+
+        inline FormattedRows_(const std::basic_ostream<Char,CharTraits>& output,
+                              NiceOutputBuffers<Char,CharTraits>& buffers):
+            formatter_(output), firstRow_(0), rowCount_(0), size2_(0), text_(buffers.text_),
+            ends_(buffers.ends_) {}
+
+        /**
+         * Formats rows [firstRow, lastRow) of a matrix replacing previous contents.
+         */
+        template<class Matrix>
+        void format(const Matrix& matrix, std::size_t firstRow, std::size_t lastRow)
+        {
+            firstRow_ = firstRow;
+            rowCount_ = lastRow - firstRow;
+            size2_ = matrix.size2();
+            text_.clear();
+            ends_.resize(rowCount_ * size2_);
+            std::size_t k = 0;
+            for (std::size_t i = firstRow; i < lastRow; ++i)
+                for (std::size_t j = 0; j < size2_; ++j, ++k)
+                {
+                    formatter_.append(text_, matrix(i, j));
+                    ends_[k] = text_.size();
+                }
+        }
+
+        inline std::size_t getFirstRow() const
+        {
+            return firstRow_;
+        }
+
+        inline std::size_t getRowCount() const
+        {
+            return rowCount_;
+        }
+
+        inline std::size_t getSize2() const
+        {
+            return size2_;
+        }
+
+        /**
+         * @return Length of text of element (i, j), i is counted from the first formatted row
+         */
+        inline StreamSize getSize(std::size_t i, std::size_t j) const
+        {
+            return ends_[i * size2_ + j] - getBegin_(i, j);
+        }
+
+        inline void append(std::basic_string<Char,CharTraits>& text, std::size_t i, std::size_t j) const
+        {
+            text.append(text_, getBegin_(i, j), getSize(i, j));
+        }
+
+        /**
+         * Widens column widths to fit the formatted rows.
+         */
+        inline void updateWidths(ColumnWidths_& columnWidths) const
+        {
+            for (std::size_t i = 0; i < getRowCount(); ++i)
+                for (std::size_t j = 0; j < size2_; ++j)
+                    if (getSize(i, j) > columnWidths[j])
+                        columnWidths[j] = getSize(i, j);
+        }
+
+    private:
+
+        inline std::size_t getBegin_(std::size_t i, std::size_t j) const
+        {
+            std::size_t k = i * size2_ + j;
+            return k == 0 ? 0 : ends_[k - 1];
+        }
+
+        NumberFormatter<Char,CharTraits> formatter_;
+        std::size_t firstRow_,
+                    rowCount_,
+                    size2_;
+        std::basic_string<Char,CharTraits>& text_;
+        std::vector<std::size_t>& ends_;
+    };
+
 private:
+
+    /**
+     * Writes stored elements given row by row in the COORDINATE_LIST or COMPACT_ROWS format.
+     */
+    template<class Char, class CharTraits>
+    class StoredElementsWriter_ {
+    public:
+
+        inline StoredElementsWriter_(std::basic_ostream<Char,CharTraits>& output,
+                                     std::basic_string<Char,CharTraits>& chunk, bool isCompact,
+                                     StreamSize minSpaces):
+            output_(output), chunk_(chunk), formatter_(output), isCompact_(isCompact), isEmpty_(true),
+            row_(0), minSpaces_(minSpaces) {}
+
+        inline const NumberFormatter<Char,CharTraits>& getFormatter() const
+        {
+            return formatter_;
+        }
+
+        template<class Value>
+        inline void operator()(std::size_t i, std::size_t j, const Value& value)
+        {
+            appendPosition_(i, j);
+            formatter_.append(chunk_, value);
+            flushChunk(output_, chunk_);
+        }
+
+        /**
+         * Writes an element formatted beforehand.
+         */
+        inline void write(std::size_t i, std::size_t j, const Char* text, std::size_t size)
+        {
+            appendPosition_(i, j);
+            chunk_.append(text, size);
+            flushChunk(output_, chunk_);
+        }
+
+        void finish()
+        {
+            if (isEmpty_)
+                appendText(chunk_, "()");
+            else
+                appendText(chunk_, isCompact_ ? "))" : ")");
+        }
+
+    private:
+
+        void appendPosition_(std::size_t i, std::size_t j)
+        {
+            if (!isCompact_)
+            {
+                appendText(chunk_, isEmpty_ ? "((" : ",\n (");
+                appendIndex(chunk_, i);
+                chunk_ += Char(',');
+                appendSpaces(chunk_, minSpaces_);
+                appendIndex(chunk_, j);
+            }
+            else
+            {
+                if (isEmpty_ || i != row_)
+                {
+                    appendText(chunk_, isEmpty_ ? "(" : "),\n ");
+                    appendIndex(chunk_, i);
+                    appendText(chunk_, ": (");
+                    row_ = i;
+                }
+                else
+                {
+                    chunk_ += Char(',');
+                    appendSpaces(chunk_, minSpaces_);
+                }
+                appendIndex(chunk_, j);
+            }
+            appendText(chunk_, isCompact_ ? ": " : "): ");
+            isEmpty_ = false;
+        }
+
+        std::basic_ostream<Char,CharTraits>& output_;
+        std::basic_string<Char,CharTraits>& chunk_;
+        NumberFormatter<Char,CharTraits> formatter_;
+        bool isCompact_,
+             isEmpty_;
+        std::size_t row_;
+        StreamSize minSpaces_;
+    };
+
+    template<class StoredElement>
+    inline static bool isRowLess_(const StoredElement& left, const StoredElement& right)
+    {
+        return left.i < right.i || (left.i == right.i && left.j < right.j);
+    }
+
+protected:
     /* Auxiliary methods */
 
+    /**
+     * Auxiliary method. Outputs the first character of a matrix text ("[" takes the stream's width)
+     * and puts sizes of the matrix with new line after them to the empty "chunk".
+     */
     template<class Char, class CharTraits, class Matrix>
-    void doSimply(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
+    static void startOutput(std::basic_ostream<Char,CharTraits>& output,
+                            std::basic_string<Char,CharTraits>& chunk, const Matrix& matrix)
+    {
+        output << Char('[');
+        chunk.clear();
+        appendIndex(chunk, matrix.size1());
+        appendText(chunk, ", ");
+        appendIndex(chunk, matrix.size2());
+        appendText(chunk, "]\n");
+    }
+
+    /**
+     * Auxiliary method. Finishes a matrix text and writes what remains of it.
+     */
+    template<class Char, class CharTraits>
+    void finishOutput(std::basic_ostream<Char,CharTraits>& output,
+                      std::basic_string<Char,CharTraits>& chunk) const
+    {
+        if (isLineFeedAfterAll())
+            chunk += Char('\n');
+        flushChunk(output, chunk, true);
+    }
+
+    /**
+     * Auxiliary method. Appends a formatted row justified to given widths of columns to "chunk".
+     * @param local Number of the row counted from the first formatted row
+     * @param rowCount Number of rows of the whole matrix
+     */
+    template<class Char, class CharTraits>
+    void appendRow(std::basic_string<Char,CharTraits>& chunk, const FormattedRows_<Char,CharTraits>& rows,
+                   std::size_t local, const ColumnWidths_& columnWidths, std::size_t rowCount) const
     {
+        std::size_t n = rows.getSize2(),
+                    i = rows.getFirstRow() + local;
+        chunk += Char(i == 0 ? '(' : ' ');
+        chunk += Char('(');
+        for (std::size_t j = 0; j + 1 < n; ++j) // cannot use "j < n-1" because Size may be unsigned
+        {
+            rows.append(chunk, local, j);
+            chunk += Char(',');
+            appendSpaces(chunk, columnWidths[j] - rows.getSize(local, j) + minSpaces_);
+        }
+        if (n >= 1)
+        {
+            rows.append(chunk, local, n-1);
+            appendSpaces(chunk, columnWidths[n-1] - rows.getSize(local, n-1));
+        }
+        chunk += Char(')');
+
+        if (i + 1 == rowCount) // cannot use "i == m-1" because Size may be unsigned
+            chunk += Char(')');
+        else
+        {
+            chunk += Char(',');
+            chunk += Char('\n');
+        }
+    }
+
+private:
+
+    template<class Char, class CharTraits, class Matrix>
+    void doSimply(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                  NiceOutputBuffers<Char,CharTraits>& buffers) const
+    {
+        NumberFormatter<Char,CharTraits> formatter(output);
+        std::basic_string<Char,CharTraits>& chunk = buffers.chunk_;
         for (typename Matrix::size_type i = 0; i < matrix.size1(); ++i)
         {
-            if (i == 0)
-                output << "(";
-            else
-                output << " ";
+            chunk += Char(i == 0 ? '(' : ' ');
 
-            outputRowSimply(output, row(matrix, i));
+            appendRowSimply(output, chunk, formatter, row(matrix, i));
 
             if (i + 1 == matrix.size1()) // cannot use "i == matrix.size1()-1" because Size may be unsigned
-                output << ")";
+                chunk += Char(')');
             else
-                output << ",\n";
+                appendText(chunk, ",\n");
         }
     }
 
+    /**
+     * Justifies columns to their own widths or to the widest one ("isEqualWidth"). Rows are
+     * formatted by blocks of about FORMATTED_ITEMS elements: the first pass measures the blocks, the
+     * second one outputs them, formatting them again unless the whole matrix is one block.
+     */
     template<class Char, class CharTraits, class Matrix>
-    void doJustifiedColumns(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
+    void doJustifiedColumns(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                            NiceOutputBuffers<Char,CharTraits>& buffers, bool isEqualWidth) const
+    {
+        std::size_t m = matrix.size1(),
+                    rowsPerBlock = (std::max)(std::size_t(1),
+                                              FORMATTED_ITEMS / (std::max)(std::size_t(matrix.size2()),
+                                                                           std::size_t(1)));
+
+        FormattedRows_<Char,CharTraits> rows(output, buffers);
+        ColumnWidths_& columnWidths = buffers.widths_;
+        columnWidths.assign(matrix.size2(), 0);
+        for (std::size_t first = 0; first < m; first += rowsPerBlock)
+        {
+            rows.format(matrix, first, (std::min)(m, first + rowsPerBlock));
+            rows.updateWidths(columnWidths);
+        }
+        if (isEqualWidth && !columnWidths.empty())
+            std::fill(columnWidths.begin(), columnWidths.end(),
+                      *std::max_element(columnWidths.begin(), columnWidths.end()));
+
+        for (std::size_t first = 0; first < m; first += rowsPerBlock)
+        {
+            if (m > rowsPerBlock)
+                rows.format(matrix, first, (std::min)(m, first + rowsPerBlock));
+            outputRows(output, buffers.chunk_, rows, columnWidths, m);
+        }
+    }
+
+    /**
+     * Gives the same text as doJustifiedColumns keeping only widths of columns and one row: the
+     * first pass measures rows, the second one formats them again and outputs.
+     */
+    template<class Char, class CharTraits, class Matrix>
+    void doStreamedColumns(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                           NiceOutputBuffers<Char,CharTraits>& buffers) const
     {
         typedef typename Matrix::size_type Size;
-        Size m = matrix.size1(),
-             n = matrix.size2();
+        Size m = matrix.size1();
 
-        boost::numeric::ublas::matrix<StreamSize> elementOutputSizes(m, n);
-        std::vector<StreamSize> columnWidths(n);
+        FormattedRows_<Char,CharTraits> rows(output, buffers);
+        ColumnWidths_& columnWidths = buffers.widths_;
+        columnWidths.assign(matrix.size2(), 0);
         for (Size i = 0; i < m; ++i)
-            for (Size j = 0; j < n; ++j)
-            {
-                StreamSize current = countValueOutputSize(output, matrix(i, j));
-                elementOutputSizes(i, j) = current;
-                if (current > columnWidths[j])
-                    columnWidths[j] = current;
-            }
+        {
+            rows.format(matrix, i, i + 1);
+            rows.updateWidths(columnWidths);
+        }
 
         for (Size i = 0; i < m; ++i)
         {
-            if (i == 0)
-                output << "(";
-            else
-                output << " ";
-
-            output << "(";
-            for (Size j = 0; j + 1 < n; ++j) // cannot use "j < n-1" because Size may be unsigned
-                output << matrix(i, j) << ","
-                       << spacesNeeded<Char,CharTraits>(elementOutputSizes(i, j), columnWidths[j]);
-            if (n >= 1)
-                output << matrix(i, n-1)
-                       << std::basic_string<Char,CharTraits>
-                           (columnWidths[n-1] - elementOutputSizes(i, n-1), ' ');
-            output << ")";
-
-            if (i + 1 == m) // cannot use "i == m-1" because Size may be unsigned
-                output << ")";
-            else
-                output << ",\n";
+            rows.format(matrix, i, i + 1);
+            outputRows(output, buffers.chunk_, rows, columnWidths, m);
         }
     }
 
     template<class Char, class CharTraits, class Matrix>
-    void doEqualWidthColumns(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
+    void doStoredElements(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                          NiceOutputBuffers<Char,CharTraits>& buffers) const
     {
-        typedef typename Matrix::size_type Size;
-        Size m = matrix.size1(),
-             n = matrix.size2();
+        StoredElementsWriter_<Char,CharTraits> writer(output, buffers.chunk_, getPlacing() == COMPACT_ROWS,
+                                                      minSpaces_);
+        writeStoredElements(matrix, writer, buffers, typename Matrix::orientation_category());
+        writer.finish();
+    }
 
-        boost::numeric::ublas::matrix<StreamSize> elementOutputSizes(m, n);
-        StreamSize width     = 0,
-                   lastWidth = 0;
-        for (Size i = 0; i < m; ++i)
-            for (Size j = 0; j < n; ++j)
+    /**
+     * Auxiliary method. Writes every stored element of a row-major matrix in the row order.
+     */
+    template<class Matrix, class Writer, class Buffers>
+    static void writeStoredElements(const Matrix& matrix, Writer& writer, Buffers&, row_major_tag)
+    {
+        typedef typename Matrix::const_iterator1 Iterator1;
+        typedef typename Matrix::const_iterator2 Iterator2;
+        for (Iterator1 it1 = matrix.begin1(); it1 != matrix.end1(); ++it1)
+            for (Iterator2 it2 = it1.begin(); it2 != it1.end(); ++it2)
+                writer(it2.index1(), it2.index2(), *it2);
+    }
+
+    template<class Matrix, class Writer, class Buffers>
+    inline static void writeStoredElements(const Matrix& matrix, Writer& writer, Buffers& buffers,
+                                           unknown_orientation_tag)
+    {
+        writeStoredElements(matrix, writer, buffers, row_major_tag());
+    }
+
+    /**
+     * Auxiliary method. Column-major version: elements are formatted column by column into the
+     * buffers, then their positions are sorted by rows.
+     */
+    template<class Char, class CharTraits, class Matrix, class Writer>
+    static void writeStoredElements(const Matrix& matrix, Writer& writer,
+                                    NiceOutputBuffers<Char,CharTraits>& buffers, column_major_tag)
+    {
+        typedef typename Matrix::const_iterator1 Iterator1;
+        typedef typename Matrix::const_iterator2 Iterator2;
+        typedef typename NiceOutputBuffers<Char,CharTraits>::StoredElement_ Element;
+        typedef typename std::vector<Element>::const_iterator ElementIterator;
+
+        std::basic_string<Char,CharTraits>& text = buffers.text_;
+        std::vector<Element>& elements = buffers.elements_;
+        text.clear();
+        elements.clear();
+        for (Iterator2 it2 = matrix.begin2(); it2 != matrix.end2(); ++it2)
+            for (Iterator1 it1 = it2.begin(); it1 != it2.end(); ++it1)
             {
-                StreamSize current = countValueOutputSize(output, matrix(i, j));
-                elementOutputSizes(i, j) = current;
-                if (current > width)
-                    width = current;
+                Element element = { it1.index1(), it1.index2(), text.size(), 0 };
+                writer.getFormatter().append(text, *it1);
+                element.end = text.size();
+                elements.push_back(element);
             }
-        if (n > 0)
-            for (Size i = 0; i < m; ++i)
-                if (elementOutputSizes(i, n-1) > lastWidth)
-                    lastWidth = elementOutputSizes(i, n-1);
+        std::sort(elements.begin(), elements.end(), isRowLess_<Element>);
 
-        for (Size i = 0; i < m; ++i)
-        {
-            if (i == 0)
-                output << "(";
-            else
-                output << " ";
-
-            output << "(";
-            for (Size j = 0; j + 1 < n; ++j) // cannot use "j < n-1" because Size may be unsigned
-                output << matrix(i, j) << ","
-                       << spacesNeeded<Char,CharTraits>(elementOutputSizes(i, j), width);
-            if (n >= 1)
-                output << matrix(i, n-1)
-                       << std::basic_string<Char,CharTraits>(width - elementOutputSizes(i, n-1), ' ');
-            output << ")";
-
-            if (i + 1 == m) // cannot use "i == m-1" because Size may be unsigned
-                output << ")";
-            else
-                output << ",\n";
-        }
+        for (ElementIterator it = elements.begin(); it != elements.end(); ++it)
+            writer.write(it->i, it->j, text.data() + it->begin, it->end - it->begin);
     }
 
     /**
-     * Auxiliary method.
-     * @return String consisted of spaces necessary to justify column.
+     * Auxiliary method. Appends formatted rows justified to given widths of columns to "chunk" and
+     * flushes the chunk whenever it grows over OUTPUT_CHUNK_SIZE.
+     * @param rowCount Number of rows of the whole matrix
      */
     template<class Char, class CharTraits>
-    inline std::basic_string<Char,CharTraits> spacesNeeded(StreamSize itemOutputSize,
-                                                           StreamSize justifySize) const
+    void outputRows(std::basic_ostream<Char,CharTraits>& output, std::basic_string<Char,CharTraits>& chunk,
+                    const FormattedRows_<Char,CharTraits>& rows, const ColumnWidths_& columnWidths,
+                    std::size_t rowCount) const
     {
-        StreamSize count = justifySize - itemOutputSize + minSpaces_;
-        return std::basic_string<Char,CharTraits>(count, ' ');
+        for (std::size_t local = 0; local < rows.getRowCount(); ++local)
+        {
+            appendRow(chunk, rows, local, columnWidths, rowCount);
+            flushChunk(output, chunk);
+        }
     }
 
     /* Fields */
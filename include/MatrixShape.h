@@ -0,0 +1,88 @@
+#ifndef __LIBUBLASAUX_MATRIXSHAPE_H__
+#define __LIBUBLASAUX_MATRIXSHAPE_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Describes a matrix that is never constructed: its type and the arguments its constructor would
+ * take. Used to stream random matrices bigger than memory (@see RandomGenerator#stream).
+ * @author Anton Liaukevich
+ * @brief Type and sizes of a matrix without its storage.
+ * @tparam Matrix Matrix type (for example "triangular_matrix<double,lower>")
+ */
+template<class Matrix>
+class MatrixShape {
+public:
+    /* Types */
+
+    typedef Matrix MatrixType;
+    typedef typename Matrix::value_type value_type;
+    typedef std::size_t size_type;
+
+    /* Construct/copy/destruct */
+
+    inline MatrixShape(size_type size1, size_type size2):
+        size1_(size1), size2_(size2), lower_(0), upper_(0) {}
+
+    /**
+     * Constructs shape of a banded matrix.
+     */
+    inline MatrixShape(size_type size1, size_type size2, size_type lower, size_type upper):
+        size1_(size1), size2_(size2), lower_(lower), upper_(upper) {}
+
+    /* Getters */
+
+    inline size_type size1() const
+    {
+        return size1_;
+    }
+
+    inline size_type size2() const
+    {
+        return size2_;
+    }
+
+    inline size_type lower() const
+    {
+        return lower_;
+    }
+
+    inline size_type upper() const
+    {
+        return upper_;
+    }
+
+private:
+    /* Fields */
+
+    size_type size1_,
+              size2_,
+              lower_,
+              upper_;
+
+}; //template class MatrixShape
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_MATRIXSHAPE_H__
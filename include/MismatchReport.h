@@ -0,0 +1,215 @@
+#ifndef __LIBUBLASAUX_MISMATCHREPORT_H__
+#define __LIBUBLASAUX_MISMATCHREPORT_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Result of an elementwise comparison of two vectors or matrices (@see ElementwiseComparer): number
+ * of compared elements and of mismatches (elements whose error exceeds the tolerance), the greatest
+ * error with position of the first element having it and a histogram of errors. Bucket number
+ * MIDDLE_BUCKET + k of the histogram counts errors from the interval
+ * (tolerance * 2^(k-1), tolerance * 2^k], the first bucket also counts smaller errors (zeros among
+ * them) and the last one greater errors (infinities and NaNs among them). So buckets after
+ * MIDDLE_BUCKET count mismatches only.
+ * @author Anton Liaukevich
+ * @brief Report of an elementwise comparison.
+ * @tparam Real_ Type of errors
+ */
+template<class Real_>
+class MismatchReport {
+    friend class ElementwiseComparer;
+
+public:
+    /* Types */
+
+    typedef Real_ Real;
+
+    /**
+     * Indices of an element (vector elements have 0 as the second index).
+     */
+    typedef std::pair<std::size_t,std::size_t> Position;
+
+    /* Constants */
+
+    static const std::size_t BUCKET_COUNT = 64;
+    static const std::size_t MIDDLE_BUCKET = 32;
+
+    /* Construct/copy/destruct */
+
+    explicit MismatchReport(Real tolerance = Real()):
+        tolerance_(tolerance), checkedCount_(0), mismatchCount_(0), worstPosition_(0, 0),
+        worstError_()
+    {
+        std::fill(buckets_, buckets_ + BUCKET_COUNT, std::size_t(0));
+        toleranceFraction_ = std::frexp(tolerance, &toleranceExponent_);
+        isBitwise_ = tolerance >= std::ldexp(Real(1), std::numeric_limits<Real>::min_exponent +
+                                                      static_cast<int>(MIDDLE_BUCKET));
+    }
+
+    /* Accessors */
+
+    inline Real getTolerance() const
+    {
+        return tolerance_;
+    }
+
+    inline std::size_t getCheckedCount() const
+    {
+        return checkedCount_;
+    }
+
+    inline std::size_t getMismatchCount() const
+    {
+        return mismatchCount_;
+    }
+
+    inline bool isMatch() const
+    {
+        return mismatchCount_ == 0;
+    }
+
+    /**
+     * @return Position of the first element with the greatest error ((0, 0) if all errors are zero)
+     */
+    inline const Position& getWorstPosition() const
+    {
+        return worstPosition_;
+    }
+
+    inline Real getWorstError() const
+    {
+        return worstError_;
+    }
+
+    inline std::size_t getBucket(std::size_t bucket) const
+    {
+        return buckets_[bucket];
+    }
+
+    /**
+     * @return Upper bound of errors counted by a bucket (except the last one)
+     */
+    inline Real getBucketBound(std::size_t bucket) const
+    {
+        return std::ldexp(tolerance_, static_cast<int>(bucket) - static_cast<int>(MIDDLE_BUCKET));
+    }
+
+private:
+
+    /**
+     * Adds errors of successive elements.
+     * @return Index of the element which has become the worst one or "count" if the worst one is
+     * not among them
+     */
+    std::size_t add_(const Real* errors, std::size_t count)
+    {
+        std::size_t worst = count;
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            Real error = errors[k];
+            ++buckets_[getBucketOf_(error)];
+            mismatchCount_ += error > tolerance_;
+            if (error > worstError_)
+            {
+                worstError_ = error;
+                worst = k;
+            }
+        }
+        checkedCount_ += count;
+        return worst;
+    }
+
+    /**
+     * Buckets are found by binary exponents and fractions of the error and of the tolerance, so
+     * they are exact. Float and double errors are compared by bits unless the tolerance is tiny (then
+     * zero or subnormal errors could get a bucket other than the first one).
+     */
+    template<class Value>
+    inline std::size_t getBucketOf_(Value error) const
+    {
+        if (error == Value())
+            return 0;
+        if (error == std::numeric_limits<Value>::infinity() || tolerance_ == Value())
+            return BUCKET_COUNT - 1;
+        int exponent;
+        Value fraction = std::frexp(error, &exponent);
+        return clamp_(exponent - toleranceExponent_ + (fraction > toleranceFraction_));
+    }
+
+    inline std::size_t getBucketOf_(double error) const
+    {
+        return getBucketOfBits_<boost::uint64_t>(error, 52);
+    }
+
+    inline std::size_t getBucketOf_(float error) const
+    {
+        return getBucketOfBits_<boost::uint32_t>(error, 23);
+    }
+
+    template<class Unsigned, class Value>
+    inline std::size_t getBucketOfBits_(Value error, int mantissaBits) const
+    {
+        if (!isBitwise_)
+            return getBucketOf_<Value>(error);
+        Unsigned bits, toleranceBits,
+                 mantissa = (Unsigned(1) << mantissaBits) - 1;
+        std::memcpy(&bits, &error, sizeof(bits));
+        std::memcpy(&toleranceBits, &tolerance_, sizeof(toleranceBits));
+        return clamp_(static_cast<int>(bits >> mantissaBits) -
+                      static_cast<int>(toleranceBits >> mantissaBits) +
+                      ((bits & mantissa) > (toleranceBits & mantissa)));
+    }
+
+    /**
+     * @return Bucket of errors exceeding the tolerance "2^power" times (rounded up)
+     */
+    inline static std::size_t clamp_(int power)
+    {
+        return static_cast<std::size_t>(std::min(std::max(power + static_cast<int>(MIDDLE_BUCKET), 0),
+                                                 static_cast<int>(BUCKET_COUNT) - 1));
+    }
+
+    /* Fields */
+
+    Real tolerance_,
+         toleranceFraction_;
+    int toleranceExponent_;
+    bool isBitwise_;
+    std::size_t checkedCount_,
+                mismatchCount_;
+    Position worstPosition_;
+    Real worstError_;
+    std::size_t buckets_[BUCKET_COUNT];
+
+}; //template class MismatchReport
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_MISMATCHREPORT_H__
@@ -0,0 +1,93 @@
+#ifndef __LIBUBLASAUX_NICEOUTPUTBUFFERS_H__
+#define __LIBUBLASAUX_NICEOUTPUTBUFFERS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <ios>
+#include <string>
+#include <vector>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Reusable scratch memory of "NiceOutputer"s (@see MatrixNiceOutputer, VectorNiceOutputer). An
+ * outputer given the same buffers again reuses memory they have grown to, so repeated output of
+ * vectors and matrices of the same shape does no heap allocation (as long as the elements are
+ * built-in numbers and the stream's locale formats them as the "C" one does, @see NumberFormatter).
+ * Buffers must not be used by several threads at once; keep one object per thread.
+ * @author Anton Liaukevich
+ * @brief Scratch buffers of NiceOutputers.
+ * @tparam Char Character type of the stream
+ * @tparam CharTraits Character traits of the stream
+ */
+template<class Char, class CharTraits = std::char_traits<Char> >
+class NiceOutputBuffers {
+    friend class MatrixNiceOutputer;
+    friend class ParallelMatrixNiceOutputer;
+    friend class VectorNiceOutputer;
+
+public:
+    /* Construct/copy/destruct */
+
+    inline NiceOutputBuffers() {}
+
+    /* Real actions */
+
+    /**
+     * Frees memory the buffers hold.
+     */
+    void release()
+    {
+        String().swap(chunk_);
+        String().swap(text_);
+        std::vector<std::size_t>().swap(ends_);
+        std::vector<std::streamsize>().swap(widths_);
+        std::vector<StoredElement_>().swap(elements_);
+    }
+
+private:
+    /* Types */
+
+    typedef std::basic_string<Char,CharTraits> String;
+
+    /**
+     * Position of a stored element and bounds of its text in "text_".
+     */
+    struct StoredElement_ {
+        std::size_t i,
+                    j,
+                    begin,
+                    end;
+    };
+
+    /* Fields */
+
+    String chunk_, ///< Text gathered to be written to the stream
+           text_;  ///< Text of formatted elements
+    std::vector<std::size_t> ends_;
+    std::vector<std::streamsize> widths_;
+    std::vector<StoredElement_> elements_;
+
+}; //template class NiceOutputBuffers
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_NICEOUTPUTBUFFERS_H__
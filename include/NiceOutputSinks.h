@@ -0,0 +1,285 @@
+#ifndef __LIBUBLASAUX_NICEOUTPUTSINKS_H__
+#define __LIBUBLASAUX_NICEOUTPUTSINKS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <ios>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <boost/config.hpp>
+#ifdef BOOST_HAS_UNISTD_H
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/*
+ * Sinks are light stream buffers for "NiceOutputer"s (@see MatrixNiceOutputer, VectorNiceOutputer).
+ * Outputers gather text of many elements and write it by one "write" call per chunk, so a sink
+ * only has to move chunks to their destination. Attach a sink to a stream once and output through
+ * the stream as usual; formatting flags of the stream are taken into account as before:
+ *
+ *     DescriptorOutputSink sink(STDOUT_FILENO);
+ *     std::ostream output(&sink);
+ *     outputer(output, matrix, buffers);
+ *
+ * A sink which cannot write any more makes the stream "bad" as every stream buffer does.
+ */
+
+
+/**
+ * Sink writing into a character array given by user (by "memcpy"). Nothing is allocated.
+ * @author Anton Liaukevich
+ * @brief Output to a raw character buffer.
+ * @tparam Char Character type of the stream
+ * @tparam CharTraits Character traits of the stream
+ * @remark Text which does not fit the array is cut off and the stream becomes "bad".
+ */
+template<class Char, class CharTraits = std::char_traits<Char> >
+class ArrayOutputSink: public std::basic_streambuf<Char,CharTraits> {
+public:
+    /* Construct/copy/destruct */
+
+    inline ArrayOutputSink(Char* array, std::size_t size)
+    {
+        this->setp(array, array + size);
+    }
+
+    /* Field (read-only) access */
+
+    inline const Char* getData() const
+    {
+        return this->pbase();
+    }
+
+    /**
+     * @return Number of characters written
+     */
+    inline std::size_t getSize() const
+    {
+        return this->pptr() - this->pbase();
+    }
+
+    /* Real actions */
+
+    /**
+     * Starts writing from the beginning of the array again.
+     */
+    inline void rewind()
+    {
+        this->setp(this->pbase(), this->epptr());
+    }
+
+protected:
+
+    virtual std::streamsize xsputn(const Char* text, std::streamsize size)
+    {
+        std::streamsize room = this->epptr() - this->pptr();
+        if (size > room)
+            size = room;
+        CharTraits::copy(this->pptr(), text, static_cast<std::size_t>(size));
+        this->pbump(static_cast<int>(size));
+        return size;
+    }
+
+}; //template class ArrayOutputSink
+
+
+/**
+ * Sink writing to a C stream by "fwrite". It keeps no buffer of its own: chunks of outputers go to
+ * the C stream at once, which writes big chunks straight to its file.
+ * @author Anton Liaukevich
+ * @brief Output to a FILE*.
+ */
+class FileOutputSink: public std::streambuf {
+public:
+    /* Construct/copy/destruct */
+
+    /**
+     * @param file Open C stream. It is neither flushed nor closed by destructor.
+     */
+    inline explicit FileOutputSink(std::FILE* file): file_(file) {}
+
+    /* Field (read-only) access */
+
+    inline std::FILE* getFile() const
+    {
+        return file_;
+    }
+
+protected:
+
+    virtual int_type overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        return std::fputc(traits_type::to_char_type(c), file_) == EOF ? traits_type::eof() : c;
+    }
+
+    virtual std::streamsize xsputn(const char* text, std::streamsize size)
+    {
+        return static_cast<std::streamsize>(std::fwrite(text, 1, static_cast<std::size_t>(size), file_));
+    }
+
+    virtual int sync()
+    {
+        return std::fflush(file_) == 0 ? 0 : -1;
+    }
+
+private:
+
+    FileOutputSink(const FileOutputSink&);
+    FileOutputSink& operator=(const FileOutputSink&);
+
+    std::FILE* file_;
+
+}; //class FileOutputSink
+
+
+#ifdef BOOST_HAS_UNISTD_H
+
+/**
+ * Sink writing to a POSIX file descriptor by "writev" through a big buffer. Small pieces of text are
+ * gathered in the buffer; a chunk which does not fit it is written together with the buffered text
+ * by one "writev" call without being copied.
+ * @author Anton Liaukevich
+ * @brief Output to a file descriptor.
+ * @remark The sink is flushed by destructor and by "std::flush". Available on POSIX systems only.
+ */
+class DescriptorOutputSink: public std::streambuf {
+public:
+    /* Constants */
+
+    static const std::size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+    /* Construct/copy/destruct */
+
+    /**
+     * @param descriptor Descriptor open for writing. It is not closed by destructor.
+     * @param bufferSize Size of the buffer, in bytes
+     */
+    inline explicit DescriptorOutputSink(int descriptor, std::size_t bufferSize = DEFAULT_BUFFER_SIZE):
+        descriptor_(descriptor), buffer_(bufferSize > 0 ? bufferSize : 1)
+    {
+        setp(&buffer_[0], &buffer_[0] + buffer_.size());
+    }
+
+    inline ~DescriptorOutputSink()
+    {
+        flush_(0, 0);
+    }
+
+    /* Field (read-only) access */
+
+    inline int getDescriptor() const
+    {
+        return descriptor_;
+    }
+
+protected:
+
+    virtual int_type overflow(int_type c)
+    {
+        if (!flush_(0, 0))
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    virtual std::streamsize xsputn(const char* text, std::streamsize size)
+    {
+        if (size <= epptr() - pptr())
+        {
+            traits_type::copy(pptr(), text, static_cast<std::size_t>(size));
+            pbump(static_cast<int>(size));
+            return size;
+        }
+        return flush_(text, static_cast<std::size_t>(size)) ? size : 0;
+    }
+
+    virtual int sync()
+    {
+        return flush_(0, 0) ? 0 : -1;
+    }
+
+private:
+
+    DescriptorOutputSink(const DescriptorOutputSink&);
+    DescriptorOutputSink& operator=(const DescriptorOutputSink&);
+
+    /**
+     * Writes the buffered text followed by "size" characters of "text" and empties the buffer.
+     * @return False if writing has failed
+     */
+    bool flush_(const char* text, std::size_t size)
+    {
+        iovec parts[2];
+        parts[0].iov_base = pbase();
+        parts[0].iov_len = static_cast<std::size_t>(pptr() - pbase());
+        parts[1].iov_base = const_cast<char*>(text);
+        parts[1].iov_len = size;
+        setp(pbase(), epptr());
+
+        iovec* first = parts[0].iov_len > 0 ? parts : parts + 1;
+        iovec* last = parts + (size > 0 ? 2 : 1);
+        while (first != last)
+        {
+            ssize_t written = ::writev(descriptor_, first, static_cast<int>(last - first));
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            /* Skip parts written entirely, then the written beginning of the next one */
+            std::size_t rest = static_cast<std::size_t>(written);
+            while (first != last && rest >= first->iov_len)
+            {
+                rest -= first->iov_len;
+                ++first;
+            }
+            if (first != last)
+            {
+                first->iov_base = static_cast<char*>(first->iov_base) + rest;
+                first->iov_len -= rest;
+            }
+        }
+        return true;
+    }
+
+    int descriptor_;
+    std::vector<char> buffer_;
+
+}; //class DescriptorOutputSink
+
+#endif //BOOST_HAS_UNISTD_H
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_NICEOUTPUTSINKS_H__
@@ -0,0 +1,675 @@
+#ifndef __LIBUBLASAUX_NICETEXTREADER_H__
+#define __LIBUBLASAUX_NICETEXTREADER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/vector_sparse.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Reads back text written by VectorNiceOutputer and MatrixNiceOutputer in any of their element
+ * placings: plain and justified rows, coordinate lists and compact rows of stored elements. Text is
+ * scanned by hand and numbers are converted without streams: decimal numbers of up to 15 (7 for
+ * "float") significant digits and small exponents, which is what the outputers write with default
+ * precision, are converted exactly by one multiplication or division; other numbers (longer ones,
+ * "inf", "nan", hexadecimal floating-point) go through "strtod". Values are parsed as the value type
+ * of the target container, then the target is assigned from a temporary "matrix" / "vector" (dense
+ * text) or "coordinate_matrix" / "coordinate_vector" (text of stored elements) of this value type,
+ * so the target can be any assignable container type. This class implements "Monostate" pattern
+ * (only static methods).
+ * @author Anton Liaukevich
+ * @brief Fast parser of the NiceOutputer text format.
+ * @remark Integer values must be decimal. Floating-point numbers are converted by "strtod" in the
+ * current C locale when they leave the fast path.
+ */
+class NiceTextReader {
+public:
+    /* Real actions */
+
+    /**
+     * Parses a matrix from text in memory.
+     * @return Pointer past the parsed text or 0 if the text is malformed (the matrix is left
+     * unchanged then)
+     */
+    template<class Matrix>
+    static const char* readMatrix(const char* first, const char* last, Matrix& matr)
+    {
+        typedef typename Matrix::value_type Value;
+
+        Scanner_ scanner(first, last);
+        std::size_t size1, size2;
+        if (!(scanner.expect('[') && scanner.parseIndex(size1) && scanner.expect(',') &&
+              scanner.parseIndex(size2) && scanner.expect(']') && scanner.expect('(')))
+            return 0;
+
+        if (scanner.isStoredElements(true))
+        {
+            coordinate_matrix<Value> temp(size1, size2);
+            if (!parseStoredElements_(scanner, temp))
+                return 0;
+            matr = temp;
+        }
+        else
+        {
+            matrix<Value> temp(size1, size2);
+            if (!parseRows_(scanner, temp))
+                return 0;
+            assign_(matr, temp);
+        }
+        return scanner.getPosition();
+    }
+
+    /**
+     * Parses a vector from text in memory.
+     * @return Pointer past the parsed text or 0 if the text is malformed (the vector is left
+     * unchanged then)
+     */
+    template<class Vector>
+    static const char* readVector(const char* first, const char* last, Vector& vect)
+    {
+        typedef typename Vector::value_type Value;
+
+        Scanner_ scanner(first, last);
+        std::size_t size;
+        if (!(scanner.expect('[') && scanner.parseIndex(size) && scanner.expect(']') && scanner.expect('(')))
+            return 0;
+
+        if (scanner.isStoredElements(false))
+        {
+            coordinate_vector<Value> temp(size);
+            if (!parseStoredElements_(scanner, temp))
+                return 0;
+            vect = temp;
+        }
+        else
+        {
+            vector<Value> temp(size);
+            if (!parseRow_(scanner, temp))
+                return 0;
+            assign_(vect, temp);
+        }
+        return scanner.getPosition();
+    }
+
+    /**
+     * Reads a matrix from a stream: its text is taken up to the closing parenthesis and parsed as
+     * by readMatrix(first, last, matr). Sets "failbit" of the stream if the text is malformed.
+     */
+    template<class Matrix>
+    static void readMatrix(std::istream& input, Matrix& matr)
+    {
+        std::string text;
+        if (extract_(input, text) && readMatrix(text.data(), text.data() + text.size(), matr) == 0)
+            input.setstate(std::ios_base::failbit);
+    }
+
+    /**
+     * Reads a vector from a stream (@see readMatrix(std::istream&,Matrix&)).
+     */
+    template<class Vector>
+    static void readVector(std::istream& input, Vector& vect)
+    {
+        std::string text;
+        if (extract_(input, text) && readVector(text.data(), text.data() + text.size(), vect) == 0)
+            input.setstate(std::ios_base::failbit);
+    }
+
+private:
+    /* Types */
+
+    /**
+     * Limits of exact conversion of decimal numbers: numbers whose mantissa does not exceed
+     * MAX_MANTISSA and whose decimal exponent does not exceed MAX_EXPONENT by absolute value are
+     * converted by one correctly rounded operation on exact numbers.
+     */
+    template<class Real>
+    struct RealTraits_ {
+        static const boost::uint64_t MAX_MANTISSA = boost::uint64_t(1) << 53;
+        static const int MAX_EXPONENT = 22;
+
+        inline static Real convert(const char* text, char** end)
+        {
+            return std::strtod(text, end);
+        }
+    };
+
+    /**
+     * Hand-written scanner of text in memory.
+     */
+    class Scanner_ {
+    public:
+
+        inline Scanner_(const char* first, const char* last):
+            position_(first), last_(last) {}
+
+        inline const char* getPosition() const
+        {
+            return position_;
+        }
+
+        /**
+         * Skips spaces and looks at the next character.
+         * @return The character or '\0' at the end of text
+         */
+        inline char peek()
+        {
+            while (position_ != last_ &&
+                   (*position_ == ' ' || *position_ == '\n' || *position_ == '\t' || *position_ == '\r'))
+                ++position_;
+            return position_ == last_ ? '\0' : *position_;
+        }
+
+        /**
+         * Skips spaces and a given character if it is the next one.
+         */
+        inline bool expect(char c)
+        {
+            if (peek() != c)
+                return false;
+            ++position_;
+            return true;
+        }
+
+        bool parseIndex(std::size_t& index)
+        {
+            peek();
+            return parseValue_(position_, last_, index);
+        }
+
+        template<class Value>
+        inline bool parseValue(Value& value)
+        {
+            peek();
+            return parseValue_(position_, last_, value);
+        }
+
+        /**
+         * Looks (just after the opening parenthesis of a container) whether the text lists stored
+         * elements with indices: "(i, j): value" / "i: (j: value, ...)" for matrices and
+         * "i: value" for vectors. Empty text "()" is taken as a list of stored elements.
+         */
+        bool isStoredElements(bool isMatrix)
+        {
+            char next = peek();
+            if (next == ')')
+                return true; // no stored elements (or no elements at all)
+            if (next >= '0' && next <= '9')
+            {
+                if (isMatrix)
+                    return true;
+                const char* p = position_;
+                while (p != last_ && *p >= '0' && *p <= '9')
+                    ++p;
+                while (p != last_ && *p == ' ')
+                    ++p;
+                return p != last_ && *p == ':';
+            }
+            if (!isMatrix || next != '(')
+                return false;
+            // Row of a dense matrix or coordinates of an element followed by ':'
+            int depth = 0;
+            for (const char* p = position_; p != last_; ++p)
+                if (*p == '(')
+                    ++depth;
+                else if (*p == ')' && --depth == 0)
+                {
+                    for (++p; p != last_ && (*p == ' ' || *p == '\n'); ++p) ;
+                    return p != last_ && *p == ':';
+                }
+            return false;
+        }
+
+    private:
+
+        const char* position_;
+        const char* last_;
+    };
+
+    /* Parsing of containers */
+
+    /**
+     * Parses rows "(a, b, c)" separated by commas up to the closing parenthesis of a matrix.
+     */
+    template<class Value>
+    static bool parseRows_(Scanner_& scanner, matrix<Value>& temp)
+    {
+        if (temp.size1() == 0)
+            return scanner.expect(')');
+        for (std::size_t i = 0; i < temp.size1(); ++i)
+        {
+            if (!scanner.expect('('))
+                return false;
+            matrix_row< matrix<Value> > row(temp, i);
+            if (!parseRow_(scanner, row) || !scanner.expect(i + 1 == temp.size1() ? ')' : ','))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Parses elements "a, b, c)" of a row or a vector after its opening parenthesis.
+     */
+    template<class Row>
+    static bool parseRow_(Scanner_& scanner, Row& row)
+    {
+        typename Row::value_type value;
+        for (std::size_t j = 0; j < row.size(); ++j)
+        {
+            if (!scanner.parseValue(value) || !scanner.expect(j + 1 == row.size() ? ')' : ','))
+                return false;
+            row(j) = value;
+        }
+        return row.size() > 0 || scanner.expect(')');
+    }
+
+    /**
+     * Parses a coordinate list "((i, j): value, ...)" or compact rows "(i: (j: value, ...), ...)"
+     * after the opening parenthesis of a matrix.
+     */
+    template<class Value>
+    static bool parseStoredElements_(Scanner_& scanner, coordinate_matrix<Value>& temp)
+    {
+        if (scanner.expect(')'))
+            return true;
+        bool isCompact = scanner.peek() != '(';
+        do
+        {
+            std::size_t i, j;
+            Value value;
+            if (isCompact)
+            {
+                if (!(scanner.parseIndex(i) && scanner.expect(':') && scanner.expect('(')) || i >= temp.size1())
+                    return false;
+                do
+                {
+                    if (!(scanner.parseIndex(j) && scanner.expect(':') && scanner.parseValue(value)) ||
+                        j >= temp.size2())
+                        return false;
+                    temp.append_element(i, j, value);
+                }
+                while (scanner.expect(','));
+                if (!scanner.expect(')'))
+                    return false;
+            }
+            else
+            {
+                if (!(scanner.expect('(') && scanner.parseIndex(i) && scanner.expect(',') &&
+                      scanner.parseIndex(j) && scanner.expect(')') && scanner.expect(':') &&
+                      scanner.parseValue(value)) || i >= temp.size1() || j >= temp.size2())
+                    return false;
+                temp.append_element(i, j, value);
+            }
+        }
+        while (scanner.expect(','));
+        return scanner.expect(')');
+    }
+
+    /**
+     * Parses stored elements "(i: value, ...)" of a vector after its opening parenthesis.
+     */
+    template<class Value>
+    static bool parseStoredElements_(Scanner_& scanner, coordinate_vector<Value>& temp)
+    {
+        if (scanner.expect(')'))
+            return true;
+        do
+        {
+            std::size_t i;
+            Value value;
+            if (!(scanner.parseIndex(i) && scanner.expect(':') && scanner.parseValue(value)) ||
+                i >= temp.size())
+                return false;
+            temp.append_element(i, value);
+        }
+        while (scanner.expect(','));
+        return scanner.expect(')');
+    }
+
+    /**
+     * Assigns a parsed temporary to the target, swapping them if they have the same type.
+     */
+    template<class Container, class Temp>
+    inline static void assign_(Container& container, Temp& temp)
+    {
+        container = temp;
+    }
+
+    template<class Value>
+    inline static void assign_(matrix<Value>& container, matrix<Value>& temp)
+    {
+        container.swap(temp);
+    }
+
+    template<class Value>
+    inline static void assign_(vector<Value>& container, vector<Value>& temp)
+    {
+        container.swap(temp);
+    }
+
+    /**
+     * Takes text of a container from a stream: from the first non-space character up to the
+     * parenthesis closing the first opened one.
+     */
+    static bool extract_(std::istream& input, std::string& text)
+    {
+        std::istream::sentry sentry(input);
+        if (!sentry)
+            return false;
+        std::streambuf* buffer = input.rdbuf();
+        int depth = 0;
+        for (int c = buffer->sbumpc(); c != std::char_traits<char>::eof(); c = buffer->sbumpc())
+        {
+            text += static_cast<char>(c);
+            if (c == '(')
+                ++depth;
+            else if (c == ')' && --depth == 0)
+                return true;
+        }
+        input.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+        return false;
+    }
+
+    /* Parsing of numbers */
+
+    inline static bool isDigit_(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline static bool isLetter_(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    template<class Unsigned>
+    static bool parseUnsigned_(const char*& p, const char* last, Unsigned& value)
+    {
+        if (p == last || !isDigit_(*p))
+            return false;
+        Unsigned result = 0;
+        for (; p != last && isDigit_(*p); ++p)
+        {
+            Unsigned next = result * 10 + (*p - '0');
+            if (next / 10 != result)
+                return false; // overflow
+            result = next;
+        }
+        value = result;
+        return true;
+    }
+
+    template<class Unsigned, class Value>
+    static bool parseSigned_(const char*& p, const char* last, Value& value)
+    {
+        bool isNegative = p != last && *p == '-';
+        if (p != last && (*p == '-' || *p == '+'))
+            ++p;
+        Unsigned magnitude;
+        if (!parseUnsigned_(p, last, magnitude))
+            return false;
+        Unsigned limit = static_cast<Unsigned>(~Unsigned(0) >> 1) + (isNegative ? 1 : 0);
+        if (magnitude > limit)
+            return false;
+        value = isNegative ? static_cast<Value>(Unsigned(0) - magnitude) : static_cast<Value>(magnitude);
+        return true;
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, short& value)
+    {
+        return parseSigned_<unsigned short>(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, int& value)
+    {
+        return parseSigned_<unsigned>(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, long& value)
+    {
+        return parseSigned_<unsigned long>(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, boost::long_long_type& value)
+    {
+        return parseSigned_<boost::ulong_long_type>(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, unsigned short& value)
+    {
+        return parseUnsigned_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, unsigned& value)
+    {
+        return parseUnsigned_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, unsigned long& value)
+    {
+        return parseUnsigned_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, boost::ulong_long_type& value)
+    {
+        return parseUnsigned_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, float& value)
+    {
+        return parseReal_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, double& value)
+    {
+        return parseReal_(p, last, value);
+    }
+
+    inline static bool parseValue_(const char*& p, const char* last, long double& value)
+    {
+        return parseReal_(p, last, value);
+    }
+
+    /**
+     * Complex numbers are written as "(re,im)"; a single real number is also accepted.
+     */
+    template<class Real>
+    static bool parseValue_(const char*& p, const char* last, std::complex<Real>& value)
+    {
+        Real re, im = Real();
+        if (p == last || *p != '(')
+        {
+            if (!parseValue_(p, last, re))
+                return false;
+        }
+        else
+        {
+            ++p;
+            if (!parseValue_(p, last, re))
+                return false;
+            if (p != last && *p == ',' && !parseValue_(++p, last, im))
+                return false;
+            if (p == last || *p != ')')
+                return false;
+            ++p;
+        }
+        value = std::complex<Real>(re, im);
+        return true;
+    }
+
+    /**
+     * Other types are extracted from a string stream.
+     */
+    template<class Value>
+    static bool parseValue_(const char*& p, const char* last, Value& value)
+    {
+        const char* end = findTokenEnd_(p, last);
+        std::istringstream stream(std::string(p, end));
+        stream.imbue(std::locale::classic());
+        if (!(stream >> value))
+            return false;
+        p = end;
+        return true;
+    }
+
+    /**
+     * @return End of a number which begins at "p": position of a delimiter of the text format
+     */
+    static const char* findTokenEnd_(const char* p, const char* last)
+    {
+        while (p != last && *p != ',' && *p != ')' && *p != '(' && *p != ':' &&
+               *p != ' ' && *p != '\n' && *p != '\t' && *p != '\r')
+            ++p;
+        return p;
+    }
+
+    template<class Real>
+    static bool parseReal_(const char*& p, const char* last, Real& value)
+    {
+        typedef RealTraits_<Real> Traits;
+
+        const char* first = p;
+        bool isNegative = p != last && *p == '-';
+        if (p != last && (*p == '-' || *p == '+'))
+            ++p;
+
+        boost::uint64_t mantissa = 0;
+        int exponent = 0;
+        bool hasDigits = false,
+             isExact = true;
+        for (; p != last && isDigit_(*p); ++p)
+        {
+            hasDigits = true;
+            if (mantissa <= Traits::MAX_MANTISSA)
+                mantissa = mantissa * 10 + (*p - '0');
+            else
+                isExact = false;
+        }
+        if (p != last && *p == '.')
+            for (++p; p != last && isDigit_(*p); ++p)
+            {
+                hasDigits = true;
+                if (mantissa <= Traits::MAX_MANTISSA)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    --exponent;
+                }
+                else if (*p != '0')
+                    isExact = false;
+            }
+        if (hasDigits && p != last && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            int exponentValue;
+            if (!parseSigned_<unsigned>(p, last, exponentValue))
+                return false;
+            // Huge exponents are cut not to overflow "exponent"; they leave the fast path anyway
+            exponent += exponentValue < -10000 ? -10000 : exponentValue > 10000 ? 10000 : exponentValue;
+        }
+
+        if (!hasDigits || (p != last && isLetter_(*p)) || !isExact ||
+            mantissa > Traits::MAX_MANTISSA || exponent < -Traits::MAX_EXPONENT ||
+            exponent > Traits::MAX_EXPONENT)
+            return convertReal_(first, last, p, value);
+
+        Real result = static_cast<Real>(mantissa);
+        if (exponent < 0)
+            result /= getPower10_<Real>(-exponent);
+        else if (exponent > 0)
+            result *= getPower10_<Real>(exponent);
+        value = isNegative ? -result : result;
+        return true;
+    }
+
+    /**
+     * Slow path of parseReal_: converts a number by "strtod".
+     */
+    template<class Real>
+    static bool convertReal_(const char* first, const char* last, const char*& p, Real& value)
+    {
+        char buffer[128];
+        const char* end = findTokenEnd_(first, last);
+        if (end == first || end - first >= static_cast<std::ptrdiff_t>(sizeof(buffer)))
+            return false;
+        std::copy(first, end, buffer);
+        buffer[end - first] = '\0';
+        char* parsedEnd;
+        Real result = RealTraits_<Real>::convert(buffer, &parsedEnd);
+        if (parsedEnd != buffer + (end - first))
+            return false;
+        p = end;
+        value = result;
+        return true;
+    }
+
+    /**
+     * @return 10 to a power between 0 and 22 (these powers are exact double numbers)
+     */
+    template<class Real>
+    inline static Real getPower10_(int exponent)
+    {
+        static const double POWERS[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        return static_cast<Real>(POWERS[exponent]);
+    }
+
+}; //class NiceTextReader
+
+template<>
+struct NiceTextReader::RealTraits_<float> {
+    static const boost::uint64_t MAX_MANTISSA = boost::uint64_t(1) << 24;
+    static const int MAX_EXPONENT = 10;
+
+    inline static float convert(const char* text, char** end)
+    {
+        return std::strtof(text, end);
+    }
+};
+
+template<>
+struct NiceTextReader::RealTraits_<long double> {
+    static const boost::uint64_t MAX_MANTISSA = boost::uint64_t(1) << 53;
+    static const int MAX_EXPONENT = 22;
+
+    inline static long double convert(const char* text, char** end)
+    {
+        return std::strtold(text, end);
+    }
+};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_NICETEXTREADER_H__
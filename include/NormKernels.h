@@ -0,0 +1,559 @@
+#ifndef __LIBUBLASAUX_NORMKERNELS_H__
+#define __LIBUBLASAUX_NORMKERNELS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CpuFeatures.h"
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Kernels accumulating norms of the difference of two contiguous real arrays. Element k is added to
+ * partial sum number k % Lanes::COUNT and partial sums are added pairwise at the end; every code path
+ * (AVX-512, AVX2, scalar) keeps this order, so all of them give bit-identical results. A NaN
+ * difference makes the result NaN. This class implements "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief SIMD accumulation of norm_1, norm_2 and norm_inf of a difference.
+ * @remark Scalar formulas must not be contracted to FMA instructions by the compiler (GCC does not
+ * do it in ISO modes; see -ffp-contract).
+ */
+class NormKernels {
+public:
+    /* Types */
+
+    /**
+     * Number of partial sums: two AVX-512 registers (four AVX2 ones).
+     */
+    template<class Real>
+    struct Lanes {
+        static const std::size_t COUNT = 128 / sizeof(Real);
+    };
+
+    /* Real actions */
+
+    /**
+     * Adds |x[k] - y[k]| to partial sum number (offset + k) % Lanes::COUNT. Arrays may be passed by
+     * several calls with growing "offset": partial sums do not depend on how they are split.
+     */
+    template<class Real>
+    static void addAbsDiff(const Real* x, const Real* y, std::size_t count, Real* lanes,
+                           std::size_t offset = 0)
+    {
+        const std::size_t lanesCount = Lanes<Real>::COUNT;
+        std::size_t k = 0;
+        for (; k < count && (offset + k) % lanesCount != 0; ++k)
+            lanes[(offset + k) % lanesCount] += std::abs(x[k] - y[k]);
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            k += addAbsDiffAvx512_(x + k, y + k, count - k, lanes);
+        else if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            k += addAbsDiffAvx2_(x + k, y + k, count - k, lanes);
+#endif
+        for (; k + lanesCount <= count; k += lanesCount)
+            for (std::size_t j = 0; j < lanesCount; ++j)
+                lanes[j] += std::abs(x[k + j] - y[k + j]);
+        for (std::size_t j = 0; k + j < count; ++j)
+            lanes[j] += std::abs(x[k + j] - y[k + j]);
+    }
+
+    /**
+     * Adds (x[k] - y[k])^2 to partial sum number (offset + k) % Lanes::COUNT
+     * (@see addAbsDiff).
+     */
+    template<class Real>
+    static void addSquaredDiff(const Real* x, const Real* y, std::size_t count, Real* lanes,
+                               std::size_t offset = 0)
+    {
+        const std::size_t lanesCount = Lanes<Real>::COUNT;
+        std::size_t k = 0;
+        for (; k < count && (offset + k) % lanesCount != 0; ++k)
+            lanes[(offset + k) % lanesCount] += (x[k] - y[k]) * (x[k] - y[k]);
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            k += addSquaredDiffAvx512_(x + k, y + k, count - k, lanes);
+        else if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            k += addSquaredDiffAvx2_(x + k, y + k, count - k, lanes);
+#endif
+        for (; k + lanesCount <= count; k += lanesCount)
+            for (std::size_t j = 0; j < lanesCount; ++j)
+                lanes[j] += (x[k + j] - y[k + j]) * (x[k + j] - y[k + j]);
+        for (std::size_t j = 0; k + j < count; ++j)
+            lanes[j] += (x[k + j] - y[k + j]) * (x[k + j] - y[k + j]);
+    }
+
+    /**
+     * @return Sum of partial sums added pairwise
+     */
+    template<class Real>
+    static Real addLanes(const Real* lanes)
+    {
+        Real sums[Lanes<Real>::COUNT];
+        std::copy(lanes, lanes + Lanes<Real>::COUNT, sums);
+        for (std::size_t width = Lanes<Real>::COUNT / 2; width > 0; width /= 2)
+            for (std::size_t k = 0; k < width; ++k)
+                sums[k] += sums[k + width];
+        return sums[0];
+    }
+
+    /**
+     * @return Maximum of |x[k] - y[k]| (0 for empty arrays)
+     */
+    template<class Real>
+    static Real maxAbsDiff(const Real* x, const Real* y, std::size_t count)
+    {
+        Real result = Real();
+        std::size_t done = 0;
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            done = maxAbsDiffAvx512_(x, y, count, result);
+        else if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            done = maxAbsDiffAvx2_(x, y, count, result);
+#endif
+        for (std::size_t k = done; k < count; ++k)
+            result = max(result, std::abs(x[k] - y[k]));
+        return result;
+    }
+
+    /**
+     * Maximum which returns NaN if any of its arguments is NaN.
+     */
+    template<class Real>
+    inline static Real max(Real current, Real value)
+    {
+        return (value > current || value != value) && current == current ? value : current;
+    }
+
+private:
+
+#ifdef LIBUBLASAUX_SIMD_X86
+
+    /*
+     * Operations on SIMD registers used by kernels (every kernel is written once for both real types)
+     */
+
+    template<class Real>
+    struct Avx2_ {};
+
+    template<class Real>
+    struct Avx512_ {};
+
+    /*
+     * AVX2 kernels. They process whole blocks of Lanes::COUNT elements, update partial results and
+     * return number of processed elements
+     */
+
+    template<class Real>
+    __attribute__((target("avx2")))
+    static std::size_t addAbsDiffAvx2_(const Real* x, const Real* y, std::size_t count, Real* lanes)
+    {
+        typedef Avx2_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register sums[unroll];
+        for (std::size_t j = 0; j < unroll; ++j)
+            sums[j] = Simd::load(lanes + j * width);
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+                sums[j] = Simd::add(sums[j], Simd::abs(Simd::sub(Simd::load(x + k + j * width),
+                                                                 Simd::load(y + k + j * width))));
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, sums[j]);
+        return k;
+    }
+
+    template<class Real>
+    __attribute__((target("avx2")))
+    static std::size_t addSquaredDiffAvx2_(const Real* x, const Real* y, std::size_t count,
+                                           Real* lanes)
+    {
+        typedef Avx2_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register sums[unroll];
+        for (std::size_t j = 0; j < unroll; ++j)
+            sums[j] = Simd::load(lanes + j * width);
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+            {
+                Register difference = Simd::sub(Simd::load(x + k + j * width),
+                                                Simd::load(y + k + j * width));
+                sums[j] = Simd::add(sums[j], Simd::mul(difference, difference));
+            }
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, sums[j]);
+        return k;
+    }
+
+    template<class Real>
+    __attribute__((target("avx2")))
+    static std::size_t maxAbsDiffAvx2_(const Real* x, const Real* y, std::size_t count, Real& result)
+    {
+        typedef Avx2_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register maxima[unroll], nans = Simd::zero();
+        for (std::size_t j = 0; j < unroll; ++j)
+            maxima[j] = Simd::zero();
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+            {
+                Register difference = Simd::abs(Simd::sub(Simd::load(x + k + j * width),
+                                                          Simd::load(y + k + j * width)));
+                maxima[j] = Simd::max(maxima[j], difference);
+                nans = Simd::orUnordered(nans, difference);
+            }
+        Real lanes[Lanes<Real>::COUNT];
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, maxima[j]);
+        for (std::size_t j = 0; j < Lanes<Real>::COUNT; ++j)
+            result = max(result, lanes[j]);
+        if (Simd::isAny(nans))
+            result = std::numeric_limits<Real>::quiet_NaN();
+        return k;
+    }
+
+    /*
+     * AVX-512 kernels (the same as AVX2 ones). AVX-512 implies FMA, so products and sums use
+     * explicit rounding in order to keep the compiler from contracting them
+     */
+
+    static const int ROUNDING_ = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    // Unmasked AVX-512 intrinsics of GCC start from an "undefined" vector, which makes
+    // -Wmaybe-uninitialized give false warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    template<class Real>
+    __attribute__((target("avx512f")))
+    static std::size_t addAbsDiffAvx512_(const Real* x, const Real* y, std::size_t count,
+                                         Real* lanes)
+    {
+        typedef Avx512_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register sums[unroll];
+        for (std::size_t j = 0; j < unroll; ++j)
+            sums[j] = Simd::load(lanes + j * width);
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+                sums[j] = Simd::add(sums[j], Simd::abs(Simd::sub(Simd::load(x + k + j * width),
+                                                                 Simd::load(y + k + j * width))));
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, sums[j]);
+        return k;
+    }
+
+    template<class Real>
+    __attribute__((target("avx512f")))
+    static std::size_t addSquaredDiffAvx512_(const Real* x, const Real* y, std::size_t count,
+                                             Real* lanes)
+    {
+        typedef Avx512_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register sums[unroll];
+        for (std::size_t j = 0; j < unroll; ++j)
+            sums[j] = Simd::load(lanes + j * width);
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+            {
+                Register difference = Simd::sub(Simd::load(x + k + j * width),
+                                                Simd::load(y + k + j * width));
+                sums[j] = Simd::add(sums[j], Simd::mul(difference, difference));
+            }
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, sums[j]);
+        return k;
+    }
+
+    template<class Real>
+    __attribute__((target("avx512f")))
+    static std::size_t maxAbsDiffAvx512_(const Real* x, const Real* y, std::size_t count,
+                                         Real& result)
+    {
+        typedef Avx512_<Real> Simd;
+        typedef typename Simd::Register Register;
+        const std::size_t width = Simd::WIDTH, unroll = Lanes<Real>::COUNT / width;
+        Register maxima[unroll];
+        unsigned nans = 0;
+        for (std::size_t j = 0; j < unroll; ++j)
+            maxima[j] = Simd::zero();
+        std::size_t k = 0;
+        for (; k + Lanes<Real>::COUNT <= count; k += Lanes<Real>::COUNT)
+            for (std::size_t j = 0; j < unroll; ++j)
+            {
+                Register difference = Simd::abs(Simd::sub(Simd::load(x + k + j * width),
+                                                          Simd::load(y + k + j * width)));
+                maxima[j] = Simd::max(maxima[j], difference);
+                nans |= Simd::unordered(difference);
+            }
+        Real lanes[Lanes<Real>::COUNT];
+        for (std::size_t j = 0; j < unroll; ++j)
+            Simd::store(lanes + j * width, maxima[j]);
+        for (std::size_t j = 0; j < Lanes<Real>::COUNT; ++j)
+            result = max(result, lanes[j]);
+        if (nans)
+            result = std::numeric_limits<Real>::quiet_NaN();
+        return k;
+    }
+
+#pragma GCC diagnostic pop
+
+#endif //LIBUBLASAUX_SIMD_X86
+
+}; //class NormKernels
+
+
+#ifdef LIBUBLASAUX_SIMD_X86
+
+template<>
+struct NormKernels::Avx2_<double> {
+    typedef __m256d Register;
+    static const std::size_t WIDTH = 4;
+
+    __attribute__((target("avx2"))) inline static Register zero()
+    {
+        return _mm256_setzero_pd();
+    }
+
+    __attribute__((target("avx2"))) inline static Register load(const double* x)
+    {
+        return _mm256_loadu_pd(x);
+    }
+
+    __attribute__((target("avx2"))) inline static void store(double* x, Register value)
+    {
+        _mm256_storeu_pd(x, value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register add(Register a, Register b)
+    {
+        return _mm256_add_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm256_sub_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register mul(Register a, Register b)
+    {
+        return _mm256_mul_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register max(Register a, Register b)
+    {
+        return _mm256_max_pd(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register abs(Register a)
+    {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+    }
+
+    __attribute__((target("avx2"))) inline static Register orUnordered(Register mask, Register a)
+    {
+        return _mm256_or_pd(mask, _mm256_cmp_pd(a, a, _CMP_UNORD_Q));
+    }
+
+    __attribute__((target("avx2"))) inline static bool isAny(Register mask)
+    {
+        return _mm256_movemask_pd(mask) != 0;
+    }
+};
+
+template<>
+struct NormKernels::Avx2_<float> {
+    typedef __m256 Register;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx2"))) inline static Register zero()
+    {
+        return _mm256_setzero_ps();
+    }
+
+    __attribute__((target("avx2"))) inline static Register load(const float* x)
+    {
+        return _mm256_loadu_ps(x);
+    }
+
+    __attribute__((target("avx2"))) inline static void store(float* x, Register value)
+    {
+        _mm256_storeu_ps(x, value);
+    }
+
+    __attribute__((target("avx2"))) inline static Register add(Register a, Register b)
+    {
+        return _mm256_add_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register mul(Register a, Register b)
+    {
+        return _mm256_mul_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register max(Register a, Register b)
+    {
+        return _mm256_max_ps(a, b);
+    }
+
+    __attribute__((target("avx2"))) inline static Register abs(Register a)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+    }
+
+    __attribute__((target("avx2"))) inline static Register orUnordered(Register mask, Register a)
+    {
+        return _mm256_or_ps(mask, _mm256_cmp_ps(a, a, _CMP_UNORD_Q));
+    }
+
+    __attribute__((target("avx2"))) inline static bool isAny(Register mask)
+    {
+        return _mm256_movemask_ps(mask) != 0;
+    }
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template<>
+struct NormKernels::Avx512_<double> {
+    typedef __m512d Register;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx512f"))) inline static Register zero()
+    {
+        return _mm512_setzero_pd();
+    }
+
+    __attribute__((target("avx512f"))) inline static Register load(const double* x)
+    {
+        return _mm512_loadu_pd(x);
+    }
+
+    __attribute__((target("avx512f"))) inline static void store(double* x, Register value)
+    {
+        _mm512_storeu_pd(x, value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register add(Register a, Register b)
+    {
+        return _mm512_add_round_pd(a, b, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm512_sub_pd(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register mul(Register a, Register b)
+    {
+        return _mm512_mul_round_pd(a, b, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register max(Register a, Register b)
+    {
+        return _mm512_max_pd(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register abs(Register a)
+    {
+        return _mm512_abs_pd(a);
+    }
+
+    __attribute__((target("avx512f"))) inline static unsigned unordered(Register a)
+    {
+        return _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q);
+    }
+};
+
+template<>
+struct NormKernels::Avx512_<float> {
+    typedef __m512 Register;
+    static const std::size_t WIDTH = 16;
+
+    __attribute__((target("avx512f"))) inline static Register zero()
+    {
+        return _mm512_setzero_ps();
+    }
+
+    __attribute__((target("avx512f"))) inline static Register load(const float* x)
+    {
+        return _mm512_loadu_ps(x);
+    }
+
+    __attribute__((target("avx512f"))) inline static void store(float* x, Register value)
+    {
+        _mm512_storeu_ps(x, value);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register add(Register a, Register b)
+    {
+        return _mm512_add_round_ps(a, b, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register sub(Register a, Register b)
+    {
+        return _mm512_sub_ps(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register mul(Register a, Register b)
+    {
+        return _mm512_mul_round_ps(a, b, ROUNDING_);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register max(Register a, Register b)
+    {
+        return _mm512_max_ps(a, b);
+    }
+
+    __attribute__((target("avx512f"))) inline static Register abs(Register a)
+    {
+        return _mm512_abs_ps(a);
+    }
+
+    __attribute__((target("avx512f"))) inline static unsigned unordered(Register a)
+    {
+        return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q);
+    }
+};
+
+#pragma GCC diagnostic pop
+
+#endif //LIBUBLASAUX_SIMD_X86
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_NORMKERNELS_H__
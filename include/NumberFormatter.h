@@ -0,0 +1,289 @@
+#ifndef __LIBUBLASAUX_NUMBERFORMATTER_H__
+#define __LIBUBLASAUX_NUMBERFORMATTER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+#include <ios>
+#include <iterator>
+#include <locale>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Converts values to the same text as "stream << value" would output (without padding to the
+ * stream's width), taking flags, precision and locale of the stream once. Built-in integer and
+ * floating-point numbers are printed straight into a char buffer by "snprintf" with a format made
+ * from the stream's flags when both the stream's locale and the global C locale (which "snprintf"
+ * uses) format numbers as the "C" one does; other values and locales go through one reused string
+ * stream.
+ * @author Anton Liaukevich
+ * @brief Fast conversion of values to stream text.
+ * @tparam Char Character type of the stream
+ * @tparam CharTraits Character traits of the stream
+ */
+template<class Char, class CharTraits = std::char_traits<Char> >
+class NumberFormatter {
+public:
+    /* Types */
+
+    typedef std::basic_string<Char,CharTraits> String;
+    typedef std::streamsize StreamSize;
+
+    /* Construct/copy/destruct */
+
+    /**
+     * @param stream Stream whose formatting is imitated. Later changes of its formatting are not
+     * taken into account.
+     */
+    explicit NumberFormatter(const std::basic_ios<Char,CharTraits>& stream):
+        flags_(stream.flags()), precision_(stream.precision() < 0 ? 6 : stream.precision()),
+        ctype_(&std::use_facet< std::ctype<Char> >(stream.getloc())),
+        isFast_(isClassicNumeric_(stream.getloc()))
+    {
+        temp_.flags(stream.flags());
+        temp_.imbue(stream.getloc());
+        temp_.precision(stream.precision());
+    }
+
+    /* Real actions */
+
+    /**
+     * Appends text of a value to a string.
+     * @return Length of the text
+     */
+    template<class Value>
+    inline StreamSize append(String& text, const Value& value) const
+    {
+        return appendValue_(text, value);
+    }
+
+private:
+
+    /**
+     * Formats numbers by snprintf if the locale has standard numeric facets which neither group
+     * digits nor change the decimal point, and the global C locale keeps the decimal point too.
+     * @warning The global C locale is checked once; do not change it while the formatter is used.
+     */
+    static bool isClassicNumeric_(const std::locale& locale)
+    {
+        typedef std::num_put< Char, std::ostreambuf_iterator<Char,CharTraits> > NumPut;
+        const std::numpunct<Char>& punct = std::use_facet< std::numpunct<Char> >(locale);
+        return std::strcmp(std::localeconv()->decimal_point, ".") == 0 &&
+               typeid(std::use_facet<NumPut>(locale)) == typeid(NumPut) &&
+               typeid(punct) == typeid(std::numpunct<Char>) &&
+               punct.grouping().empty() &&
+               punct.decimal_point() == std::use_facet< std::ctype<Char> >(locale).widen('.');
+    }
+
+    /*
+     * Fallback: string stream
+     */
+
+    template<class Value>
+    StreamSize appendValue_(String& text, const Value& value) const
+    {
+        temp_.str(String());
+        temp_ << value;
+        String current = temp_.str();
+        text += current;
+        return current.size();
+    }
+
+    /*
+     * Built-in numbers
+     */
+
+    inline StreamSize appendValue_(String& text, short value) const
+    {
+        return appendSigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, int value) const
+    {
+        return appendSigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, long value) const
+    {
+        return appendSigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, boost::long_long_type value) const
+    {
+        return appendSigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, unsigned short value) const
+    {
+        return appendUnsigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, unsigned value) const
+    {
+        return appendUnsigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, unsigned long value) const
+    {
+        return appendUnsigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, boost::ulong_long_type value) const
+    {
+        return appendUnsigned_(text, value);
+    }
+
+    inline StreamSize appendValue_(String& text, float value) const
+    {
+        // Streams print "float" as "double"
+        return appendValue_(text, static_cast<double>(value));
+    }
+
+    StreamSize appendValue_(String& text, double value) const
+    {
+        if (!isFast_)
+            return appendValue_<double>(text, value);
+        char format[16];
+        makeFloatFormat_(format, "");
+        return appendChars_(text, format, value);
+    }
+
+    StreamSize appendValue_(String& text, long double value) const
+    {
+        if (!isFast_)
+            return appendValue_<long double>(text, value);
+        char format[16];
+        makeFloatFormat_(format, "L");
+        return appendChars_(text, format, value);
+    }
+
+    template<class Value>
+    StreamSize appendSigned_(String& text, Value value) const
+    {
+        if (!isFast_)
+            return appendValue_<Value>(text, value);
+        if ((flags_ & std::ios_base::basefield) == std::ios_base::oct ||
+            (flags_ & std::ios_base::basefield) == std::ios_base::hex)
+            // Streams print signed numbers in these bases as unsigned ones of the same size
+            return appendUnsigned_(text, static_cast<boost::ulong_long_type>(value) &
+                                         (~boost::ulong_long_type() >> (64 - 8 * sizeof(Value))));
+        return appendChars_(text, (flags_ & std::ios_base::showpos) ? "%+lld" : "%lld",
+                            static_cast<boost::long_long_type>(value));
+    }
+
+    template<class Value>
+    StreamSize appendUnsigned_(String& text, Value value) const
+    {
+        if (!isFast_)
+            return appendValue_<Value>(text, value);
+        const char* format;
+        bool isShowBase = flags_ & std::ios_base::showbase;
+        if ((flags_ & std::ios_base::basefield) == std::ios_base::oct)
+            format = isShowBase ? "%#llo" : "%llo";
+        else if ((flags_ & std::ios_base::basefield) == std::ios_base::hex)
+        {
+            if (flags_ & std::ios_base::uppercase)
+                format = isShowBase ? "%#llX" : "%llX";
+            else
+                format = isShowBase ? "%#llx" : "%llx";
+        }
+        else
+            format = "%llu";
+        return appendChars_(text, format, static_cast<boost::ulong_long_type>(value));
+    }
+
+    /**
+     * Makes printf format of a floating-point number as standard "num_put" facet does.
+     */
+    void makeFloatFormat_(char* format, const char* lengthModifier) const
+    {
+        std::ios_base::fmtflags floatField = flags_ & std::ios_base::floatfield;
+        *format++ = '%';
+        if (flags_ & std::ios_base::showpos)
+            *format++ = '+';
+        if (flags_ & std::ios_base::showpoint)
+            *format++ = '#';
+        bool isHex = floatField == (std::ios_base::fixed | std::ios_base::scientific);
+        if (!isHex)
+        {
+            *format++ = '.';
+            *format++ = '*';
+        }
+        while (*lengthModifier)
+            *format++ = *lengthModifier++;
+
+        char conversion;
+        if (floatField == std::ios_base::fixed)
+            conversion = 'f';
+        else if (floatField == std::ios_base::scientific)
+            conversion = 'e';
+        else if (isHex)
+            conversion = 'a';
+        else
+            conversion = 'g';
+        if (flags_ & std::ios_base::uppercase)
+            conversion = std::toupper(conversion, std::locale::classic());
+        *format++ = conversion;
+        *format = '\0';
+    }
+
+    template<class Value>
+    StreamSize appendChars_(String& text, const char* format, Value value) const
+    {
+        char buffer[BUFFER_SIZE_];
+        int length;
+        if (std::strchr(format, '*'))
+            length = snprintf(buffer, BUFFER_SIZE_, format, static_cast<int>(precision_), value);
+        else
+            length = snprintf(buffer, BUFFER_SIZE_, format, value);
+        if (length < 0 || length >= BUFFER_SIZE_)
+            return appendValue_<Value>(text, value); // huge fixed-point numbers
+
+        std::size_t oldSize = text.size();
+        text.resize(oldSize + length);
+        ctype_->widen(buffer, buffer + length, &text[oldSize]);
+        return length;
+    }
+
+    /* Constants */
+
+    static const int BUFFER_SIZE_ = 128;
+
+    /* Fields */
+
+    std::ios_base::fmtflags flags_;
+    StreamSize precision_;
+    const std::ctype<Char>* ctype_;
+    bool isFast_;
+    mutable std::basic_ostringstream< Char, CharTraits, std::allocator<Char> > temp_;
+
+}; //template class NumberFormatter
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_NUMBERFORMATTER_H__
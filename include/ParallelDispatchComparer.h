@@ -0,0 +1,263 @@
+#ifndef __LIBUBLASAUX_PARALLELDISPATCHCOMPARER_H__
+#define __LIBUBLASAUX_PARALLELDISPATCHCOMPARER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "normers.h"
+#include "ParallelRunner.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <boost/type_traits/integral_constant.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * "DispatchComparer" strategy that accumulates norms of differences of big dense vectors and
+ * matrices by several threads. Their storage is split into chunks of CHUNK_ITEMS elements, every
+ * chunk is accumulated by its own accumulator, and accumulators of every ROUND_CHUNKS successive
+ * chunks are merged pairwise (as leaves of a binary tree) before being added to the result. Partition
+ * and order of additions depend only on sizes of the containers therefore result is bit-identical
+ * whatever number of threads is used (@see ParallelRunner#setThreadCount). Early exit
+ * (@see RoughlyVectorComparer#compare) happens after a round of ROUND_CHUNKS chunks, and the norm is
+ * checked after exactly the same additions, so "compare" agrees with "getDistance". All other
+ * container types are delegated to StdDispatchComparer. This class implements "Monostate" pattern
+ * (only static methods).
+ * @author Anton Liaukevich
+ * @brief Multi-threaded "DispatchComparer" strategy with reproducible reductions.
+ * @warning For containers longer than CHUNK_ITEMS elements last bits of norm_1 and norm_2 may differ
+ * from the ones StdDispatchComparer gives.
+ */
+class ParallelDispatchComparer {
+private:
+    /* Types */
+
+    typedef StdDispatchComparer Sequential;
+
+public:
+    /* Constants */
+
+    /**
+     * Number of elements accumulated by one task.
+     */
+    static const std::size_t CHUNK_ITEMS = 1 << 16;
+
+    /**
+     * Number of chunks whose accumulators are merged pairwise.
+     */
+    static const std::size_t ROUND_CHUNKS = 64;
+
+    /* Real actions */
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer (@see StdDispatchComparer#accumulate).
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static void accumulate(Accumulator& accumulator, const vector_expression<E1>& vector1,
+                                  const vector_expression<E2>& vector2)
+    {
+        BOOST_UBLAS_CHECK(vector1().size() == vector2().size(), bad_size());
+        typename Sequential::VectorCursor_<Accumulator,E1,E2>::Answer cursor(vector1(), vector2());
+        run_(accumulator, cursor, false, typename Accumulator::Real());
+    }
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer (@see StdDispatchComparer#accumulate).
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static void accumulate(Accumulator& accumulator, const matrix_expression<E1>& matrix1,
+                                  const matrix_expression<E2>& matrix2)
+    {
+        BOOST_UBLAS_CHECK(matrix1().size1() == matrix2().size1(), bad_size());
+        BOOST_UBLAS_CHECK(matrix1().size2() == matrix2().size2(), bad_size());
+        typename Sequential::MatrixCursor_<Accumulator,E1,E2>::Answer cursor(matrix1(), matrix2());
+        run_(accumulator, cursor, false, typename Accumulator::Real());
+    }
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer
+     * (@see StdDispatchComparer#findExcess).
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static std::size_t findExcess(Accumulator& accumulator,
+                                         const vector_expression<E1>& vector1,
+                                         const vector_expression<E2>& vector2,
+                                         typename Accumulator::Real maxDiff)
+    {
+        BOOST_UBLAS_CHECK(vector1().size() == vector2().size(), bad_size());
+        typename Sequential::VectorCursor_<Accumulator,E1,E2>::Answer cursor(vector1(), vector2());
+        return run_(accumulator, cursor, true, maxDiff);
+    }
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer
+     * (@see StdDispatchComparer#findExcess).
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static std::pair<std::size_t,std::size_t>
+    findExcess(Accumulator& accumulator, const matrix_expression<E1>& matrix1,
+               const matrix_expression<E2>& matrix2, typename Accumulator::Real maxDiff)
+    {
+        BOOST_UBLAS_CHECK(matrix1().size1() == matrix2().size1(), bad_size());
+        BOOST_UBLAS_CHECK(matrix1().size2() == matrix2().size2(), bad_size());
+        typename Sequential::MatrixCursor_<Accumulator,E1,E2>::Answer cursor(matrix1(), matrix2());
+        return run_(accumulator, cursor, true, maxDiff);
+    }
+
+private:
+
+    /**
+     * Accumulates the whole difference or (if "isLimited") stops at the first element at which the
+     * norm exceeds "maxDiff" (@see StdDispatchComparer#findExcess).
+     */
+    template<class Accumulator, class Cursor>
+    inline static typename Cursor::Position run_(Accumulator& accumulator, Cursor& cursor,
+                                                 bool isLimited, typename Accumulator::Real maxDiff)
+    {
+        return run_(accumulator, cursor, isLimited, maxDiff,
+                    integral_constant<bool, Cursor::IS_SEEKABLE>());
+    }
+
+    /**
+     * Containers without contiguous storage are compared sequentially.
+     */
+    template<class Accumulator, class Cursor>
+    static typename Cursor::Position run_(Accumulator& accumulator, Cursor& cursor, bool isLimited,
+                                          typename Accumulator::Real maxDiff, false_type)
+    {
+        if (isLimited)
+            return Sequential::findExcess_(accumulator, cursor, maxDiff);
+        cursor.accumulate(accumulator, std::numeric_limits<std::size_t>::max());
+        return cursor.getEnd();
+    }
+
+    template<class Accumulator, class Cursor>
+    static typename Cursor::Position run_(Accumulator& accumulator, Cursor& cursor, bool isLimited,
+                                          typename Accumulator::Real maxDiff, true_type)
+    {
+        std::size_t chunkCount = (cursor.getCount() + CHUNK_ITEMS - 1) / CHUNK_ITEMS;
+        // Without limit all chunks are accumulated by one team of threads
+        std::size_t taskChunks = isLimited ? ROUND_CHUNKS : chunkCount;
+        std::vector<Accumulator> results;
+        for (std::size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += taskChunks)
+        {
+            std::size_t count = std::min(taskChunks, chunkCount - firstChunk);
+            results.assign(count, Accumulator());
+            ParallelRunner::run(Chunks_<Accumulator,Cursor>(cursor, firstChunk, count, &results[0]),
+                                count);
+
+            for (std::size_t round = 0; round < count; round += ROUND_CHUNKS)
+            {
+                std::size_t roundSize = std::min(count - round, std::size_t(ROUND_CHUNKS));
+                Accumulator roundStart(accumulator);
+                accumulator.merge(mergePairwise_(&results[round], roundSize));
+                if (isLimited && !accumulator.isWithin(maxDiff))
+                {
+                    accumulator = roundStart;
+                    return findInRound_(accumulator, cursor, firstChunk + round, &results[round],
+                                        maxDiff);
+                }
+            }
+        }
+        return cursor.getEnd();
+    }
+
+    /**
+     * Merges accumulators of successive chunks as a binary tree.
+     */
+    template<class Accumulator>
+    static Accumulator mergePairwise_(const Accumulator* results, std::size_t count)
+    {
+        if (count == 1)
+            return results[0];
+        std::size_t half = (count + 1) / 2;
+        Accumulator result(mergePairwise_(results, half));
+        result.merge(mergePairwise_(results + half, count - half));
+        return result;
+    }
+
+    /**
+     * Finds the element of a round at which the norm exceeds "maxDiff": adds chunks one by one up to
+     * the first one exceeding it and replays that chunk element by element. If the norm of the
+     * round (merged pairwise) exceeds "maxDiff" only because of rounding, it is the last element of
+     * the round.
+     * @param results Accumulators of chunks of the round before merging them
+     */
+    template<class Accumulator, class Cursor>
+    static typename Cursor::Position findInRound_(Accumulator& accumulator, Cursor& cursor,
+                                                  std::size_t firstChunk, Accumulator* results,
+                                                  typename Accumulator::Real maxDiff)
+    {
+        std::size_t roundEnd = std::min((firstChunk + ROUND_CHUNKS) * CHUNK_ITEMS, cursor.getCount());
+        for (std::size_t chunk = firstChunk; ; ++chunk)
+        {
+            Accumulator chunkStart(accumulator);
+            accumulator.merge(results[chunk - firstChunk]);
+            std::size_t chunkEnd = std::min((chunk + 1) * CHUNK_ITEMS, cursor.getCount());
+            if (accumulator.isWithin(maxDiff) && chunkEnd < roundEnd)
+                continue;
+
+            accumulator = chunkStart;
+            cursor.seek(chunk * CHUNK_ITEMS);
+            for (std::size_t number = chunk * CHUNK_ITEMS; ; ++number)
+            {
+                typename Cursor::Position position = cursor.accumulate(accumulator, 1);
+                if (!accumulator.isWithin(maxDiff) || number + 1 == chunkEnd)
+                    return position;
+            }
+        }
+    }
+
+    /*
+     * Chunk task executed by ParallelRunner
+     */
+
+    template<class Accumulator, class Cursor>
+    class Chunks_ {
+    public:
+
+        inline Chunks_(const Cursor& cursor, std::size_t firstChunk, std::size_t count,
+                       Accumulator* results):
+            cursor_(cursor), firstChunk_(firstChunk), count_(count), results_(results) {}
+
+        void operator()(unsigned worker, unsigned workerCount) const
+        {
+            for (std::size_t chunk = worker; chunk < count_; chunk += workerCount)
+            {
+                Cursor chunkCursor(cursor_);
+                chunkCursor.seek((firstChunk_ + chunk) * CHUNK_ITEMS);
+                chunkCursor.accumulate(results_[chunk], CHUNK_ITEMS);
+            }
+        }
+
+    private:
+        Cursor cursor_;
+        std::size_t firstChunk_,
+                    count_;
+        Accumulator* results_;
+    };
+
+}; //class ParallelDispatchComparer
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_PARALLELDISPATCHCOMPARER_H__
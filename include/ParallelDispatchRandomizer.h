@@ -0,0 +1,357 @@
+#ifndef __LIBUBLASAUX_PARALLELDISPATCHRANDOMIZER_H__
+#define __LIBUBLASAUX_PARALLELDISPATCHRANDOMIZER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StdDispatchRandomizer.h"
+#include "ParallelRunner.h"
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * "DispatchRandomizer" strategy that fills dense vectors and matrices by several threads. A container
+ * is split into blocks of about BLOCK_ITEMS elements (blocks of rows for row-major matrices, blocks of
+ * columns for column-major ones). Every block is generated by its own engine seeded from one number
+ * drawn from user's engine and from the block number. Partition into blocks depends only on sizes of
+ * the container therefore result is bit-identical for a given seed whatever number of threads is
+ * used (@see ParallelRunner#setThreadCount). All other container types are delegated to
+ * StdDispatchRandomizer. Counter-based engines (@see PhiloxEngine) need no substreams: every block
+ * works with a copy of user's engine positioned at each element, and the result is the same as the
+ * one of StdDispatchRandomizer. This template implements "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Multi-threaded "DispatchRandomizer" strategy with reproducible per-block substreams.
+ * @remark Template parameters are taken from wrapper @see RandomGenerator.
+ * @remark "Engine" must be constructible from a seed value of type "Engine::result_type" (all engines
+ * of Boost.Random are).
+ * @warning For sequential engines result differs from the one of StdDispatchRandomizer for the same
+ * seed.
+ */
+template<
+         class Engine_,
+         class ItemDistribution_,
+         class IndexDistributionCreator_
+        >
+class ParallelDispatchRandomizer {
+private:
+    /* Types */
+
+    typedef Engine_ Engine;
+    typedef ItemDistribution_ ItemDist;
+    typedef IndexDistributionCreator_ IndexDistCreator;
+    typedef typename Engine::result_type Seed;
+
+    typedef boost::variate_generator<Engine&, ItemDist> ItemDie;
+    typedef CounterEngineTraits<Engine> EngineTraits;
+    typedef StdDispatchRandomizer<Engine,ItemDist,IndexDistCreator> Sequential;
+
+    typedef BatchGenerator<ItemDist> ItemBatch;
+    static const bool IS_BATCHED = ItemBatch::IS_BATCHED && !EngineTraits::IS_COUNTER_BASED;
+
+    /**
+     * Dispatchering class. Containers other than dense ones whose storage lines are contiguous
+     * (@see ContainerTraits) are randomized sequentially by StdDispatchRandomizer.
+     */
+    template<
+             class Container,
+             class Traits = ContainerTraits<Container>,
+             class Shape = typename ContainerTraits<Container>::Shape
+            >
+    struct Dispatch_ {
+
+        inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
+        {
+            Sequential::randomize(container, engine, itemDist);
+        }
+    };
+
+public:
+    /* Constants */
+
+    /**
+     * Approximate number of elements generated by one substream.
+     */
+    static const std::size_t BLOCK_ITEMS = 1 << 16;
+
+    /**
+     * Dispatching function callable from RandomGenerator (@see RandomGenerator#operator()).
+     * It dispatches randomizing with nested (private) "Dispatch_" class (@see Dispatch_).
+     */
+    template<class Container>
+    inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
+    {
+        Dispatch_<Container>::randomize(container, engine, itemDist);
+    }
+
+    /**
+     * Sparse matrices with sparsity patterns are randomized sequentially by StdDispatchRandomizer.
+     */
+    template<class Container, class Pattern>
+    inline static void randomize(Container& container, const Pattern& pattern, Engine& engine,
+                                 const ItemDist& itemDist)
+    {
+        Sequential::randomize(container, pattern, engine, itemDist);
+    }
+
+    /**
+     * Matrices are streamed sequentially by StdDispatchRandomizer.
+     */
+    template<class Matrix, class TileSink>
+    inline static void stream(const MatrixShape<Matrix>& shape, std::size_t tileSize1,
+                              std::size_t tileSize2, TileSink& sink, Engine& engine,
+                              const ItemDist& itemDist)
+    {
+        Sequential::stream(shape, tileSize1, tileSize2, sink, engine, itemDist);
+    }
+
+protected:
+    /**
+     * Protected destructor
+     * @remark Is necessary in order to prevent deletion of object of parent class (RandomGenerator)
+     * as an object of descendant class (ParallelDispatchRandomizer).
+     */
+    ~ParallelDispatchRandomizer() {}
+
+private:
+
+    /**
+     * Makes seed of a block substream from base seed & block number ("splitmix64" finalizer).
+     */
+    inline static Seed substreamSeed_(boost::uint64_t base, boost::uint64_t block)
+    {
+        boost::uint64_t z = base + (block + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<Seed>(z ^ (z >> 31));
+    }
+
+    /**
+     * Draws base seed of substreams from user's engine. Counter-based engines are not touched.
+     */
+    inline static boost::uint64_t drawBase_(Engine& engine)
+    {
+        return EngineTraits::IS_COUNTER_BASED ? 0 : engine();
+    }
+
+    /**
+     * Makes engine of a block substream.
+     */
+    inline static Engine makeBlockEngine_(const Engine& engine, boost::uint64_t base, std::size_t block)
+    {
+        return EngineTraits::IS_COUNTER_BASED ? engine : Engine(substreamSeed_(base, block));
+    }
+
+    /**
+     * Fills "count" elements placed with a constant stride from "first" to "last" (inclusive) by
+     * blocks (@see BatchGenerator).
+     */
+    template<class Item>
+    inline static void fillBatched_(ItemDie& die, Item* first, Item* last, std::size_t count)
+    {
+        std::ptrdiff_t stride = count > 1 ? (last - first) / std::ptrdiff_t(count - 1) : 0;
+        BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), first, stride, count);
+    }
+
+    /*
+     * Block tasks executed by ParallelRunner
+     */
+
+    template<class Vector>
+    class VectorBlocks_ {
+    public:
+        typedef typename Vector::size_type Size;
+
+        inline VectorBlocks_(Vector& vect, Engine& engine, const ItemDist& itemDist):
+            vect_(&vect), engine_(engine), itemDist_(itemDist), base_(drawBase_(engine)) {}
+
+        inline std::size_t getBlockCount() const
+        {
+            return (vect_->size() + BLOCK_ITEMS - 1) / BLOCK_ITEMS;
+        }
+
+        void operator()(unsigned worker, unsigned workerCount) const
+        {
+            for (std::size_t block = worker; block < getBlockCount(); block += workerCount)
+            {
+                Engine blockEngine(makeBlockEngine_(engine_, base_, block));
+                ItemDie die(blockEngine, itemDist_);
+
+                Size first = block * BLOCK_ITEMS,
+                     last  = (std::min)(vect_->size(), Size(first + BLOCK_ITEMS));
+                if (IS_BATCHED)
+                {
+                    fillBatched_(die, &(*vect_)(first), &(*vect_)(last - 1), last - first);
+                    continue;
+                }
+                for (Size i = first; i < last; ++i)
+                {
+                    EngineTraits::seek(die, i, 0);
+                    (*vect_)(i) = die();
+                }
+            }
+        }
+
+    private:
+        Vector* vect_;
+        Engine engine_;
+        ItemDist itemDist_;
+        boost::uint64_t base_;
+    };
+
+    template<class Matrix>
+    class MatrixBlocks_ {
+    public:
+        typedef typename Matrix::size_type Size;
+
+        inline MatrixBlocks_(Matrix& matr, Engine& engine, const ItemDist& itemDist):
+            matr_(&matr), engine_(engine), itemDist_(itemDist), base_(drawBase_(engine))
+        {
+            majorSize_ = IS_COLUMN_MAJOR ? matr.size2() : matr.size1();
+            minorSize_ = IS_COLUMN_MAJOR ? matr.size1() : matr.size2();
+            linesPerBlock_ = (std::max)(Size(1), Size(BLOCK_ITEMS / (std::max)(minorSize_, Size(1))));
+        }
+
+        inline std::size_t getBlockCount() const
+        {
+            return (majorSize_ + linesPerBlock_ - 1) / linesPerBlock_;
+        }
+
+        void operator()(unsigned worker, unsigned workerCount) const
+        {
+            for (std::size_t block = worker; block < getBlockCount(); block += workerCount)
+            {
+                Engine blockEngine(makeBlockEngine_(engine_, base_, block));
+                ItemDie die(blockEngine, itemDist_);
+
+                Size first = block * linesPerBlock_,
+                     last  = (std::min)(majorSize_, Size(first + linesPerBlock_));
+                if (IS_BATCHED)
+                {
+                    if (minorSize_ > Size())
+                        for (Size line = first; line < last; ++line)
+                            fillBatched_(die, &element_(line, Size()),
+                                         &element_(line, minorSize_ - 1), minorSize_);
+                    continue;
+                }
+                if (IS_COLUMN_MAJOR)
+                    for (Size j = first; j < last; ++j)
+                        for (Size i = Size(); i < minorSize_; ++i)
+                        {
+                            EngineTraits::seek(die, i, j);
+                            (*matr_)(i, j) = die();
+                        }
+                else
+                    for (Size i = first; i < last; ++i)
+                        for (Size j = Size(); j < minorSize_; ++j)
+                        {
+                            EngineTraits::seek(die, i, j);
+                            (*matr_)(i, j) = die();
+                        }
+            }
+        }
+
+    private:
+        static const bool IS_COLUMN_MAJOR =
+            boost::is_same<typename ContainerTraits<Matrix>::OrientationCategory,
+                           column_major_tag>::value;
+
+        /**
+         * Element number "minor" of line number "major" of the storage.
+         */
+        inline typename Matrix::value_type& element_(Size major, Size minor) const
+        {
+            return IS_COLUMN_MAJOR ? (*matr_)(minor, major) : (*matr_)(major, minor);
+        }
+
+        Matrix* matr_;
+        Engine engine_;
+        ItemDist itemDist_;
+        boost::uint64_t base_;
+        Size majorSize_,
+             minorSize_,
+             linesPerBlock_;
+    };
+
+    /*
+     * Randomize implementation class (backend)
+     */
+
+    struct BlockRandomizer_ {
+
+        template<class Vector>
+        static void randomizeVector(Vector& vect, Engine& engine, const ItemDist& itemDist)
+        {
+            VectorBlocks_<Vector> blocks(vect, engine, itemDist);
+            ParallelRunner::run(blocks, blocks.getBlockCount());
+        }
+
+        template<class Matrix>
+        static void randomizeMatrix(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        {
+            MatrixBlocks_<Matrix> blocks(matr, engine, itemDist);
+            ParallelRunner::run(blocks, blocks.getBlockCount());
+        }
+    };
+
+    /*
+     * Partial specialization for dense containers
+     */
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,DenseShape> {
+
+        inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
+        {
+            randomize_(container, engine, itemDist, integral_constant<bool, Traits::IS_VECTOR>(),
+                       integral_constant<bool, IS_BLOCKED_>());
+        }
+
+    private:
+        static const bool IS_BLOCKED_ = Traits::IS_VECTOR ? Traits::IS_CONTIGUOUS :
+                                                            Traits::IS_LINE_CONTIGUOUS;
+
+        template<class IsVector>
+        inline static void randomize_(Container& container, Engine& engine, const ItemDist& itemDist,
+                                      IsVector, false_type)
+        {
+            Sequential::randomize(container, engine, itemDist);
+        }
+
+        inline static void randomize_(Container& vect, Engine& engine, const ItemDist& itemDist,
+                                      true_type, true_type)
+        {
+            BlockRandomizer_::randomizeVector(vect, engine, itemDist);
+        }
+
+        inline static void randomize_(Container& matr, Engine& engine, const ItemDist& itemDist,
+                                      false_type, true_type)
+        {
+            BlockRandomizer_::randomizeMatrix(matr, engine, itemDist);
+        }
+    };
+
+}; //template class ParallelDispatchRandomizer
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_PARALLELDISPATCHRANDOMIZER_H__
@@ -0,0 +1,372 @@
+#ifndef __LIBUBLASAUX_PARALLELMATRIXNICEOUTPUTER_H__
+#define __LIBUBLASAUX_PARALLELMATRIXNICEOUTPUTER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MatrixNiceOutputer.h"
+#include "ParallelRunner.h"
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * MatrixNiceOutputer formatting large matrices by several threads. Rows are split into blocks of
+ * about BLOCK_ITEMS elements. Widths of columns are found by all threads (every one measures its
+ * blocks, then maximal widths are taken), then threads take blocks one by one and format them into
+ * a ring of two blocks per thread, while the calling thread writes formatted blocks to the stream
+ * in the order of rows and formats blocks itself only when none is ready to be written. So writing
+ * overlaps formatting, text is the same byte for byte as the one of MatrixNiceOutputer whatever
+ * number of threads is used (@see ParallelRunner#setThreadCount), and no more than two blocks per
+ * thread are kept in memory. One team of threads does all the work of a call. Matrices of one
+ * block and COORDINATE_LIST and COMPACT_ROWS placings are outputed by MatrixNiceOutputer on the
+ * calling thread. If writing or formatting throws, the other threads stop and the exception is
+ * rethrown by the calling thread after all of them have finished.
+ * @author Anton Liaukevich
+ * @brief Multi-threaded functor for nice matrix output.
+ * @remark Elements are read by several threads at once, so a matrix must not be changed during
+ * output. Justifying placings format every element twice (to measure and to output it).
+ * @remark Requires linking with Boost.Thread library.
+ */
+class ParallelMatrixNiceOutputer: public MatrixNiceOutputer {
+public:
+    /* Constants */
+
+    /**
+     * Approximate number of elements formatted by a thread at once.
+     */
+    static const std::size_t BLOCK_ITEMS = 1 << 16;
+
+    /* Construct/copy/destruct */
+
+    /**
+     * Creates a new functor for multi-threaded matrix outputing (@see MatrixNiceOutputer).
+     */
+    inline explicit ParallelMatrixNiceOutputer(ElementPlacing placing, StreamSize minSpaces = 1,
+                                               bool isLineFeedAfterAll = true):
+        MatrixNiceOutputer(placing, minSpaces, isLineFeedAfterAll) {}
+
+    /* Real actions */
+
+    /**
+     * Outputs a matrix to the stream in a nice look (@see MatrixNiceOutputer#operator()).
+     */
+    template<class Char, class CharTraits, class Matrix>
+    inline void operator()(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix) const
+    {
+        NiceOutputBuffers<Char,CharTraits> buffers;
+        (*this)(output, matrix, buffers);
+    }
+
+    /**
+     * Outputs a matrix to the stream in a nice look using memory of given buffers for the work of the
+     * calling thread. Other threads and formatted blocks have their own buffers for every call.
+     */
+    template<class Char, class CharTraits, class Matrix>
+    void operator()(std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                    NiceOutputBuffers<Char,CharTraits>& buffers) const
+    {
+        std::size_t rowsPerBlock = (std::max)(std::size_t(1),
+                                              BLOCK_ITEMS / (std::max)(std::size_t(matrix.size2()),
+                                                                       std::size_t(1))),
+                    blockCount = (matrix.size1() + rowsPerBlock - 1) / rowsPerBlock;
+        if (blockCount <= 1 || ParallelRunner::getThreadCount() <= 1 ||
+            getPlacing() == COORDINATE_LIST || getPlacing() == COMPACT_ROWS)
+        {
+            MatrixNiceOutputer::operator()(output, matrix, buffers);
+            return;
+        }
+
+        Instrumentation::Probe probe(Instrumentation::OUTPUTER, Instrumentation::KindOf<Matrix>::value);
+        InstrumentedByteCounter<Char,CharTraits> byteCounter(output, probe);
+
+        std::basic_string<Char,CharTraits>& chunk = buffers.chunk_;
+        startOutput(output, chunk, matrix);
+        flushChunk(output, chunk, true);
+
+        /* Worker 0 is the calling thread, it works with user's buffers */
+        typedef NiceOutputBuffers<Char,CharTraits> Buffers;
+        std::size_t workerCount = (std::min)(std::size_t(ParallelRunner::getThreadCount()), blockCount);
+        std::vector<Buffers> ownBuffers(workerCount - 1);
+        std::vector<Buffers*> workerBuffers(1, &buffers);
+        for (std::size_t worker = 1; worker < workerCount; ++worker)
+            workerBuffers.push_back(&ownBuffers[worker - 1]);
+
+        ColumnWidths_ columnWidths;
+        boost::barrier barrier(static_cast<unsigned>(workerCount));
+        Pipeline_<Char,CharTraits> pipeline(2 * workerCount);
+        Blocks_<Char,CharTraits,Matrix> blocks(*this, output, matrix, rowsPerBlock, blockCount,
+                                               workerBuffers, columnWidths, barrier, pipeline);
+        ParallelRunner::run(blocks, blockCount);
+
+        chunk.clear();
+        finishOutput(output, chunk);
+    }
+
+private:
+    /* Types */
+
+    /**
+     * Formatted blocks waiting to be written: text of block "b" is kept in slot "b % slots.size()"
+     * from the moment it is taken by a worker until it is written. "isAborted" is set when a worker
+     * fails, "failure" keeps the first exception thrown.
+     */
+    template<class Char, class CharTraits>
+    struct Pipeline_ {
+        inline explicit Pipeline_(std::size_t slotCount):
+            slots(slotCount), isReady(slotCount, false), nextBlock(0), writtenCount(0), isAborted(false) {}
+
+        boost::mutex mutex;
+        boost::condition_variable changed;
+        std::vector< std::basic_string<Char,CharTraits> > slots;
+        std::vector<bool> isReady;
+        std::size_t nextBlock,
+                    writtenCount;
+        bool isAborted;
+        boost::exception_ptr failure;
+    };
+
+    /**
+     * Block task executed by ParallelRunner. Unless placing is SIMPLE, worker number "w" widens
+     * "widths_" of its buffers by blocks w, w + workerCount, ... and worker 0 takes the maximal
+     * widths when all workers are done. Then workers format blocks taken in the order of rows to
+     * the slots of the pipeline; worker 0 writes them to the stream in the same order. A failed
+     * worker aborts the pipeline (still passing the barriers), others stop and worker 0 rethrows the
+     * first exception.
+     */
+    template<class Char, class CharTraits, class Matrix>
+    class Blocks_ {
+    public:
+        typedef NiceOutputBuffers<Char,CharTraits> Buffers;
+
+        inline Blocks_(const ParallelMatrixNiceOutputer& outputer,
+                       std::basic_ostream<Char,CharTraits>& output, const Matrix& matrix,
+                       std::size_t rowsPerBlock, std::size_t blockCount,
+                       const std::vector<Buffers*>& buffers, ColumnWidths_& columnWidths,
+                       boost::barrier& barrier, Pipeline_<Char,CharTraits>& pipeline):
+            outputer_(&outputer), output_(&output), matrix_(&matrix), rowsPerBlock_(rowsPerBlock),
+            blockCount_(blockCount), buffers_(&buffers), columnWidths_(&columnWidths),
+            barrier_(&barrier), pipeline_(&pipeline) {}
+
+        void operator()(unsigned worker, unsigned workerCount) const
+        {
+            Buffers& buffers = *(*buffers_)[worker];
+            FormattedRows_<Char,CharTraits> rows(*output_, buffers);
+            if (outputer_->getPlacing() != SIMPLE)
+            {
+                try
+                {
+                    measure_(rows, buffers, worker, workerCount);
+                }
+                catch (...)
+                {
+                    abort_();
+                }
+                barrier_->wait();
+                if (worker == 0 && !isAborted_())
+                {
+                    try
+                    {
+                        mergeWidths_(workerCount);
+                    }
+                    catch (...)
+                    {
+                        abort_();
+                    }
+                }
+                barrier_->wait();
+            }
+
+            try
+            {
+                formatAndWrite_(rows, worker);
+            }
+            catch (...)
+            {
+                abort_();
+            }
+            if (worker == 0 && pipeline_->failure)
+                boost::rethrow_exception(pipeline_->failure);
+        }
+
+    private:
+
+        /**
+         * Widens "widths_" of worker's buffers by its blocks.
+         */
+        void measure_(FormattedRows_<Char,CharTraits>& rows, Buffers& buffers, unsigned worker,
+                      unsigned workerCount) const
+        {
+            buffers.widths_.assign(matrix_->size2(), 0);
+            for (std::size_t block = worker; block < blockCount_; block += workerCount)
+            {
+                format_(rows, block);
+                rows.updateWidths(buffers.widths_);
+            }
+        }
+
+        /**
+         * Takes blocks to format them and (by worker 0) writes formatted ones until all blocks are
+         * done or the pipeline is aborted.
+         */
+        void formatAndWrite_(FormattedRows_<Char,CharTraits>& rows, unsigned worker) const
+        {
+            Pipeline_<Char,CharTraits>& pipeline = *pipeline_;
+            std::size_t slotCount = pipeline.slots.size();
+            boost::unique_lock<boost::mutex> lock(pipeline.mutex);
+            for (;;)
+            {
+                std::size_t written = pipeline.writtenCount,
+                            next = pipeline.nextBlock;
+                if (pipeline.isAborted)
+                    return;
+                if (worker == 0 && written < blockCount_ && pipeline.isReady[written % slotCount])
+                {
+                    lock.unlock();
+                    flushChunk(*output_, pipeline.slots[written % slotCount], true);
+                    lock.lock();
+                    pipeline.isReady[written % slotCount] = false;
+                    ++pipeline.writtenCount;
+                    pipeline.changed.notify_all();
+                }
+                else if (next < blockCount_ && next < written + slotCount)
+                {
+                    ++pipeline.nextBlock;
+                    lock.unlock();
+                    appendBlock_(pipeline.slots[next % slotCount], rows, next);
+                    lock.lock();
+                    pipeline.isReady[next % slotCount] = true;
+                    pipeline.changed.notify_all();
+                }
+                else if (worker == 0 ? written == blockCount_ : next == blockCount_)
+                    return;
+                else
+                    pipeline.changed.wait(lock);
+            }
+        }
+
+        /**
+         * Makes other workers stop, keeping the exception being handled if it is the first one.
+         */
+        void abort_() const
+        {
+            Pipeline_<Char,CharTraits>& pipeline = *pipeline_;
+            boost::lock_guard<boost::mutex> lock(pipeline.mutex);
+            if (!pipeline.failure)
+                pipeline.failure = boost::current_exception();
+            pipeline.isAborted = true;
+            pipeline.changed.notify_all();
+        }
+
+        inline bool isAborted_() const
+        {
+            boost::lock_guard<boost::mutex> lock(pipeline_->mutex);
+            return pipeline_->isAborted;
+        }
+
+        inline void format_(FormattedRows_<Char,CharTraits>& rows, std::size_t block) const
+        {
+            std::size_t first = block * rowsPerBlock_;
+            rows.format(*matrix_, first, (std::min)(std::size_t(matrix_->size1()), first + rowsPerBlock_));
+        }
+
+        /**
+         * Widths of columns: maximum of widths found by every worker.
+         */
+        void mergeWidths_(unsigned workerCount) const
+        {
+            ColumnWidths_& columnWidths = *columnWidths_;
+            columnWidths.assign(matrix_->size2(), 0);
+            for (unsigned worker = 0; worker < workerCount; ++worker)
+                for (std::size_t j = 0; j < matrix_->size2(); ++j)
+                    columnWidths[j] = (std::max)(columnWidths[j], (*buffers_)[worker]->widths_[j]);
+            if (outputer_->getPlacing() == BY_EQUALWIDTH_COLUMNS && !columnWidths.empty())
+                std::fill(columnWidths.begin(), columnWidths.end(),
+                          *std::max_element(columnWidths.begin(), columnWidths.end()));
+        }
+
+        /**
+         * Replaces contents of "chunk" by text of a block.
+         */
+        void appendBlock_(std::basic_string<Char,CharTraits>& chunk, FormattedRows_<Char,CharTraits>& rows,
+                          std::size_t block) const
+        {
+            format_(rows, block);
+            chunk.clear();
+            for (std::size_t local = 0; local < rows.getRowCount(); ++local)
+                if (outputer_->getPlacing() == SIMPLE)
+                    appendRowSimply_(chunk, rows, local);
+                else
+                    outputer_->appendRow(chunk, rows, local, *columnWidths_, matrix_->size1());
+        }
+
+        /**
+         * Appends a formatted row as MatrixNiceOutputer does for SIMPLE placing.
+         */
+        void appendRowSimply_(std::basic_string<Char,CharTraits>& chunk,
+                              const FormattedRows_<Char,CharTraits>& rows, std::size_t local) const
+        {
+            std::size_t n = rows.getSize2(),
+                        i = rows.getFirstRow() + local;
+            chunk += Char(i == 0 ? '(' : ' ');
+            chunk += Char('(');
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                if (j > 0)
+                {
+                    chunk += Char(',');
+                    appendSpaces(chunk, outputer_->getMinSpaces());
+                }
+                rows.append(chunk, local, j);
+            }
+            chunk += Char(')');
+
+            if (i + 1 == matrix_->size1())
+                chunk += Char(')');
+            else
+            {
+                chunk += Char(',');
+                chunk += Char('\n');
+            }
+        }
+
+        const ParallelMatrixNiceOutputer* outputer_;
+        std::basic_ostream<Char,CharTraits>* output_;
+        const Matrix* matrix_;
+        std::size_t rowsPerBlock_,
+                    blockCount_;
+        const std::vector<Buffers*>* buffers_;
+        ColumnWidths_* columnWidths_;
+        boost::barrier* barrier_;
+        Pipeline_<Char,CharTraits>* pipeline_;
+    };
+
+}; //class ParallelMatrixNiceOutputer
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_PARALLELMATRIXNICEOUTPUTER_H__
@@ -0,0 +1,136 @@
+#ifndef __LIBUBLASAUX_PARALLELRUNNER_H__
+#define __LIBUBLASAUX_PARALLELRUNNER_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <boost/thread/thread.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Runs a task on a team of threads. The work itself is split by the task: every worker receives its
+ * own index and the size of the team and chooses its part of the job from them (usually
+ * "blocks index, index + count, index + 2*count, ..."). Results of such tasks must not depend on the
+ * team size if user wants to get the same output on any machine. This class implements "Monostate"
+ * pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Minimal fork-join helper used by parallel strategies of this library.
+ * @remark Requires linking with Boost.Thread library.
+ */
+class ParallelRunner {
+public:
+
+    /**
+     * @return Number of threads used when user has not set it explicitly: number of hardware
+     * threads (or 1 if it is unknown).
+     */
+    inline static unsigned getDefaultThreadCount()
+    {
+        unsigned count = boost::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+    /**
+     * @return Number of threads parallel strategies will use.
+     */
+    inline static unsigned getThreadCount()
+    {
+        return threadCount_() > 0 ? threadCount_() : getDefaultThreadCount();
+    }
+
+    /**
+     * Sets number of threads parallel strategies will use.
+     * @param count Number of threads. 0 means "as many as hardware threads".
+     * @warning Not thread-safe. Set it before starting of parallel work.
+     */
+    inline static void setThreadCount(unsigned count)
+    {
+        threadCount_() = count;
+    }
+
+    /**
+     * Executes "task(worker, workerCount)" for every worker in [0, workerCount) and waits for all of
+     * them. Worker 0 is executed by the calling thread; if it throws, other workers are joined before
+     * the exception is rethrown, so the task must make them finish (other workers must not throw).
+     * @tparam Task Copy-constructible functor with "void operator()(unsigned, unsigned)"
+     * @param task Task to be executed
+     * @param jobCount Number of independent jobs the task consists of. No more than "jobCount" workers
+     * will be started
+     */
+    template<class Task>
+    static void run(const Task& task, std::size_t jobCount)
+    {
+        unsigned workerCount = getThreadCount();
+        if (jobCount < workerCount)
+            workerCount = static_cast<unsigned>(jobCount);
+        if (workerCount <= 1)
+        {
+            task(0, 1);
+            return;
+        }
+
+        boost::thread_group team;
+        try
+        {
+            for (unsigned worker = 1; worker < workerCount; ++worker)
+                team.create_thread(Worker_<Task>(task, worker, workerCount));
+            task(0, workerCount);
+        }
+        catch (...)
+        {
+            team.join_all();
+            throw;
+        }
+        team.join_all();
+    }
+
+private:
+
+    template<class Task>
+    class Worker_ {
+    public:
+
+        inline Worker_(const Task& task, unsigned worker, unsigned workerCount):
+            task_(task), worker_(worker), workerCount_(workerCount) {}
+
+        inline void operator()() const
+        {
+            task_(worker_, workerCount_);
+        }
+
+    private:
+
+        Task task_;
+        unsigned worker_;
+        unsigned workerCount_;
+    };
+
+    inline static unsigned& threadCount_()
+    {
+        static unsigned count = 0;
+        return count;
+    }
+
+}; //class ParallelRunner
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_PARALLELRUNNER_H__
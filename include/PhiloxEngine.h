@@ -0,0 +1,216 @@
+#ifndef __LIBUBLASAUX_PHILOXENGINE_H__
+#define __LIBUBLASAUX_PHILOXENGINE_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CounterEngineTraits.h"
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Counter-based random-generating engine "Philox4x32-10" (Salmon, Moraes, Dror, Shaw: "Parallel
+ * random numbers: as easy as 1, 2, 3"). Its output is a pure function of a 64-bit key (seed) and a
+ * 128-bit counter. The counter is made of position (i, j) of the container element being generated
+ * and number of a draw inside that element, therefore element (i, j) of a randomized container
+ * depends only on the seed and on (i, j). Randomizers position the engine by themselves
+ * (@see CounterEngineTraits), so containers can be filled in parallel without any coordination, and
+ * any part of a huge matrix can be rebuilt alone: set origin of the engine to the first element of
+ * the part and randomize a matrix of the part's size.
+ * The engine models "UniformRandomNumberGenerator" concept of Boost.Random and can be used anywhere
+ * a sequential engine is used; without seeking it produces a single stream at position (0, 0).
+ * @author Anton Liaukevich
+ * @brief Counter-based engine which can generate any element of a container in O(1).
+ * @remark Positions are unique for i < 2^64 and j < 2^32.
+ */
+class PhiloxEngine {
+public:
+    /* Types */
+
+    typedef boost::uint32_t result_type;
+    typedef boost::uint64_t Position;
+
+    BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+    /* Construct/copy/destruct */
+
+    inline PhiloxEngine()
+    {
+        seed(0);
+    }
+
+    inline explicit PhiloxEngine(boost::uint64_t value)
+    {
+        seed(value);
+    }
+
+    /* Boost.Random engine interface */
+
+    inline static result_type (min)()
+    {
+        return 0;
+    }
+
+    inline static result_type (max)()
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    inline void seed(boost::uint64_t value)
+    {
+        key_[0] = static_cast<boost::uint32_t>(value);
+        key_[1] = static_cast<boost::uint32_t>(value >> 32);
+        origin1_ = origin2_ = 0;
+        seek(0, 0);
+    }
+
+    inline result_type operator()()
+    {
+        if (used_ == 4)
+        {
+            generateBlock_();
+            ++counter_[0];
+            used_ = 0;
+        }
+        return block_[used_++];
+    }
+
+    inline void discard(boost::uint64_t count)
+    {
+        for (; count > 0; --count)
+            (*this)();
+    }
+
+    /* Counter-based interface */
+
+    /**
+     * Positions the engine at the first draw of element (i, j) relative to the origin.
+     */
+    inline void seek(Position i, Position j)
+    {
+        i += origin1_;
+        j += origin2_;
+        counter_[0] = 0;
+        counter_[1] = static_cast<boost::uint32_t>(j);
+        counter_[2] = static_cast<boost::uint32_t>(i);
+        counter_[3] = static_cast<boost::uint32_t>(i >> 32);
+        used_ = 4;
+    }
+
+    /**
+     * Sets position which is added to every position passed to "seek". Used to rebuild a part of a
+     * container: element (0, 0) of the part is element (origin1, origin2) of the whole container.
+     */
+    inline void setOrigin(Position origin1, Position origin2)
+    {
+        origin1_ = origin1;
+        origin2_ = origin2;
+        seek(0, 0);
+    }
+
+    inline Position getOrigin1() const
+    {
+        return origin1_;
+    }
+
+    inline Position getOrigin2() const
+    {
+        return origin2_;
+    }
+
+    /* Comparison */
+
+    friend bool operator==(const PhiloxEngine& x, const PhiloxEngine& y)
+    {
+        for (int k = 0; k < 4; ++k)
+            if (x.counter_[k] != y.counter_[k])
+                return false;
+        return x.key_[0] == y.key_[0] && x.key_[1] == y.key_[1] && x.used_ == y.used_ &&
+               x.origin1_ == y.origin1_ && x.origin2_ == y.origin2_;
+    }
+
+    friend bool operator!=(const PhiloxEngine& x, const PhiloxEngine& y)
+    {
+        return !(x == y);
+    }
+
+private:
+
+    inline static void multiply_(boost::uint32_t a, boost::uint32_t b,
+                                 boost::uint32_t& high, boost::uint32_t& low)
+    {
+        boost::uint64_t product = static_cast<boost::uint64_t>(a) * b;
+        high = static_cast<boost::uint32_t>(product >> 32);
+        low  = static_cast<boost::uint32_t>(product);
+    }
+
+    void generateBlock_()
+    {
+        boost::uint32_t x[4] = { counter_[0], counter_[1], counter_[2], counter_[3] },
+                        k[2] = { key_[0], key_[1] };
+        for (int round = 0; round < 10; ++round)
+        {
+            boost::uint32_t high0, low0, high1, low1;
+            multiply_(0xD2511F53u, x[0], high0, low0);
+            multiply_(0xCD9E8D57u, x[2], high1, low1);
+            x[0] = high1 ^ x[1] ^ k[0];
+            x[1] = low1;
+            x[2] = high0 ^ x[3] ^ k[1];
+            x[3] = low0;
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        for (int w = 0; w < 4; ++w)
+            block_[w] = x[w];
+    }
+
+    /* Fields */
+
+    boost::uint32_t key_[2];
+    boost::uint32_t counter_[4];
+    boost::uint32_t block_[4];
+    int used_;
+    Position origin1_,
+             origin2_;
+
+}; //class PhiloxEngine
+
+
+/**
+ * PhiloxEngine is counter-based. Distribution is reset after seeking in order to drop values it may
+ * have cached from the previous element.
+ */
+template<>
+struct CounterEngineTraits<PhiloxEngine> {
+
+    static const bool IS_COUNTER_BASED = true;
+
+    template<class Die>
+    inline static void seek(Die& die, boost::uint64_t i, boost::uint64_t j)
+    {
+        die.engine().seek(i, j);
+        die.distribution().reset();
+    }
+};
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_PHILOXENGINE_H__
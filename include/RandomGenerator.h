@@ -19,6 +19,7 @@
  */
 
 #include "StdDispatchRandomizer.h"
+#include "Instrumentation.h"
 #include <boost/numeric/ublas/expression_types.hpp>
 
 namespace boost { namespace numeric { namespace ublas {
@@ -44,7 +45,10 @@ struct EmptyType {
  * @tparam DispatchRandomizer Strategy used to dispatch factical randomizing to partial specializations
  * in order to implement different behaviour for different container types (class templates).
  * Default strategy "StdDispatchRandomizer" supports all matrix and vector types (templates) from
- * Boost::numeric::uBLAS library and randomizes them without errors & waste of time.
+ * Boost::numeric::uBLAS library and randomizes them without errors & waste of time. Strategy
+ * "ParallelDispatchRandomizer" fills dense containers by several threads. Both strategies generate
+ * elements of uniform distributions and of "BoxMullerNormalDistribution" by blocks with SIMD
+ * kernels (@see BatchGenerator).
  * @remark I think (as contrasted with Andrei Alexandrescu) protected inheritance from
  * strategy class to be enough here.
  */
@@ -55,7 +59,12 @@ template<
          template<class,class,class> class DispatchRandomizer = StdDispatchRandomizer
         >
 class RandomGenerator:
-        protected StdDispatchRandomizer<Engine_,ItemDistribution_,IndexDistributionCreator_> {
+        protected DispatchRandomizer<Engine_,ItemDistribution_,IndexDistributionCreator_> {
+private:
+    /* Types */
+
+    typedef DispatchRandomizer<Engine_,ItemDistribution_,IndexDistributionCreator_> Dispatcher;
+
 public:
     /* Types */
 
@@ -87,7 +96,55 @@ public:
     template<class Container>
     inline void operator()(Container& container) const
     {
-        randomize(container, engine_, itemDistribution_);
+        Instrumentation::Probe probe(Instrumentation::GENERATOR, Instrumentation::KindOf<Container>::value);
+        Dispatcher::randomize(container, engine_, itemDistribution_);
+    }
+
+    /**
+     * Fills sparse matrix ("compressed_matrix" or "coordinate_matrix") with random numbers placed by
+     * a structured sparsity pattern instead of uniformly random positions. Previous contents of the
+     * matrix are cleared. Patterns (DiagonalsPattern, BlockDiagonalPattern, StencilPattern,
+     * RmatPattern) model "SparsePattern" concept:
+     * "std::size_t getNonZeroCount(std::size_t size1, std::size_t size2) const" returns number of
+     * non-zeros of a size1 x size2 matrix (used to reserve storage) and
+     * "template<class Engine, class Sink> void generate(Engine&, std::size_t size1, std::size_t size2,
+     * Sink& sink) const" calls "sink(i, j)" for every non-zero in row-major order.
+     * @tparam Container Sparse matrix type. It is deduced from function argument.
+     * @tparam Pattern Sparsity pattern type. It is deduced from function argument.
+     * @param[out] container Non-const reference to sparse matrix.
+     * @param pattern Sparsity pattern.
+     */
+    template<class Container, class Pattern>
+    inline void operator()(Container& container, const Pattern& pattern) const
+    {
+        Instrumentation::Probe probe(Instrumentation::GENERATOR, Instrumentation::KindOf<Container>::value);
+        Dispatcher::randomize(container, pattern, engine_, itemDistribution_);
+    }
+
+    /**
+     * Generates a matrix which is never constructed (for example one bigger than memory) as a
+     * sequence of dense tiles; edge tiles are smaller. They hold the same values as "operator()"
+     * would put into a matrix of the shape for the same state of the engine whatever the fill order
+     * is (@see FillOrder); elements the matrix type does not store (outside of triangles and bands,
+     * the upper part of symmetric and hermitian matrices, unit diagonals) are zeros. Tiles go row by
+     * row, left to right, or column by column, top to bottom, if a sequential engine fills the matrix
+     * column by column. Supported are dense, triangular, symmetric, hermitian and banded matrices.
+     * @tparam Matrix Matrix type. It is deduced from function argument.
+     * @tparam TileSink Functor called as "sink(first1, first2, tile)" where "tile" is
+     * "const matrix<Matrix::value_type>&" and (first1, first2) is position of its first element.
+     * @param shape Type and sizes of the matrix.
+     * @param tileSize1 Number of rows of tiles, positive.
+     * @param tileSize2 Number of columns of tiles, positive.
+     * @param sink Receiver of tiles.
+     * @throw bad_argument If a tile size is zero (whatever NDEBUG is)
+     * @remark Memory used is a strip of "tileSize1" full rows (or "tileSize2" full columns) for
+     * sequential engines and one tile for counter-based ones (@see PhiloxEngine).
+     */
+    template<class Matrix, class TileSink>
+    inline void stream(const MatrixShape<Matrix>& shape, std::size_t tileSize1, std::size_t tileSize2,
+                       TileSink& sink) const
+    {
+        Dispatcher::stream(shape, tileSize1, tileSize2, sink, engine_, itemDistribution_);
     }
 
     /* Field (random-backend) (read-only) access */
@@ -0,0 +1,126 @@
+#ifndef __LIBUBLASAUX_RMATPATTERN_H__
+#define __LIBUBLASAUX_RMATPATTERN_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <boost/numeric/ublas/exception.hpp>
+#include <boost/random/uniform_01.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Random sparsity pattern of "R-MAT" model (Chakrabarti, Zhan, Faloutsos: "R-MAT: A Recursive Model
+ * for Graph Mining") (@see RandomGenerator#operator()(Container&,const Pattern&)). Every element
+ * is placed by descending through quadrants of the matrix, choosing upper-left, upper-right,
+ * lower-left and lower-right one with probabilities a, b, c and d = 1 - a - b - c. Numbers of
+ * non-zeros in rows and columns follow a power law, as degrees of real-world graphs do. Repeated
+ * positions are drawn again, so the pattern has exactly the requested number of non-zeros.
+ * @author Anton Liaukevich
+ * @brief Power-law (R-MAT) sparsity pattern.
+ * @remark Intended for sparse matrices: drawing gets slow as the number of non-zeros approaches
+ * size of the matrix.
+ */
+class RmatPattern {
+public:
+    /* Construct/copy/destruct */
+
+    /**
+     * Default probabilities are the ones of Graph 500 benchmark. All of a, b, c and d must be
+     * positive: otherwise some positions are never drawn and requested non-zeros might not be found.
+     * @throw bad_argument If they are not (whatever NDEBUG is)
+     */
+    inline explicit RmatPattern(std::size_t nonZeroCount, double a = 0.57, double b = 0.19,
+                                double c = 0.19):
+        nonZeroCount_(nonZeroCount), a_(a), b_(b), c_(c)
+    {
+        if (!(a > 0 && b > 0 && c > 0 && a + b + c < 1))
+            bad_argument().raise();
+    }
+
+    /* "SparsePattern" interface */
+
+    inline std::size_t getNonZeroCount(std::size_t size1, std::size_t size2) const
+    {
+        return (std::min)(nonZeroCount_, size1 * size2);
+    }
+
+    template<class Engine, class Sink>
+    void generate(Engine& engine, std::size_t size1, std::size_t size2, Sink& sink) const
+    {
+        std::size_t count = getNonZeroCount(size1, size2);
+        if (count == 0)
+            return;
+
+        std::size_t side = 1;
+        while (side < size1 || side < size2)
+            side *= 2;
+
+        // Positions are numbered row by row, so sorted ones go in row-major order
+        std::vector<std::size_t> positions;
+        positions.reserve(count);
+        boost::uniform_01<double> uniform;
+        while (positions.size() < count)
+        {
+            std::size_t sorted = positions.size();
+            while (positions.size() < count)
+            {
+                std::size_t i = 0,
+                            j = 0;
+                for (std::size_t half = side / 2; half > 0; half /= 2)
+                {
+                    double p = uniform(engine);
+                    if (p >= a_ + b_ + c_)
+                    {
+                        i += half;
+                        j += half;
+                    }
+                    else if (p >= a_ + b_)
+                        i += half;
+                    else if (p >= a_)
+                        j += half;
+                }
+                if (i < size1 && j < size2)
+                    positions.push_back(i * size2 + j);
+            }
+            std::sort(positions.begin() + sorted, positions.end());
+            std::inplace_merge(positions.begin(), positions.begin() + sorted, positions.end());
+            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+        }
+
+        for (std::vector<std::size_t>::const_iterator it = positions.begin(); it != positions.end(); ++it)
+            sink(*it / size2, *it % size2);
+    }
+
+private:
+    /* Fields */
+
+    std::size_t nonZeroCount_;
+    double a_,
+           b_,
+           c_;
+
+}; //class RmatPattern
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_RMATPATTERN_H__
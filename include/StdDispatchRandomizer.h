@@ -18,24 +18,30 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "BatchGenerator.h"
+#include "ContainerTraits.h"
+#include "CounterEngineTraits.h"
+#include "FillOrder.h"
+#include "Instrumentation.h"
+#include "MatrixShape.h"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
 #include <boost/random/variate_generator.hpp>
-#include <boost/numeric/ublas/vector.hpp>
-#include <boost/numeric/ublas/vector_sparse.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/triangular.hpp>
-#include <boost/numeric/ublas/symmetric.hpp>
-#include <boost/numeric/ublas/hermitian.hpp>
-#include <boost/numeric/ublas/banded.hpp>
-#include <boost/numeric/ublas/matrix_sparse.hpp>
-#include <boost/numeric/ublas/vector_of_vector.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
 
 namespace boost { namespace numeric { namespace ublas {
 
 
 /**
  * "DispatchRandomizer" strategy good implementation. Supports all matrix and vector types (templates)
- * from Boost::numeric::uBLAS library and randomizes them without errors & waste of time. This template
- * implements "Monostate" pattern (only static methods).
+ * from Boost::numeric::uBLAS library and randomizes them without errors & waste of time. Backend is
+ * chosen by traits of the container (@see ContainerTraits), so other types described by the traits
+ * are supported as well. Matrices are filled line by line along their storage or row by row
+ * (@see FillOrder). This template implements "Monostate" pattern (only static methods).
  * @author Anton Liaukevich
  * @brief "DispatchRandomizer" strategy good implementation
  * @remark Template parameters are taken from wrapper @see RandomGenerator.
@@ -57,11 +63,29 @@ private:
     typedef boost::variate_generator<Engine&, ItemDist> ItemDie;
     typedef boost::variate_generator<Engine&, IndexDist> IndexDie;
 
+    /**
+     * Counter-based engines are positioned at every element before it is generated, so that the
+     * element depends only on the seed and its position (@see CounterEngineTraits).
+     */
+    typedef CounterEngineTraits<Engine> EngineTraits;
+
+    /**
+     * Distributions having a batched generator are generated by blocks (@see BatchGenerator) unless
+     * engine must be positioned at every element.
+     */
+    typedef BatchGenerator<ItemDist> ItemBatch;
+    static const bool IS_BATCHED = ItemBatch::IS_BATCHED && !EngineTraits::IS_COUNTER_BASED;
+
     /**
      * Dispatchering class. It is a core of this strategy implementation. It delegates
-     * random-generating logics using partial specializations of templates (in compile-time).
+     * random-generating logics to backends by shape and other traits of the container
+     * (@see ContainerTraits) using partial specializations of templates (in compile-time).
      */
-    template<class Container>
+    template<
+             class Container,
+             class Traits = ContainerTraits<Container>,
+             class Shape = typename ContainerTraits<Container>::Shape
+            >
     struct Dispatch_ {};
 
 public:
@@ -69,11 +93,41 @@ public:
     /**
      * Dispatching function callable from RandomGenerator (@see RandomGenerator#operator()).
      * It dispatches randomizing with nested (private) "Dispatch_" class (@see Dispatch_).
+     * Calls are recorded by instrumentation if it is enabled (@see Instrumentation).
      */
     template<class Container>
     inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
     {
+        Instrumentation::Probe probe(Instrumentation::RANDOMIZER, Instrumentation::KindOf<Container>::value);
         Dispatch_<Container>::randomize(container, engine, itemDist);
+        countElements_(probe, container, integral_constant<bool, Instrumentation::IS_ENABLED>());
+    }
+
+    /**
+     * Dispatching function for sparse matrices with structured sparsity patterns
+     * (@see RandomGenerator#operator()(Container&,const Pattern&)).
+     */
+    template<class Container, class Pattern>
+    inline static void randomize(Container& container, const Pattern& pattern, Engine& engine,
+                                 const ItemDist& itemDist)
+    {
+        Instrumentation::Probe probe(Instrumentation::RANDOMIZER, Instrumentation::KindOf<Container>::value);
+        Dispatch_<Container>::randomize(container, pattern, engine, itemDist);
+        countElements_(probe, container, integral_constant<bool, Instrumentation::IS_ENABLED>());
+    }
+
+    /**
+     * Streaming function callable from RandomGenerator (@see RandomGenerator#stream). Row structure
+     * of the matrix type is taken from nested (private) "Rows_" class (@see Rows_) and its storage
+     * order from the "Dispatch_" class filling it (@see Dispatch_).
+     */
+    template<class Matrix, class TileSink>
+    inline static void stream(const MatrixShape<Matrix>& shape, std::size_t tileSize1,
+                              std::size_t tileSize2, TileSink& sink, Engine& engine,
+                              const ItemDist& itemDist)
+    {
+        StreamRandomizer_::template stream< Rows_<Matrix>, Dispatch_<Matrix>::IS_COLUMN_ORDERED >(
+            shape, tileSize1, tileSize2, sink, engine, itemDist);
     }
 
 protected:
@@ -90,7 +144,11 @@ private:
      * Randomize implementation classes (backends)
      */
 
-    struct FullRandomizer_ {
+    /**
+     * Fills elements through "operator()" of the container. Elements of a matrix given by a line
+     * structure (@see Rows_) are filled row by row or column by column.
+     */
+    struct ElementRandomizer_ {
 
         template<class Vector>
         static void randomizeVector(Vector& vect, Engine& engine, const ItemDist& itemDist)
@@ -98,21 +156,54 @@ private:
             ItemDie die(engine, itemDist);
             typedef typename Vector::size_type Size;
             for (Size i = Size(); i < vect.size(); ++i)
+            {
+                EngineTraits::seek(die, i, 0);
                 vect(i) = die();
+            }
         }
 
-        template<class Matrix>
-        static void randomizeMatrix(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Rows, class Matrix>
+        static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist, bool isByColumns)
         {
             ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = Size(); j < matr.size2(); ++j)
-                    matr(i, j) = die();
+            std::size_t first, last;
+            if (isByColumns)
+                for (std::size_t j = 0; j < matr.size2(); ++j)
+                {
+                    Rows::getColumnRange(matr, j, first, last);
+                    for (std::size_t i = first; i < last; ++i)
+                        randomizeElement_<Rows>(matr, die, i, j);
+                }
+            else
+                for (std::size_t i = 0; i < matr.size1(); ++i)
+                {
+                    Rows::getRange(matr, i, first, last);
+                    for (std::size_t j = first; j < last; ++j)
+                        randomizeElement_<Rows>(matr, die, i, j);
+                }
+        }
+
+    private:
+
+        template<class Rows, class Matrix>
+        inline static void randomizeElement_(Matrix& matr, ItemDie& die, std::size_t i, std::size_t j)
+        {
+            EngineTraits::seek(die, i, j);
+            if (Rows::HAS_REAL_DIAGONAL && i == j)
+                matr(i, j) = type_traits<typename Matrix::value_type>::real(die());
+            else
+                matr(i, j) = die();
         }
     };
 
-    struct SparseRandomizer_ {
+    /**
+     * Fills "nnz_capacity()" randomly placed elements. Distinct positions are sampled at once (no
+     * lookups of already filled elements) in the storage order of the container, so compressed and
+     * coordinate containers are built by appending to the end of their index arrays. Whole fill
+     * takes O(nnz log nnz) time.
+     */
+    class SparseRandomizer_ {
+    public:
 
         template<class Vector>
         static void randomizeVector(Vector& vect, Engine& engine, const ItemDist& itemDist)
@@ -120,18 +211,17 @@ private:
             vect.clear();
 
             ItemDie itemDie(engine, itemDist);
-            IndexDie indexDie(engine, IndexDistCreator::create(vect.size()));
+            EngineTraits::seek(itemDie, 0, 0);
 
             typedef typename Vector::size_type Size;
-            Size remained = vect.nnz_capacity();
-            while (remained > Size())
+            std::vector<Size> positions;
+            samplePositions_(engine, vect.size(), (std::min)(vect.nnz_capacity(), vect.size()),
+                             positions);
+            for (typename std::vector<Size>::const_iterator it = positions.begin();
+                 it != positions.end(); ++it)
             {
-                Size falled = indexDie();
-                if (!vect.find_element(falled))
-                {
-                    vect.insert_element(falled, itemDie());
-                    --remained;
-                }
+                EngineTraits::seek(itemDie, *it, 0);
+                append_(vect, *it, typename Vector::value_type(itemDie()));
             }
         }
 
@@ -141,516 +231,969 @@ private:
             matr.clear();
 
             ItemDie itemDie(engine, itemDist);
-            IndexDie index1Die(engine, IndexDistCreator::create(matr.size1())),
-                     index2Die(engine, IndexDistCreator::create(matr.size2()));
+            EngineTraits::seek(itemDie, 0, 0);
+
+            typedef typename Matrix::size_type Size;
+            const bool IS_COLUMN_MAJOR =
+                boost::is_same<typename Matrix::orientation_category, column_major_tag>::value;
+            Size minorSize = IS_COLUMN_MAJOR ? matr.size1() : matr.size2(),
+                 total = matr.size1() * matr.size2();
+            std::vector<Size> positions;
+            samplePositions_(engine, total, (std::min)(matr.nnz_capacity(), total), positions);
+            for (typename std::vector<Size>::const_iterator it = positions.begin();
+                 it != positions.end(); ++it)
+            {
+                Size major = *it / minorSize,
+                     minor = *it % minorSize,
+                     i = IS_COLUMN_MAJOR ? minor : major,
+                     j = IS_COLUMN_MAJOR ? major : minor;
+                EngineTraits::seek(itemDie, i, j);
+                append_(matr, i, j, typename Matrix::value_type(itemDie()));
+            }
+            complete_(matr);
+        }
+
+        /**
+         * Fills elements placed by a sparsity pattern. Row-major containers are built in the order
+         * the pattern yields elements; elements of column-major ones are sorted by columns first.
+         */
+        template<class Matrix, class Pattern>
+        static void randomizePattern(Matrix& matr, const Pattern& pattern, Engine& engine,
+                                     const ItemDist& itemDist)
+        {
+            matr.clear();
+            matr.reserve(pattern.getNonZeroCount(matr.size1(), matr.size2()), false);
+
+            ItemDie itemDie(engine, itemDist);
+            EngineTraits::seek(itemDie, 0, 0);
 
             typedef typename Matrix::size_type Size;
-            Size remained = matr.nnz_capacity();
-            while (remained > Size())
+            if (boost::is_same<typename Matrix::orientation_category, column_major_tag>::value)
             {
-                Size falledIndex1 = index1Die(),
-                     falledIndex2 = index2Die();
-                if (!matr.find_element(falledIndex1, falledIndex2))
+                PositionCollector_<Size> collect;
+                pattern.generate(engine, matr.size1(), matr.size2(), collect);
+                std::stable_sort(collect.positions.begin(), collect.positions.end(),
+                                 &PositionCollector_<Size>::isLessColumn);
+                for (typename PositionCollector_<Size>::Positions::const_iterator it =
+                         collect.positions.begin(); it != collect.positions.end(); ++it)
                 {
-                    matr.insert_element(falledIndex1, falledIndex2, itemDie());
-                    --remained;
+                    EngineTraits::seek(itemDie, it->first, it->second);
+                    append_(matr, it->first, it->second, typename Matrix::value_type(itemDie()));
                 }
             }
+            else
+            {
+                Appender_<Matrix> append(matr, itemDie);
+                pattern.generate(engine, matr.size1(), matr.size2(), append);
+            }
+            complete_(matr);
         }
-    };
 
-    struct TriangleRandomizer_ {
+    private:
 
+        /**
+         * Pattern sink which appends random elements to a row-major matrix.
+         */
         template<class Matrix>
-        static void randomizeLower(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        class Appender_ {
+        public:
+
+            inline Appender_(Matrix& matr, ItemDie& itemDie):
+                matr_(&matr), itemDie_(&itemDie) {}
+
+            template<class Size>
+            inline void operator()(Size i, Size j)
+            {
+                EngineTraits::seek(*itemDie_, i, j);
+                append_(*matr_, typename Matrix::size_type(i), typename Matrix::size_type(j),
+                        typename Matrix::value_type((*itemDie_)()));
+            }
+
+        private:
+            Matrix* matr_;
+            ItemDie* itemDie_;
+        };
+
+        /**
+         * Pattern sink which keeps positions of elements.
+         */
+        template<class Size>
+        struct PositionCollector_ {
+
+            typedef std::vector< std::pair<Size,Size> > Positions;
+
+            template<class PatternSize>
+            inline void operator()(PatternSize i, PatternSize j)
+            {
+                positions.push_back(std::make_pair(Size(i), Size(j)));
+            }
+
+            inline static bool isLessColumn(const std::pair<Size,Size>& x, const std::pair<Size,Size>& y)
+            {
+                return x.second < y.second;
+            }
+
+            Positions positions;
+        };
+
+        /**
+         * Samples "count" distinct positions from [0, total) in ascending order. Dense samples are
+         * chosen by Floyd's algorithm marking positions in a bitmap. Sparse ones (bitmap would be
+         * much larger than the result) are drawn independently, sorted and deduplicated, and the few
+         * duplicates are redrawn by the same way; the resulting set is uniformly distributed as well.
+         */
+        template<class Size>
+        static void samplePositions_(Engine& engine, Size total, Size count, std::vector<Size>& positions)
         {
-            ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = Size(); j < matr.size2() && j <= i; ++j)
-                    matr(i, j) = die();
+            positions.clear();
+            if (count == Size())
+                return;
+            positions.reserve(count);
+
+            if (total / 64 <= count)
+            {
+                std::vector<bool> chosen(total, false);
+                for (Size j = total - count; j < total; ++j)
+                {
+                    Size t = drawIndex_(engine, j + 1);
+                    chosen[chosen[t] ? j : t] = true;
+                }
+                for (Size t = Size(); t < total; ++t)
+                    if (chosen[t])
+                        positions.push_back(t);
+            }
+            else
+            {
+                IndexDie indexDie(engine, IndexDistCreator::create(total));
+                while (positions.size() < count)
+                {
+                    Size sorted = positions.size();
+                    for (Size k = sorted; k < count; ++k)
+                        positions.push_back(indexDie());
+                    std::sort(positions.begin() + sorted, positions.end());
+                    std::inplace_merge(positions.begin(), positions.begin() + sorted, positions.end());
+                    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+                    Instrumentation::addCollisions(count - positions.size());
+                }
+            }
         }
 
-        template<class Matrix>
-        static void randomizeUnitLower(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        /**
+         * @return Random index from [0, size)
+         */
+        template<class Size>
+        inline static Size drawIndex_(Engine& engine, Size size)
         {
-            ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = Size(); j < matr.size2() && j < i; ++j)
-                    matr(i, j) = die();
+            IndexDie indexDie(engine, IndexDistCreator::create(size));
+            return indexDie();
         }
 
-        template<class Matrix>
-        static void randomizeUpper(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        /*
+         * Adding of elements in storage order
+         */
+
+        template<class Vector, class Size, class Item>
+        inline static void append_(Vector& vect, Size i, const Item& value)
         {
-            ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = i; j < matr.size2(); ++j)
-                    matr(i, j) = die();
+            vect.insert_element(i, value);
         }
 
-        template<class Matrix>
-        static void randomizeUnitUpper(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Item, std::size_t IB, class IndexArray, class ItemArray, class Size>
+        inline static void append_(compressed_vector<Item,IB,IndexArray,ItemArray>& vect, Size i,
+                                   const Item& value)
         {
-            ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = i + 1; j < matr.size2(); ++j)
-                    matr(i, j) = die();
+            vect.push_back(i, value);
         }
-    };
 
-    struct SymmetricRandomizer_ {
+        template<class Item, std::size_t IB, class IndexArray, class ItemArray, class Size>
+        inline static void append_(coordinate_vector<Item,IB,IndexArray,ItemArray>& vect, Size i,
+                                   const Item& value)
+        {
+            vect.push_back(i, value);
+        }
+
+        template<class Matrix, class Size, class Item>
+        inline static void append_(Matrix& matr, Size i, Size j, const Item& value)
+        {
+            matr.insert_element(i, j, value);
+        }
 
+        template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray,
+                 class Size>
+        inline static void append_(compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray>& matr,
+                                   Size i, Size j, const Item& value)
+        {
+            matr.push_back(i, j, value);
+        }
+
+        template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray,
+                 class Size>
+        inline static void append_(coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray>& matr,
+                                   Size i, Size j, const Item& value)
+        {
+            matr.push_back(i, j, value);
+        }
+
+        /**
+         * Fills pointers to rows after the last appended element.
+         */
         template<class Matrix>
-        static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        inline static void complete_(Matrix&) {}
+
+        template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
+        inline static void complete_(compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray>& matr)
         {
-            ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = Size(); j <= i; ++j)
-                    matr(i, j) = die();
+            matr.complete_index1_data();
         }
     };
 
-    struct HermitianRandomizer_ {
+    /**
+     * Writes straight into storage of containers whose elements of a line (row or column) are placed
+     * with a constant stride (dense arrays, packed triangles, banded storage). Storage address,
+     * stride and bounds are worked out once per line instead of the functor-driven index
+     * calculation of "operator()" on every element. Elements are generated in the same order as by
+     * ElementRandomizer_, therefore results are the same. Lines are generated by blocks when the
+     * distribution allows it.
+     */
+    class StorageRandomizer_ {
+    public:
 
-        template<class Matrix>
-        static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Vector>
+        static void randomizeVector(Vector& vect, Engine& engine, const ItemDist& itemDist)
         {
+            typedef typename Vector::size_type Size;
+            if (vect.size() == Size())
+                return;
+
             ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
+            typename Vector::value_type* data = &vect(0);
+            if (IS_BATCHED)
+            {
+                BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), data, 1,
+                                                    vect.size());
+                return;
+            }
+            for (Size i = Size(); i < vect.size(); ++i)
             {
-                for (Size j = Size(); j < i; ++j)
-                    matr(i, j) = die();
-                matr(i, i) = type_traits<typename Matrix::value_type>::real(die());
+                EngineTraits::seek(die, i, 0);
+                data[i] = die();
             }
         }
-    };
 
-    class BandedRandomizer_ {
-    public:
-
-        template<class Matrix>
-        static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist)
+        /**
+         * Fills elements of a matrix given by a line structure (@see Rows_) row by row or column
+         * by column. Elements of every filled line must be placed in storage with a constant
+         * stride.
+         */
+        template<class Rows, class Matrix>
+        static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist, bool isByColumns)
         {
             ItemDie die(engine, itemDist);
-            typedef typename Matrix::size_type Size;
-            for (Size i = Size(); i < matr.size1(); ++i)
-                for (Size j = startFrom_(i, matr.lower()); j <= i + matr.upper() && j < matr.size2(); ++j)
-                    matr(i, j) = die();
+            std::size_t first, last;
+            if (isByColumns)
+                for (std::size_t j = 0; j < matr.size2(); ++j)
+                {
+                    Rows::getColumnRange(matr, j, first, last);
+                    randomizeColumn_(matr, die, j, first, last);
+                }
+            else
+                for (std::size_t i = 0; i < matr.size1(); ++i)
+                {
+                    Rows::getRange(matr, i, first, last);
+                    randomizeRow_(matr, die, i, first, last);
+                }
         }
+
     private:
 
-        template<class Size>
-        inline static Size startFrom_(const Size& base, const Size& lower)
+        /**
+         * Fills elements [first, last) of row i. Elements of the row must be placed in storage with
+         * a constant stride.
+         */
+        template<class Matrix, class Size>
+        inline static void randomizeRow_(Matrix& matr, ItemDie& die, Size i, Size first, Size last)
         {
-            return base >= lower ? base - lower : Size();
+            if (first >= last)
+                return;
+
+            typedef typename Matrix::value_type Item;
+            Item* data = &matr(i, first);
+            std::ptrdiff_t stride = last - first > 1 ? &matr(i, first + 1) - data : 0;
+            if (IS_BATCHED)
+            {
+                BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), data, stride,
+                                                    last - first);
+                return;
+            }
+            for (Size j = first; j < last; ++j, data += stride)
+            {
+                EngineTraits::seek(die, i, j);
+                *data = die();
+            }
+        }
+
+        /**
+         * Fills elements [first, last) of column j. Elements of the column must be placed in storage
+         * with a constant stride.
+         */
+        template<class Matrix, class Size>
+        inline static void randomizeColumn_(Matrix& matr, ItemDie& die, Size j, Size first, Size last)
+        {
+            if (first >= last)
+                return;
+
+            typedef typename Matrix::value_type Item;
+            Item* data = &matr(first, j);
+            std::ptrdiff_t stride = last - first > 1 ? &matr(first + 1, j) - data : 0;
+            if (IS_BATCHED)
+            {
+                BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), data, stride,
+                                                    last - first);
+                return;
+            }
+            for (Size i = first; i < last; ++i, data += stride)
+            {
+                EngineTraits::seek(die, i, j);
+                *data = die();
+            }
         }
     };
 
-    /*
-     * Partial specializations for simple vector types
+    /**
+     * Fills a matrix with line structure "Rows" (@see Rows_) column by column if its storage places
+     * the structure by columns ("IS_COLUMN_ORDERED") and the fill order allows it (@see FillOrder),
+     * or row by row otherwise. Lines are filled straight in storage (@see StorageRandomizer_) if
+     * rows ("IS_ROW_DIRECT") or columns ("IS_COLUMN_DIRECT") of the structure are placed with a
+     * constant stride, or through "operator()" if they are not.
      */
+    template<class Rows, bool IS_COLUMN_ORDERED, bool IS_ROW_DIRECT, bool IS_COLUMN_DIRECT>
+    struct LineRandomizer_ {
 
-    template<class Item, class Storage>
-    struct Dispatch_< vector<Item,Storage> > {
-
-        inline static
-        void randomize(vector<Item,Storage>& vect, Engine& engine, const ItemDist& itemDist)
+        template<class Matrix>
+        inline static void randomize(Matrix& matr, Engine& engine, const ItemDist& itemDist)
         {
-            FullRandomizer_::randomizeVector(vect, engine, itemDist);
+            if (IS_COLUMN_ORDERED &&
+                (EngineTraits::IS_COUNTER_BASED || FillOrder::getOrder() == FillOrder::BY_STORAGE))
+                randomize_(matr, engine, itemDist, true, integral_constant<bool, IS_COLUMN_DIRECT>());
+            else
+                randomize_(matr, engine, itemDist, false, integral_constant<bool, IS_ROW_DIRECT>());
         }
-    };
 
-    template<class Item, std::size_t MAX_SIZE>
-    struct Dispatch_< bounded_vector<Item,MAX_SIZE> > {
+    private:
 
-        inline static
-        void randomize(bounded_vector<Item,MAX_SIZE>& vect, Engine& engine, const ItemDist& itemDist)
+        template<class Matrix>
+        inline static void randomize_(Matrix& matr, Engine& engine, const ItemDist& itemDist,
+                                      bool isByColumns, true_type)
         {
-            FullRandomizer_::randomizeVector(vect, engine, itemDist);
+            StorageRandomizer_::template randomize<Rows>(matr, engine, itemDist, isByColumns);
         }
-    };
-
-    template<class Item, std::size_t SIZE>
-    struct Dispatch_< c_vector<Item,SIZE> > {
 
-        inline static
-        void randomize(c_vector<Item,SIZE>& vect, Engine& engine, const ItemDist& itemDist)
+        template<class Matrix>
+        inline static void randomize_(Matrix& matr, Engine& engine, const ItemDist& itemDist,
+                                      bool isByColumns, false_type)
         {
-            FullRandomizer_::randomizeVector(vect, engine, itemDist);
+            ElementRandomizer_::template randomize<Rows>(matr, engine, itemDist, isByColumns);
         }
     };
 
-    template<class Item, class Alloc>
-    struct Dispatch_< zero_vector<Item,Alloc> > {
+    /**
+     * Generates a matrix that is never constructed as a sequence of dense tiles, in the same order
+     * of elements as LineRandomizer_ (@see LineRandomizer_), so tiles hold the same values as the
+     * constructed matrix would. Sequential engines make whole strip of "tileSize1" rows (or of
+     * "tileSize2" columns when the matrix is filled column by column) before handing its tiles;
+     * counter-based engines generate every tile separately.
+     */
+    class StreamRandomizer_ {
+    public:
 
-        inline static
-        void randomize(zero_vector<Item,Alloc>& vect, Engine& engine, const ItemDist& itemDist) {}
-    };
+        template<class Rows, bool IS_COLUMN_ORDERED, class Matrix, class TileSink>
+        static void stream(const MatrixShape<Matrix>& shape, std::size_t tileSize1,
+                           std::size_t tileSize2, TileSink& sink, Engine& engine,
+                           const ItemDist& itemDist)
+        {
+            if (tileSize1 == 0 || tileSize2 == 0)
+                bad_argument().raise();
+            typedef typename Matrix::value_type Item;
+            ItemDie die(engine, itemDist);
+            matrix<Item> tile;
+            if (EngineTraits::IS_COUNTER_BASED)
+            {
+                for (std::size_t first1 = 0; first1 < shape.size1(); first1 += tileSize1)
+                    for (std::size_t first2 = 0; first2 < shape.size2(); first2 += tileSize2)
+                    {
+                        std::size_t last1 = (std::min)(first1 + tileSize1, shape.size1()),
+                                    last2 = (std::min)(first2 + tileSize2, shape.size2());
+                        tile.resize(last1 - first1, last2 - first2, false);
+                        tile.clear();
+                        for (std::size_t i = first1; i < last1; ++i)
+                        {
+                            std::size_t first, last;
+                            Rows::getRange(shape, i, first, last);
+                            first = (std::max)(first, first2);
+                            last = (std::min)(last, last2);
+                            if (first < last)
+                                generateRow_<Rows>(die, i, first, last, &tile(i - first1, first - first2));
+                        }
+                        sink(first1, first2, static_cast<const matrix<Item>&>(tile));
+                    }
+                return;
+            }
 
-    template<class Item, class Alloc>
-    struct Dispatch_< unit_vector<Item,Alloc> > {
+            if (IS_COLUMN_ORDERED && FillOrder::getOrder() == FillOrder::BY_STORAGE)
+            {
+                matrix<Item,column_major> strip;
+                for (std::size_t first2 = 0; first2 < shape.size2(); first2 += tileSize2)
+                {
+                    std::size_t last2 = (std::min)(first2 + tileSize2, shape.size2());
+                    strip.resize(shape.size1(), last2 - first2, false);
+                    strip.clear();
+                    for (std::size_t j = first2; j < last2; ++j)
+                    {
+                        std::size_t first, last;
+                        Rows::getColumnRange(shape, j, first, last);
+                        if (first < last)
+                            generateColumn_<Rows>(die, j, first, last, &strip(first, j - first2));
+                    }
+                    for (std::size_t first1 = 0; first1 < shape.size1(); first1 += tileSize1)
+                    {
+                        std::size_t last1 = (std::min)(first1 + tileSize1, shape.size1());
+                        tile = subrange(strip, first1, last1, 0, last2 - first2);
+                        sink(first1, first2, static_cast<const matrix<Item>&>(tile));
+                    }
+                }
+                return;
+            }
+
+            matrix<Item> strip;
+            for (std::size_t first1 = 0; first1 < shape.size1(); first1 += tileSize1)
+            {
+                std::size_t last1 = (std::min)(first1 + tileSize1, shape.size1());
+                strip.resize(last1 - first1, shape.size2(), false);
+                strip.clear();
+                for (std::size_t i = first1; i < last1; ++i)
+                {
+                    std::size_t first, last;
+                    Rows::getRange(shape, i, first, last);
+                    if (first < last)
+                        generateRow_<Rows>(die, i, first, last, &strip(i - first1, first));
+                }
+                for (std::size_t first2 = 0; first2 < shape.size2(); first2 += tileSize2)
+                {
+                    std::size_t last2 = (std::min)(first2 + tileSize2, shape.size2());
+                    tile = subrange(strip, 0, last1 - first1, first2, last2);
+                    sink(first1, first2, static_cast<const matrix<Item>&>(tile));
+                }
+            }
+        }
+
+    private:
 
         /**
-         * @todo Is it right solution or I simply need to leave this specialization empty?
+         * Generates elements [first, last) of row i into contiguous memory.
          */
-        inline static
-        void randomize(unit_vector<Item,Alloc>& vect, Engine& engine, const ItemDist& itemDist)
+        template<class Rows, class Item>
+        static void generateRow_(ItemDie& die, std::size_t i, std::size_t first, std::size_t last,
+                                 Item* data)
         {
-            typedef unit_vector<Item,Alloc> Vector;
-            if (vect.size() > typename Vector::size_type())
+            if (IS_BATCHED && !Rows::HAS_REAL_DIAGONAL)
             {
-                IndexDie indexDie(engine, IndexDistCreator::create(vect.size()));
-                Vector temp(vect.size(), indexDie());
-                //TODO: Are "noalias" function useful there&
-                // noalias(vect) = temp;
-                vect = temp;
+                BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), data, 1,
+                                                    last - first);
+                return;
+            }
+            for (std::size_t j = first; j < last; ++j, ++data)
+            {
+                EngineTraits::seek(die, i, j);
+                if (Rows::HAS_REAL_DIAGONAL && j == i)
+                    *data = type_traits<Item>::real(die());
+                else
+                    *data = die();
             }
         }
-    };
-
-    template<class Item, class Alloc>
-    struct Dispatch_< scalar_vector<Item,Alloc> > {
 
         /**
-         * @todo Is it right solution or I simply need to leave this specialization empty?
+         * Generates elements [first, last) of column j into contiguous memory.
          */
-        inline static
-        void randomize(scalar_vector<Item,Alloc>& vect, Engine& engine, const ItemDist& itemDist)
+        template<class Rows, class Item>
+        static void generateColumn_(ItemDie& die, std::size_t j, std::size_t first, std::size_t last,
+                                    Item* data)
         {
-            ItemDie itemDie(engine, itemDist);
-            scalar_vector<Item,Alloc> temp(vect.size(), itemDie());
-            //TODO: Are "noalias" function useful there&
-            // noalias(vect) = temp;
-            vect = temp;
+            if (IS_BATCHED && !Rows::HAS_REAL_DIAGONAL)
+            {
+                BaseBatchGenerator::fill<ItemBatch>(die.engine(), die.distribution(), data, 1,
+                                                    last - first);
+                return;
+            }
+            for (std::size_t i = first; i < last; ++i, ++data)
+            {
+                EngineTraits::seek(die, i, j);
+                if (Rows::HAS_REAL_DIAGONAL && i == j)
+                    *data = type_traits<Item>::real(die());
+                else
+                    *data = die();
+            }
         }
     };
 
     /*
-     * Partial specializations for sparse vector types
+     * Line structures of matrix types: "getRange" gives columns [first, last) of row i the backends
+     * generate and "getColumnRange" rows [first, last) of column j. Row structures are also used
+     * for streaming; they are chosen by traits of the matrix type like backends
      */
 
-    template<class Item, class Storage>
-    struct Dispatch_< mapped_vector<Item,Storage> > {
+    template<
+             class Matrix,
+             class Traits = ContainerTraits<Matrix>,
+             class Shape = typename ContainerTraits<Matrix>::Shape
+            >
+    struct Rows_ {};
 
-        inline static
-        void randomize(mapped_vector<Item,Storage>& vect, Engine& engine, const ItemDist& itemDist)
+    struct FullRows_ {
+
+        static const bool HAS_REAL_DIAGONAL = false;
+
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t, std::size_t& first,
+                                    std::size_t& last)
         {
-            SparseRandomizer_::randomizeVector(vect, engine, itemDist);
+            first = 0;
+            last = shape.size2();
         }
-    };
-
-    template<class Item, std::size_t IB, class IndexArray, class ItemArray>
-    struct Dispatch_< compressed_vector<Item,IB,IndexArray,ItemArray> > {
 
-        inline static
-        void randomize(compressed_vector<Item,IB,IndexArray,ItemArray>& vect, Engine& engine,
-                       const ItemDist& itemDist)
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t, std::size_t& first,
+                                          std::size_t& last)
         {
-            SparseRandomizer_::randomizeVector(vect, engine, itemDist);
+            first = 0;
+            last = shape.size1();
         }
     };
 
-    template<class Item, std::size_t IB, class IndexArray, class ItemArray>
-    struct Dispatch_< coordinate_vector<Item,IB,IndexArray,ItemArray> > {
+    struct LowerRows_ {
 
-        inline static
-        void randomize(coordinate_vector<Item,IB,IndexArray,ItemArray>& vect, Engine& engine,
-                       const ItemDist& itemDist)
+        static const bool HAS_REAL_DIAGONAL = false;
+
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t i, std::size_t& first,
+                                    std::size_t& last)
         {
-            SparseRandomizer_::randomizeVector(vect, engine, itemDist);
+            first = 0;
+            last = (std::min)(i + 1, shape.size2());
+        }
+
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t j, std::size_t& first,
+                                          std::size_t& last)
+        {
+            first = j;
+            last = shape.size1();
         }
     };
 
-    /*
-     * Partial specializations for simple matrix types
-     */
+    struct UnitLowerRows_ {
 
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< matrix<Item,Orientation,Storage> > {
+        static const bool HAS_REAL_DIAGONAL = false;
 
-        inline static
-        void randomize(matrix<Item,Orientation,Storage>& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t i, std::size_t& first,
+                                    std::size_t& last)
         {
-            FullRandomizer_::randomizeMatrix(matr, engine, itemDist);
+            first = 0;
+            last = (std::min)(i, shape.size2());
         }
-    };
-
-    template<class Item, std::size_t M, std::size_t N, class Orientation>
-    struct Dispatch_< bounded_matrix<Item,M,N,Orientation> > {
 
-        inline static
-        void randomize(bounded_matrix<Item,M,N,Orientation>& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t j, std::size_t& first,
+                                          std::size_t& last)
         {
-            FullRandomizer_::randomizeMatrix(matr, engine, itemDist);
+            first = j + 1;
+            last = shape.size1();
         }
     };
 
-    template<class Item, std::size_t M, std::size_t N>
-    struct Dispatch_< c_matrix<Item,M,N> > {
+    struct UpperRows_ {
 
-        inline static
-        void randomize(c_matrix<Item,M,N>& matr, Engine& engine, const ItemDist& itemDist)
+        static const bool HAS_REAL_DIAGONAL = false;
+
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t i, std::size_t& first,
+                                    std::size_t& last)
         {
-            FullRandomizer_::randomizeMatrix(matr, engine, itemDist);
+            first = i;
+            last = shape.size2();
+        }
+
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t j, std::size_t& first,
+                                          std::size_t& last)
+        {
+            first = 0;
+            last = (std::min)(j + 1, shape.size1());
         }
     };
 
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< vector_of_vector<Item,Orientation,Storage> > {
+    struct UnitUpperRows_ {
+
+        static const bool HAS_REAL_DIAGONAL = false;
 
-        inline static
-        void randomize(vector_of_vector<Item,Orientation,Storage>& matr, Engine& engine,
-                                        const ItemDist& itemDist)
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t i, std::size_t& first,
+                                    std::size_t& last)
         {
-            FullRandomizer_::randomizeMatrix(matr, engine, itemDist);
+            first = i + 1;
+            last = shape.size2();
+        }
+
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t j, std::size_t& first,
+                                          std::size_t& last)
+        {
+            first = 0;
+            last = (std::min)(j, shape.size1());
         }
     };
 
-    template<class Item, class Alloc>
-    struct Dispatch_< zero_matrix<Item,Alloc> > {
+    struct HermitianRows_: public LowerRows_ {
 
-        inline static
-        void randomize(zero_matrix<Item,Alloc>& matr, Engine& engine, const ItemDist& itemDist) {}
+        static const bool HAS_REAL_DIAGONAL = true;
     };
 
-    template<class Item, class Alloc>
-    struct Dispatch_< identity_matrix<Item,Alloc> > {
+    struct BandedRows_ {
 
-        inline static
-        void randomize(identity_matrix<Item,Alloc>& matr, Engine& engine, const ItemDist& itemDist) {}
-    };
+        static const bool HAS_REAL_DIAGONAL = false;
 
-    template<class Item, class Alloc>
-    struct Dispatch_< scalar_matrix<Item,Alloc> > {
+        template<class Shape>
+        inline static void getRange(const Shape& shape, std::size_t i, std::size_t& first,
+                                    std::size_t& last)
+        {
+            first = i >= shape.lower() ? i - shape.lower() : 0;
+            last = (std::min)(i + shape.upper() + 1, shape.size2());
+        }
 
-        inline static
-        void randomize(scalar_matrix<Item,Alloc>& matr, Engine& engine, const ItemDist& itemDist)
+        template<class Shape>
+        inline static void getColumnRange(const Shape& shape, std::size_t j, std::size_t& first,
+                                          std::size_t& last)
         {
-            ItemDie itemDie(engine, itemDist);
-            scalar_matrix<Item,Alloc> temp(matr.size1(), matr.size2(), itemDie());
-            //TODO: Are "noalias" function useful there&
-            // noalias(matr) = temp;
-            matr = temp;
+            first = j >= shape.upper() ? j - shape.upper() : 0;
+            last = (std::min)(j + shape.lower() + 1, shape.size1());
         }
     };
 
     /*
-     * Partial specializations for triangular, symmetric, hermitian, banded matrix types & they adaptors
+     * Partial specialization for dense containers. Vectors kept in one array and matrices whose
+     * lines are placed with a constant stride are filled straight in storage
      */
 
-    template<class Item, class Type, class Orientation, class Storage>
-    struct Dispatch_< triangular_matrix<Item,Type,Orientation,Storage> > {};
-
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< triangular_matrix<Item,lower,Orientation,Storage> > {
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,DenseShape> {
 
-        inline static
-        void randomize(triangular_matrix<Item,lower,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
         {
-            TriangleRandomizer_::randomizeLower(matr, engine, itemDist);
+            randomize_(container, engine, itemDist, integral_constant<bool, Traits::IS_VECTOR>(),
+                       integral_constant<bool, Traits::IS_CONTIGUOUS>());
         }
-    };
 
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< triangular_matrix<Item,unit_lower,Orientation,Storage> > {
+        /**
+         * Whether matrices are placed in storage column by column (streaming follows it as well)
+         */
+        static const bool IS_COLUMN_ORDERED =
+            boost::is_same<typename Traits::OrientationCategory, column_major_tag>::value;
 
-        inline static
-        void randomize(triangular_matrix<Item,unit_lower,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+    private:
+
+        inline static void randomize_(Container& vect, Engine& engine, const ItemDist& itemDist,
+                                      true_type, true_type)
         {
-            TriangleRandomizer_::randomizeUnitLower(matr, engine, itemDist);
+            StorageRandomizer_::randomizeVector(vect, engine, itemDist);
         }
-    };
 
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< triangular_matrix<Item,upper,Orientation,Storage> > {
+        inline static void randomize_(Container& vect, Engine& engine, const ItemDist& itemDist,
+                                      true_type, false_type)
+        {
+            ElementRandomizer_::randomizeVector(vect, engine, itemDist);
+        }
 
-        inline static
-        void randomize(triangular_matrix<Item,upper,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        template<class IsContiguous>
+        inline static void randomize_(Container& matr, Engine& engine, const ItemDist& itemDist,
+                                      false_type, IsContiguous)
         {
-            TriangleRandomizer_::randomizeUpper(matr, engine, itemDist);
+            LineRandomizer_<FullRows_, IS_COLUMN_ORDERED, Traits::IS_ROW_STRIDED,
+                            IS_COLUMN_ORDERED && Traits::IS_LINE_CONTIGUOUS>::randomize(matr, engine,
+                                                                                       itemDist);
         }
     };
 
-    /**
-     * @bug Boost raises "bad_index" exception for triangular matrices of "unit_upper" type
-     * and only for non-square squarte matrices. Even so for triangular adaptors it works Ok.
+    /*
+     * Partial specialization for constant containers
      */
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< triangular_matrix<Item,unit_upper,Orientation,Storage> > {
 
-        inline static
-        void randomize(triangular_matrix<Item,unit_upper,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,ConstantShape> {
+
+        inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
         {
-            TriangleRandomizer_::randomizeUnitUpper(matr, engine, itemDist);
+            randomize_(container, engine, itemDist, typename Traits::Structure());
         }
-    };
 
-    template<class Matrix, class Type>
-    struct Dispatch_< triangular_adaptor<Matrix,Type> > {};
+    private:
 
-    template<class Matrix>
-    struct Dispatch_< triangular_adaptor<Matrix,lower> > {
+        inline static void randomize_(Container&, Engine&, const ItemDist&, ZeroStructure) {}
+
+        inline static void randomize_(Container&, Engine&, const ItemDist&, IdentityStructure) {}
 
-        inline static
-        void randomize(triangular_adaptor<Matrix,lower>& matr, Engine& engine, const ItemDist& itemDist)
+        /**
+         * @todo Is it right solution or I simply need to leave this specialization empty?
+         */
+        inline static void randomize_(Container& vect, Engine& engine, const ItemDist&, UnitStructure)
         {
-            TriangleRandomizer_::randomizeLower(matr, engine, itemDist);
+            if (vect.size() > typename Container::size_type())
+            {
+                IndexDie indexDie(engine, IndexDistCreator::create(vect.size()));
+                EngineTraits::seek(indexDie, 0, 0);
+                Container temp(vect.size(), indexDie());
+                //TODO: Are "noalias" function useful there&
+                // noalias(vect) = temp;
+                vect = temp;
+            }
         }
-    };
-
-    template<class Matrix>
-    struct Dispatch_< triangular_adaptor<Matrix,unit_lower> > {
 
-        inline static
-        void randomize(triangular_adaptor<Matrix,unit_lower>& matr, Engine& engine, const ItemDist& itemDist)
+        /**
+         * @todo Is it right solution or I simply need to leave this specialization empty?
+         */
+        inline static void randomize_(Container& container, Engine& engine, const ItemDist& itemDist,
+                                      ScalarStructure)
         {
-            TriangleRandomizer_::randomizeUnitLower(matr, engine, itemDist);
+            ItemDie itemDie(engine, itemDist);
+            EngineTraits::seek(itemDie, 0, 0);
+            //TODO: Are "noalias" function useful there&
+            // noalias(container) = temp;
+            container = makeScalar_(container, itemDie(), integral_constant<bool, Traits::IS_VECTOR>());
         }
-    };
-
-    template<class Matrix>
-    struct Dispatch_< triangular_adaptor<Matrix,upper> > {
 
-        inline static
-        void randomize(triangular_adaptor<Matrix,upper>& matr, Engine& engine, const ItemDist& itemDist)
+        inline static Container makeScalar_(const Container& vect,
+                                            const typename Container::value_type& value, true_type)
         {
-            TriangleRandomizer_::randomizeUpper(matr, engine, itemDist);
+            return Container(vect.size(), value);
         }
-    };
-
-    template<class Matrix>
-    struct Dispatch_< triangular_adaptor<Matrix,unit_upper> > {
 
-        inline static
-        void randomize(triangular_adaptor<Matrix,unit_upper>& matr, Engine& engine, const ItemDist& itemDist)
+        inline static Container makeScalar_(const Container& matr,
+                                            const typename Container::value_type& value, false_type)
         {
-            TriangleRandomizer_::randomizeUnitUpper(matr, engine, itemDist);
+            return Container(matr.size1(), matr.size2(), value);
         }
     };
 
-    template<class Item, class Type, class Orientation, class Storage>
-    struct Dispatch_< symmetric_matrix<Item,Type,Orientation,Storage> > {
+    /*
+     * Partial specialization for packed triangular, symmetric and hermitian matrices & their
+     * adaptors. Stored triangles are filled straight in storage by lines of their storage order (or
+     * by rows if the fill order requires it and rows are placed with a constant stride). Symmetric
+     * and hermitian matrices get their lower part, which is placed in storage row by row when the
+     * matrix is stored either as "lower, row_major" or as "upper, column_major" and column by column
+     * otherwise.
+     * @bug Boost raises "bad_index" exception for triangular matrices of "unit_upper" type
+     * and only for non-square squarte matrices. Even so for triangular adaptors it works Ok.
+     */
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,PackedShape> {
 
-        inline static
-        void randomize(symmetric_matrix<Item,Type,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        inline static void randomize(Container& matr, Engine& engine, const ItemDist& itemDist)
         {
-            SymmetricRandomizer_::randomize(matr, engine, itemDist);
+            LineRandomizer_<PackedRows_<Structure_, typename Traits::Triangle>, IS_COLUMN_ORDERED,
+                            IS_ROW_DIRECT_, IS_COLUMN_DIRECT_>::randomize(matr, engine, itemDist);
         }
+
+    private:
+        typedef typename Traits::Structure Structure_;
+
+        static const bool IS_TRIANGULAR_ = boost::is_same<Structure_, TriangularStructure>::value;
+        static const bool IS_COLUMN_MAJOR_ =
+            boost::is_same<typename Traits::OrientationCategory, column_major_tag>::value;
+        static const bool IS_ROW_MAJOR_ =
+            boost::is_same<typename Traits::OrientationCategory, row_major_tag>::value;
+        static const bool IS_LOWER_ = boost::is_same<typename Traits::Triangle, lower>::value;
+
+        /**
+         * Whether columns of the lower part (of a symmetric or hermitian matrix) are placed in
+         * storage contiguously
+         */
+        static const bool IS_LOWER_BY_COLUMNS_ = IS_LOWER_ ? IS_COLUMN_MAJOR_ : IS_ROW_MAJOR_;
+
+        static const bool IS_ROW_DIRECT_ =
+            IS_TRIANGULAR_ ? Traits::IS_ROW_STRIDED :
+                             boost::is_same<Structure_, SymmetricStructure>::value &&
+                             Traits::IS_CONTIGUOUS && !IS_LOWER_BY_COLUMNS_;
+        static const bool IS_COLUMN_DIRECT_ =
+            IS_TRIANGULAR_ ? Traits::IS_LINE_CONTIGUOUS :
+                             boost::is_same<Structure_, SymmetricStructure>::value &&
+                             Traits::IS_CONTIGUOUS;
+
+    public:
+        static const bool IS_COLUMN_ORDERED = IS_TRIANGULAR_ ? IS_COLUMN_MAJOR_ : IS_LOWER_BY_COLUMNS_;
     };
 
-    template<class Matrix, class Type>
-    struct Dispatch_< symmetric_adaptor<Matrix,Type> > {
+    /*
+     * Partial specialization for banded matrices & their adaptors
+     */
+
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,BandedShape> {
 
-        inline static
-        void randomize(symmetric_adaptor<Matrix,Type>& matr, Engine& engine, const ItemDist& itemDist)
+        inline static void randomize(Container& matr, Engine& engine, const ItemDist& itemDist)
         {
-            SymmetricRandomizer_::randomize(matr, engine, itemDist);
+            LineRandomizer_<BandedRows_, IS_COLUMN_ORDERED, Traits::IS_ROW_STRIDED,
+                            Traits::IS_LINE_CONTIGUOUS>::randomize(matr, engine, itemDist);
         }
+
+        static const bool IS_COLUMN_ORDERED =
+            boost::is_same<typename Traits::OrientationCategory, column_major_tag>::value;
     };
 
-    template<class Item, class Type, class Orientation, class Storage>
-    struct Dispatch_< hermitian_matrix<Item,Type,Orientation,Storage> > {
+    /*
+     * Partial specializations for sparse containers
+     */
+
+    /**
+     * @warning I couldn't create an object of any specialization of "generalized_vector_of_vector"
+     * template therefore it haven't been tested.
+     */
+    template<class Container, class Traits>
+    struct Dispatch_<Container,Traits,SparseShape> {
 
-        inline static
-        void randomize(hermitian_matrix<Item,Type,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        inline static void randomize(Container& container, Engine& engine, const ItemDist& itemDist)
         {
-            HermitianRandomizer_::randomize(matr, engine, itemDist);
+            randomize_(container, engine, itemDist, integral_constant<bool, Traits::IS_VECTOR>());
         }
-    };
-
-    template<class Matrix, class Type>
-    struct Dispatch_< hermitian_adaptor<Matrix,Type> > {
 
-        inline static
-        void randomize(hermitian_adaptor<Matrix,Type>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        template<class Pattern>
+        inline static void randomize(Container& matr, const Pattern& pattern, Engine& engine,
+                                     const ItemDist& itemDist)
         {
-            HermitianRandomizer_::randomize(matr, engine, itemDist);
+            SparseRandomizer_::randomizePattern(matr, pattern, engine, itemDist);
         }
-    };
 
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< banded_matrix<Item,Orientation,Storage> > {
+    private:
 
-        inline static
-        void randomize(banded_matrix<Item,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+        inline static void randomize_(Container& vect, Engine& engine, const ItemDist& itemDist,
+                                      true_type)
         {
-            BandedRandomizer_::randomize(matr, engine, itemDist);
+            SparseRandomizer_::randomizeVector(vect, engine, itemDist);
         }
-    };
 
-    template<class Matrix>
-    struct Dispatch_< banded_adaptor<Matrix> > {
-
-        inline static
-        void randomize(banded_adaptor<Matrix>& matr, Engine& engine, const ItemDist& itemDist)
+        inline static void randomize_(Container& matr, Engine& engine, const ItemDist& itemDist,
+                                      false_type)
         {
-            BandedRandomizer_::randomize(matr, engine, itemDist);
+            SparseRandomizer_::randomizeMatrix(matr, engine, itemDist);
         }
     };
 
-    /*
-     * Partial specializations for sparse matrix types
-     */
-
     /**
      * @bug nnz_capacity() method of "mapped_matrix" always returns 0 therefore I don't know how many
      * elements I need to random-generate. As a result I have excluded implementation for
      * "mapped_matrix" leaving specialization of the Dispatch_ template for "mapped_matrix" empty.
      * @remark It works Ok on "compressed_matrix" & "coordinate_matrix" matrix types.
      */
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< mapped_matrix<Item,Orientation,Storage> > {};
+    template<class Item, class Orientation, class Storage, class Traits>
+    struct Dispatch_< mapped_matrix<Item,Orientation,Storage>, Traits, SparseShape > {};
 
-    template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
-    struct Dispatch_< compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray> > {
+    /*
+     * Row structures of matrix types which can be streamed
+     */
 
-        inline static
-        void randomize(compressed_matrix<Item,Orientation,IB,IndexArray,ItemArray>& matr, Engine& engine,
-                       const ItemDist& itemDist)
-        {
-            SparseRandomizer_::randomizeMatrix(matr, engine, itemDist);
-        }
-    };
+    template<class Structure, class Triangle, class Dummy = void>
+    struct PackedRows_ {};
 
-    template<class Item, class Orientation, std::size_t IB, class IndexArray, class ItemArray>
-    struct Dispatch_< coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray> > {
+    template<class Dummy>
+    struct PackedRows_<TriangularStructure,lower,Dummy>: public LowerRows_ {};
 
-        inline static
-        void randomize(coordinate_matrix<Item,Orientation,IB,IndexArray,ItemArray>& matr, Engine& engine,
-                       const ItemDist& itemDist)
-        {
-            SparseRandomizer_::randomizeMatrix(matr, engine, itemDist);
-        }
-    };
+    template<class Dummy>
+    struct PackedRows_<TriangularStructure,unit_lower,Dummy>: public UnitLowerRows_ {};
 
-    /**
-     * @warning I couldn't create an object of any specialization of "generalized_vector_of_vector"
-     * template therefore it haven't been tested.
+    template<class Dummy>
+    struct PackedRows_<TriangularStructure,upper,Dummy>: public UpperRows_ {};
+
+    template<class Dummy>
+    struct PackedRows_<TriangularStructure,unit_upper,Dummy>: public UnitUpperRows_ {};
+
+    template<class Triangle, class Dummy>
+    struct PackedRows_<SymmetricStructure,Triangle,Dummy>: public LowerRows_ {};
+
+    template<class Triangle, class Dummy>
+    struct PackedRows_<HermitianStructure,Triangle,Dummy>: public HermitianRows_ {};
+
+    template<class Matrix, class Traits>
+    struct Rows_<Matrix,Traits,DenseShape>: public FullRows_ {};
+
+    template<class Matrix, class Traits>
+    struct Rows_<Matrix,Traits,PackedShape>:
+        public PackedRows_<typename Traits::Structure, typename Traits::Triangle> {};
+
+    template<class Matrix, class Traits>
+    struct Rows_<Matrix,Traits,BandedShape>: public BandedRows_ {};
+
+    /*
+     * Counting of generated elements for instrumentation (@see Instrumentation). It is compiled only
+     * if instrumentation is enabled
      */
-    template<class Item, class Orientation, class Storage>
-    struct Dispatch_< generalized_vector_of_vector<Item,Orientation,Storage> > {
 
-        inline static
-        void randomize(generalized_vector_of_vector<Item,Orientation,Storage>& matr, Engine& engine,
-                       const ItemDist& itemDist)
+    template<class Container>
+    inline static void countElements_(Instrumentation::Probe&, const Container&, false_type) {}
+
+    template<class Container>
+    inline static void countElements_(Instrumentation::Probe& probe, const Container& container, true_type)
+    {
+        typedef ContainerTraits<Container> Traits;
+        probe.addElements(getElementCount_(container, typename Traits::Shape(),
+                                           integral_constant<bool, Traits::IS_VECTOR>()));
+    }
+
+    template<class Vector>
+    inline static std::size_t getElementCount_(const Vector& vect, DenseShape, true_type)
+    {
+        return vect.size();
+    }
+
+    template<class Vector>
+    inline static std::size_t getElementCount_(const Vector& vect, SparseShape, true_type)
+    {
+        return vect.nnz();
+    }
+
+    template<class Matrix>
+    inline static std::size_t getElementCount_(const Matrix& matr, SparseShape, false_type)
+    {
+        return matr.nnz();
+    }
+
+    template<class Vector>
+    inline static std::size_t getElementCount_(const Vector&, ConstantShape, true_type)
+    {
+        return boost::is_same<typename ContainerTraits<Vector>::Structure, ScalarStructure>::value;
+    }
+
+    template<class Matrix>
+    inline static std::size_t getElementCount_(const Matrix&, ConstantShape, false_type)
+    {
+        return boost::is_same<typename ContainerTraits<Matrix>::Structure, ScalarStructure>::value;
+    }
+
+    /**
+     * Dense, packed and banded matrices: elements of their line structures (@see Rows_)
+     */
+    template<class Matrix, class Shape>
+    static std::size_t getElementCount_(const Matrix& matr, Shape, false_type)
+    {
+        std::size_t count = 0,
+                    first,
+                    last;
+        for (std::size_t i = 0; i < matr.size1(); ++i)
         {
-            SparseRandomizer_::randomizeMatrix(matr, engine, itemDist);
+            Rows_<Matrix>::getRange(matr, i, first, last);
+            if (first < last)
+                count += last - first;
         }
-    };
+        return count;
+    }
 
 }; //template class StdDispatchRandomizer
 
@@ -0,0 +1,152 @@
+#ifndef __LIBUBLASAUX_STENCILPATTERN_H__
+#define __LIBUBLASAUX_STENCILPATTERN_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <boost/numeric/ublas/exception.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Sparsity pattern of a finite-difference operator on a regular 2D or 3D grid
+ * (@see RandomGenerator#operator()(Container&,const Pattern&)). Grid point (x, y, z) is row number
+ * (z * sizeY + y) * sizeX + x of a square matrix, and the row has non-zeros in columns of the point
+ * itself and of its neighbours in the stencil.
+ * @author Anton Liaukevich
+ * @brief 5-, 9-, 7- and 27-point stencil sparsity patterns.
+ * @remark Matrix must have sizeX * sizeY * sizeZ rows and columns, otherwise "bad_size" is thrown
+ * (whatever NDEBUG is).
+ */
+class StencilPattern {
+public:
+    /* Types */
+
+    enum Stencil {
+        FIVE_POINT,        ///< 2D, neighbours along axes
+        NINE_POINT,        ///< 2D, all neighbours
+        SEVEN_POINT,       ///< 3D, neighbours along axes
+        TWENTY_SEVEN_POINT ///< 3D, all neighbours
+    };
+
+    /* Construct/copy/destruct */
+
+    /**
+     * @param sizeZ Must be 1 for 2D stencils
+     */
+    inline StencilPattern(Stencil stencil, std::size_t sizeX, std::size_t sizeY, std::size_t sizeZ = 1):
+        stencil_(stencil), sizeX_(sizeX), sizeY_(sizeY), sizeZ_(sizeZ) {}
+
+    /* Getters */
+
+    inline Stencil getStencil() const
+    {
+        return stencil_;
+    }
+
+    /**
+     * @return Number of grid points (size of the matrix)
+     */
+    inline std::size_t getPointCount() const
+    {
+        return sizeX_ * sizeY_ * sizeZ_;
+    }
+
+    /* "SparsePattern" interface */
+
+    std::size_t getNonZeroCount(std::size_t size1, std::size_t size2) const
+    {
+        checkSizes_(size1, size2);
+        std::size_t count = 0;
+        for (int dz = -1; dz <= 1; ++dz)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx)
+                    if (isNeighbour_(dx, dy, dz))
+                        count += inner_(sizeX_, dx) * inner_(sizeY_, dy) * inner_(sizeZ_, dz);
+        return count;
+    }
+
+    template<class Engine, class Sink>
+    void generate(Engine&, std::size_t size1, std::size_t size2, Sink& sink) const
+    {
+        checkSizes_(size1, size2);
+        std::size_t row = 0;
+        for (std::size_t z = 0; z < sizeZ_; ++z)
+            for (std::size_t y = 0; y < sizeY_; ++y)
+                for (std::size_t x = 0; x < sizeX_; ++x, ++row)
+                    // Columns ascend as offsets go from z to x
+                    for (int dz = -1; dz <= 1; ++dz)
+                        for (int dy = -1; dy <= 1; ++dy)
+                            for (int dx = -1; dx <= 1; ++dx)
+                                if (isNeighbour_(dx, dy, dz) && isInside_(x, sizeX_, dx) &&
+                                    isInside_(y, sizeY_, dy) && isInside_(z, sizeZ_, dz))
+                                    sink(row, row + (dz * std::ptrdiff_t(sizeY_) + dy) *
+                                                    std::ptrdiff_t(sizeX_) + dx);
+    }
+
+private:
+
+    inline void checkSizes_(std::size_t size1, std::size_t size2) const
+    {
+        if (size1 != getPointCount() || size2 != getPointCount())
+            bad_size().raise();
+    }
+
+    inline bool isNeighbour_(int dx, int dy, int dz) const
+    {
+        int distance = (dx != 0) + (dy != 0) + (dz != 0);
+        switch (stencil_)
+        {
+        case FIVE_POINT:
+            return dz == 0 && distance <= 1;
+        case NINE_POINT:
+            return dz == 0;
+        case SEVEN_POINT:
+            return distance <= 1;
+        default:
+            return true;
+        }
+    }
+
+    inline static bool isInside_(std::size_t coordinate, std::size_t size, int delta)
+    {
+        return delta == 0 || (delta < 0 ? coordinate > 0 : coordinate + 1 < size);
+    }
+
+    /**
+     * @return Number of coordinates whose neighbour at "delta" is inside the grid
+     */
+    inline static std::size_t inner_(std::size_t size, int delta)
+    {
+        return delta == 0 ? size : (size > 0 ? size - 1 : 0);
+    }
+
+    /* Fields */
+
+    Stencil stencil_;
+    std::size_t sizeX_,
+                sizeY_,
+                sizeZ_;
+
+}; //class StencilPattern
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_STENCILPATTERN_H__
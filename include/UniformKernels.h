@@ -0,0 +1,297 @@
+#ifndef __LIBUBLASAUX_UNIFORMKERNELS_H__
+#define __LIBUBLASAUX_UNIFORMKERNELS_H__
+
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CpuFeatures.h"
+#include <cmath>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+
+/**
+ * Kernels turning blocks of raw 32-bit engine output into values of uniform distributions. They
+ * perform exactly the same IEEE operations as the scalar formulas of Boost.Random distributions, so
+ * all code paths (AVX-512, AVX2, scalar) give bit-identical results. Every kernel stops at the first
+ * value the distribution would reject and returns its index; values after it must be ignored. This
+ * class implements "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief SIMD conversion of raw engine output to uniform variates.
+ * @remark Scalar formulas must not be contracted to FMA instructions by the compiler (GCC does not
+ * do it in ISO modes; see -ffp-contract).
+ */
+class UniformKernels {
+public:
+
+    /**
+     * Computes out[k] = x[k] / divisor * range + min and stops at first out[k] that is not less
+     * than "max".
+     * @return Number of accepted values
+     */
+    static std::size_t toReal(const boost::uint32_t* x, double* out, std::size_t count,
+                              double divisor, double range, double min, double max)
+    {
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            return toRealAvx512_(x, out, count, divisor, range, min, max);
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            return toRealAvx2_(x, out, count, divisor, range, min, max);
+#endif
+        return toRealScalar_(x, out, count, divisor, range, min, max);
+    }
+
+    /**
+     * Single precision variant of toReal(const boost::uint32_t*, double*, ...).
+     */
+    static std::size_t toReal(const boost::uint32_t* x, float* out, std::size_t count,
+                              float divisor, float range, float min, float max)
+    {
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            return toRealAvx512_(x, out, count, divisor, range, min, max);
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            return toRealAvx2_(x, out, count, divisor, range, min, max);
+#endif
+        return toRealScalar_(x, out, count, divisor, range, min, max);
+    }
+
+    /**
+     * Computes out[k] = floor(x[k] / bucket) (integer "bucket" method of uniform integer
+     * distributions) and stops at first out[k] greater than "range". Quotients of 32-bit integers are
+     * exact in double precision.
+     * @return Number of accepted values
+     */
+    static std::size_t toIndex(const boost::uint32_t* x, double* out, std::size_t count,
+                               double bucket, double range)
+    {
+#ifdef LIBUBLASAUX_SIMD_X86
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX512)
+            return toIndexAvx512_(x, out, count, bucket, range);
+        if (CpuFeatures::getLevel() >= CpuFeatures::AVX2)
+            return toIndexAvx2_(x, out, count, bucket, range);
+#endif
+        return toIndexScalar_(x, out, count, bucket, range);
+    }
+
+private:
+
+    /*
+     * Scalar kernels (also used for tails of vector ones)
+     */
+
+    template<class Real>
+    static std::size_t toRealScalar_(const boost::uint32_t* x, Real* out, std::size_t count,
+                                     Real divisor, Real range, Real min, Real max)
+    {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            volatile Real scaled = static_cast<Real>(x[k]) / divisor * range; // keeps "+" separate
+            out[k] = scaled + min;
+            if (!(out[k] < max))
+                return k;
+        }
+        return count;
+    }
+
+    static std::size_t toIndexScalar_(const boost::uint32_t* x, double* out, std::size_t count,
+                                      double bucket, double range)
+    {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            out[k] = std::floor(static_cast<double>(x[k]) / bucket);
+            if (out[k] > range)
+                return k;
+        }
+        return count;
+    }
+
+#ifdef LIBUBLASAUX_SIMD_X86
+
+    /*
+     * AVX2 kernels
+     */
+
+    /**
+     * Converts 4 unsigned 32-bit integers to doubles (AVX2 converts only signed ones).
+     */
+    __attribute__((target("avx2")))
+    inline static __m256d unsignedToDouble4_(const boost::uint32_t* x)
+    {
+        __m256d value = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+        __m256d negative = _mm256_cmp_pd(value, _mm256_setzero_pd(), _CMP_LT_OQ);
+        return _mm256_add_pd(value, _mm256_and_pd(negative, _mm256_set1_pd(4294967296.0)));
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t toRealAvx2_(const boost::uint32_t* x, double* out, std::size_t count,
+                                   double divisor, double range, double min, double max)
+    {
+        const __m256d vDivisor = _mm256_set1_pd(divisor),
+                      vRange   = _mm256_set1_pd(range),
+                      vMin     = _mm256_set1_pd(min),
+                      vMax     = _mm256_set1_pd(max);
+        std::size_t k = 0;
+        for (; k + 4 <= count; k += 4)
+        {
+            __m256d value = _mm256_div_pd(unsignedToDouble4_(x + k), vDivisor);
+            value = _mm256_add_pd(_mm256_mul_pd(value, vRange), vMin);
+            _mm256_storeu_pd(out + k, value);
+            int rejected = _mm256_movemask_pd(_mm256_cmp_pd(value, vMax, _CMP_NLT_UQ));
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toRealScalar_(x + k, out + k, count - k, divisor, range, min, max);
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t toRealAvx2_(const boost::uint32_t* x, float* out, std::size_t count,
+                                   float divisor, float range, float min, float max)
+    {
+        const __m256 vDivisor = _mm256_set1_ps(divisor),
+                     vRange   = _mm256_set1_ps(range),
+                     vMin     = _mm256_set1_ps(min),
+                     vMax     = _mm256_set1_ps(max),
+                     vShift   = _mm256_set1_ps(65536.0f);
+        const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            // high * 2^16 is exact, so the sum is rounded once, as by static_cast<float>
+            __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + k));
+            __m256 high = _mm256_cvtepi32_ps(_mm256_srli_epi32(raw, 16)),
+                   low  = _mm256_cvtepi32_ps(_mm256_and_si256(raw, lowMask));
+            __m256 value = _mm256_add_ps(_mm256_mul_ps(high, vShift), low);
+            value = _mm256_div_ps(value, vDivisor);
+            value = _mm256_add_ps(_mm256_mul_ps(value, vRange), vMin);
+            _mm256_storeu_ps(out + k, value);
+            int rejected = _mm256_movemask_ps(_mm256_cmp_ps(value, vMax, _CMP_NLT_UQ));
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toRealScalar_(x + k, out + k, count - k, divisor, range, min, max);
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t toIndexAvx2_(const boost::uint32_t* x, double* out, std::size_t count,
+                                    double bucket, double range)
+    {
+        const __m256d vBucket = _mm256_set1_pd(bucket),
+                      vRange  = _mm256_set1_pd(range);
+        std::size_t k = 0;
+        for (; k + 4 <= count; k += 4)
+        {
+            __m256d value = _mm256_floor_pd(_mm256_div_pd(unsignedToDouble4_(x + k), vBucket));
+            _mm256_storeu_pd(out + k, value);
+            int rejected = _mm256_movemask_pd(_mm256_cmp_pd(value, vRange, _CMP_GT_OQ));
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toIndexScalar_(x + k, out + k, count - k, bucket, range);
+    }
+
+    /*
+     * AVX-512 kernels. AVX-512 implies FMA, so products and sums use explicit rounding in order to
+     * keep the compiler from contracting them
+     */
+
+    static const int ROUNDING_ = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+    // Unmasked AVX-512 intrinsics of GCC start from an "undefined" vector, which makes
+    // -Wmaybe-uninitialized give false warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    __attribute__((target("avx512f")))
+    static std::size_t toRealAvx512_(const boost::uint32_t* x, double* out, std::size_t count,
+                                     double divisor, double range, double min, double max)
+    {
+        const __m512d vDivisor = _mm512_set1_pd(divisor),
+                      vRange   = _mm512_set1_pd(range),
+                      vMin     = _mm512_set1_pd(min),
+                      vMax     = _mm512_set1_pd(max);
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            __m512d value = _mm512_cvtepu32_pd(
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + k)));
+            value = _mm512_div_pd(value, vDivisor);
+            value = _mm512_add_round_pd(_mm512_mul_round_pd(value, vRange, ROUNDING_),
+                                        vMin, ROUNDING_);
+            _mm512_storeu_pd(out + k, value);
+            unsigned rejected = _mm512_cmp_pd_mask(value, vMax, _CMP_NLT_UQ);
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toRealScalar_(x + k, out + k, count - k, divisor, range, min, max);
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t toRealAvx512_(const boost::uint32_t* x, float* out, std::size_t count,
+                                     float divisor, float range, float min, float max)
+    {
+        const __m512 vDivisor = _mm512_set1_ps(divisor),
+                     vRange   = _mm512_set1_ps(range),
+                     vMin     = _mm512_set1_ps(min),
+                     vMax     = _mm512_set1_ps(max);
+        std::size_t k = 0;
+        for (; k + 16 <= count; k += 16)
+        {
+            __m512 value = _mm512_cvtepu32_ps(_mm512_loadu_si512(x + k));
+            value = _mm512_div_ps(value, vDivisor);
+            value = _mm512_add_round_ps(_mm512_mul_round_ps(value, vRange, ROUNDING_),
+                                        vMin, ROUNDING_);
+            _mm512_storeu_ps(out + k, value);
+            unsigned rejected = _mm512_cmp_ps_mask(value, vMax, _CMP_NLT_UQ);
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toRealScalar_(x + k, out + k, count - k, divisor, range, min, max);
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t toIndexAvx512_(const boost::uint32_t* x, double* out, std::size_t count,
+                                      double bucket, double range)
+    {
+        const __m512d vBucket = _mm512_set1_pd(bucket),
+                      vRange  = _mm512_set1_pd(range);
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            __m512d value = _mm512_cvtepu32_pd(
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + k)));
+            value = _mm512_roundscale_pd(_mm512_div_pd(value, vBucket), _MM_FROUND_TO_NEG_INF);
+            _mm512_storeu_pd(out + k, value);
+            unsigned rejected = _mm512_cmp_pd_mask(value, vRange, _CMP_GT_OQ);
+            if (rejected)
+                return k + __builtin_ctz(rejected);
+        }
+        return k + toIndexScalar_(x + k, out + k, count - k, bucket, range);
+    }
+
+#pragma GCC diagnostic pop
+
+#endif //LIBUBLASAUX_SIMD_X86
+
+}; //class UniformKernels
+
+
+}}} //namespace boost::numeric::ublas
+
+#endif //__LIBUBLASAUX_UNIFORMKERNELS_H__
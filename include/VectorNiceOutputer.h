@@ -19,8 +19,10 @@
  */
 
 #include "BaseNiceOutputer.h"
+#include "NiceOutputBuffers.h"
+#include "NumberFormatter.h"
 #include <ostream>
-#include <boost/format.hpp>
+#include <string>
 
 namespace boost { namespace numeric { namespace ublas {
 
@@ -31,6 +33,15 @@ namespace boost { namespace numeric { namespace ublas {
  */
 class VectorNiceOutputer: public BaseNiceOutputer {
 public:
+    /* Types */
+
+    /**
+     * COMPACT outputs only elements the vector stores with their indices: "(2: 1.5, 4: 7)". It
+     * visits them by the vector iterator, so time is proportional to number of non-zeros of sparse
+     * vectors.
+     */
+    enum ElementPlacing { SIMPLE, COMPACT };
+
     /* Construct/copy/destruct */
 
     /**
@@ -38,10 +49,12 @@ public:
      * @param isLineFeedAfterSize If true puts line feed after vector size
      * @param minSpaces Minimal number of spaces adjacent columns (elements) separated by
      * @param isLineFeedAfterAll If true puts line feed after all outputed numbers
+     * @param placing Strategy of elements outputing @see ElementPlacing
      */
     inline explicit VectorNiceOutputer(bool isLineFeedAfterSize, StreamSize minSpaces = 1,
-                                       bool isLineFeedAfterAll = true):
-        BaseNiceOutputer(minSpaces, isLineFeedAfterAll), isLineFeedAfterSize_(isLineFeedAfterSize) {}
+                                       bool isLineFeedAfterAll = true, ElementPlacing placing = SIMPLE):
+        BaseNiceOutputer(minSpaces, isLineFeedAfterAll), isLineFeedAfterSize_(isLineFeedAfterSize),
+        placing_(placing) {}
 
     //TODO: Is it must be virtual or non-virtual?
     inline ~VectorNiceOutputer() {}
@@ -54,6 +67,11 @@ public:
         return isLineFeedAfterSize_;
     }
 
+    inline ElementPlacing getPlacing() const
+    {
+        return placing_;
+    }
+
     /* Real actions */
 
     /**
@@ -63,23 +81,71 @@ public:
      * boost::numeric::ublas library
      */
     template<class Char, class CharTraits, class Vector>
-    void operator()(std::basic_ostream<Char,CharTraits>& output, const Vector& vector) const
+    inline void operator()(std::basic_ostream<Char,CharTraits>& output, const Vector& vector) const
     {
-        typedef boost::basic_format<Char,CharTraits> Format;
-        output << Format("[%1%]") % vector.size();
+        NiceOutputBuffers<Char,CharTraits> buffers;
+        (*this)(output, vector, buffers);
+    }
+
+    /**
+     * Outputs a vectror to the stream in a nice look using memory of given buffers
+     * (@see NiceOutputBuffers).
+     * @param output Output stream
+     * @param vector A vector object to be outputed
+     * @param buffers Scratch buffers
+     */
+    template<class Char, class CharTraits, class Vector>
+    void operator()(std::basic_ostream<Char,CharTraits>& output, const Vector& vector,
+                    NiceOutputBuffers<Char,CharTraits>& buffers) const
+    {
+        /* The first character takes the stream's width */
+        output << Char('[');
+        std::basic_string<Char,CharTraits>& chunk = buffers.chunk_;
+        chunk.clear();
+        appendIndex(chunk, vector.size());
+        chunk += Char(']');
         if (isLineFeedAfterSize())
-            output << "\n";
+            chunk += Char('\n');
 
-        outputRowSimply(output, vector);
+        if (getPlacing() == COMPACT)
+            doStoredElements(output, chunk, vector);
+        else
+            appendRowSimply(output, chunk, NumberFormatter<Char,CharTraits>(output), vector);
 
         if (isLineFeedAfterAll())
-            output << "\n";
+            chunk += Char('\n');
+        flushChunk(output, chunk, true);
     }
 
 private:
+    /* Auxiliary methods */
+
+    template<class Char, class CharTraits, class Vector>
+    void doStoredElements(std::basic_ostream<Char,CharTraits>& output,
+                          std::basic_string<Char,CharTraits>& chunk, const Vector& vector) const
+    {
+        NumberFormatter<Char,CharTraits> formatter(output);
+        chunk += Char('(');
+        for (typename Vector::const_iterator it = vector.begin(); it != vector.end(); ++it)
+        {
+            if (it != vector.begin())
+            {
+                chunk += Char(',');
+                appendSpaces(chunk, getMinSpaces());
+            }
+            appendIndex(chunk, it.index());
+            chunk += Char(':');
+            chunk += Char(' ');
+            formatter.append(chunk, *it);
+            flushChunk(output, chunk);
+        }
+        chunk += Char(')');
+    }
+
     /* Fields */
 
     bool isLineFeedAfterSize_;
+    ElementPlacing placing_;
 
 }; //class VectorNiceOutputer
 
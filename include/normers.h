@@ -18,89 +18,1160 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <boost/numeric/ublas/functional.h>
+#include "ContainerTraits.h"
+#include "NormKernels.h"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/numeric/ublas/traits.hpp>
 
 namespace boost { namespace numeric { namespace ublas {
 
 
-template<class Vector>
-struct VectorComparer1: public vector_norm_1<Vector>
-{
+/**
+ * Accumulator of norm_1 of a difference of two vectors (sum of "norm_1" of elements, as in uBLAS:
+ * |re| + |im| for complex numbers). The sum is split into partial sums the same way as by SIMD
+ * kernels (@see NormKernels), so it does not depend on how the vectors are passed to it.
+ * @author Anton Liaukevich
+ * @brief Accumulator of norm_1 of a difference.
+ * @tparam Value_ Type of elements of the difference
+ */
+template<class Value_>
+class Norm1Accumulator {
+public:
+    /* Types */
+
+    typedef Value_ Value;
+    typedef typename type_traits<Value>::real_type Real;
+
+    /* Construct/copy/destruct */
+
+    inline Norm1Accumulator(): count_(0)
+    {
+        std::fill(lanes_, lanes_ + LANE_COUNT_, Real());
+    }
+
+    /* Real actions */
+
+    inline void accumulate(const Value& difference)
+    {
+        lanes_[count_++ % LANE_COUNT_] += type_traits<Value>::norm_1(difference);
+    }
+
+    /**
+     * Accumulates difference of two contiguous arrays of real numbers (real and imaginary parts of
+     * complex elements).
+     */
+    inline void accumulate(const Real* first1, const Real* first2, std::size_t count)
+    {
+        NormKernels::addAbsDiff(first1, first2, count, lanes_, count_);
+        count_ += count;
+    }
+
+    inline Real getResult() const
+    {
+        return NormKernels::addLanes(lanes_);
+    }
+
+    inline bool isWithin(Real maxDiff) const
+    {
+        return getResult() <= maxDiff;
+    }
+
+    /**
+     * Adds partial sums of another accumulator (of a following part of the vectors) lane by lane.
+     */
+    void merge(const Norm1Accumulator& other)
+    {
+        for (std::size_t k = 0; k < LANE_COUNT_; ++k)
+            lanes_[k] += other.lanes_[k];
+        count_ += other.count_;
+    }
+
+private:
+    /* Constants */
+
+    static const std::size_t LANE_COUNT_ = NormKernels::Lanes<Real>::COUNT;
+
+    /* Fields */
+
+    Real lanes_[LANE_COUNT_];
+    std::size_t count_;
+
+}; //template class Norm1Accumulator
+
+
+/**
+ * Accumulator of norm_2 of a difference of two vectors. Squares are summed as by Norm1Accumulator.
+ * @author Anton Liaukevich
+ * @brief Accumulator of norm_2 of a difference.
+ * @tparam Value_ Type of elements of the difference
+ * @remark Unlike "norm_2" of uBLAS it sums squares without scaling, so differences greater than
+ * sqrt(std::numeric_limits<Real>::max()) give infinity.
+ */
+template<class Value_>
+class Norm2Accumulator {
+public:
+    /* Types */
+
+    typedef Value_ Value;
+    typedef typename type_traits<Value>::real_type Real;
+
+    /* Construct/copy/destruct */
+
+    inline Norm2Accumulator(): count_(0)
+    {
+        std::fill(lanes_, lanes_ + LANE_COUNT_, Real());
+    }
+
+    /* Real actions */
+
+    inline void accumulate(const Value& difference)
+    {
+        Real real = type_traits<Value>::real(difference),
+             imag = type_traits<Value>::imag(difference);
+        lanes_[count_++ % LANE_COUNT_] += real * real + imag * imag;
+    }
+
+    /**
+     * Accumulates difference of two contiguous arrays of real numbers (real and imaginary parts of
+     * complex elements).
+     */
+    inline void accumulate(const Real* first1, const Real* first2, std::size_t count)
+    {
+        NormKernels::addSquaredDiff(first1, first2, count, lanes_, count_);
+        count_ += count;
+    }
+
+    inline Real getResult() const
+    {
+        return type_traits<Real>::type_sqrt(NormKernels::addLanes(lanes_));
+    }
+
+    inline bool isWithin(Real maxDiff) const
+    {
+        return getResult() <= maxDiff;
+    }
+
+    /**
+     * Adds partial sums of another accumulator (of a following part of the vectors) lane by lane.
+     */
+    void merge(const Norm2Accumulator& other)
+    {
+        for (std::size_t k = 0; k < LANE_COUNT_; ++k)
+            lanes_[k] += other.lanes_[k];
+        count_ += other.count_;
+    }
+
+private:
+    /* Constants */
+
+    static const std::size_t LANE_COUNT_ = NormKernels::Lanes<Real>::COUNT;
+
+    /* Fields */
+
+    Real lanes_[LANE_COUNT_];
+    std::size_t count_;
+
+}; //template class Norm2Accumulator
+
+
+/**
+ * Accumulator of norm_inf of a difference of two vectors (maximum of "norm_inf" of elements, as in
+ * uBLAS: max(|re|, |im|) for complex numbers). Unlike "norm_inf" of uBLAS it does not skip NaNs.
+ * @author Anton Liaukevich
+ * @brief Accumulator of norm_inf of a difference.
+ * @tparam Value_ Type of elements of the difference
+ */
+template<class Value_>
+class NormInfAccumulator {
+public:
+    /* Types */
+
+    typedef Value_ Value;
+    typedef typename type_traits<Value>::real_type Real;
+
+    /* Construct/copy/destruct */
+
+    inline NormInfAccumulator(): current_() {}
+
+    /* Real actions */
+
+    inline void accumulate(const Value& difference)
+    {
+        current_ = NormKernels::max(current_, type_traits<Value>::norm_inf(difference));
+    }
+
+    /**
+     * Accumulates difference of two contiguous arrays of real numbers (real and imaginary parts of
+     * complex elements).
+     */
+    inline void accumulate(const Real* first1, const Real* first2, std::size_t count)
+    {
+        current_ = NormKernels::max(current_, NormKernels::maxAbsDiff(first1, first2, count));
+    }
+
+    inline Real getResult() const
+    {
+        return current_;
+    }
+
+    inline bool isWithin(Real maxDiff) const
+    {
+        return current_ <= maxDiff;
+    }
+
+    /**
+     * Takes into account another accumulator (of another part of the vectors).
+     */
+    inline void merge(const NormInfAccumulator& other)
+    {
+        current_ = NormKernels::max(current_, other.current_);
+    }
+
+private:
+    /* Fields */
+
+    Real current_;
+
+}; //template class NormInfAccumulator
+
+
+/**
+ * "DispatchComparer" strategy good implementation. Differences of dense vectors and matrices with
+ * contiguous storage ("vector", "bounded_vector", "c_vector", "matrix" and "bounded_matrix" of the
+ * same orientation) of the same float, double or complex type are accumulated by SIMD kernels
+ * (@see NormKernels) straight from their storage. Two "compressed_vector"s and two
+ * "compressed_matrix"es of the same orientation are compared by a linear merge of their index
+ * arrays: elements stored in only one of them are compared with zero and elements stored in
+ * neither are skipped. A compressed container compared with a contiguous dense one walks its index
+ * arrays along with the dense elements instead of searching every element. Other vectors, matrices
+ * and expressions are accumulated element by element (matrices row by row). This class implements
+ * "Monostate" pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief "DispatchComparer" strategy good implementation
+ */
+class StdDispatchComparer {
+    friend class ParallelDispatchComparer;
+
+private:
+    /* Types */
 
-    class NormAccumulator: public vector_scalar_real_unary_functor<V> {
-    public:
+    /*
+     * Storage categories of containers (@see Dispatch_)
+     */
 
-        inline result_type getCurrent()
+    struct Generic_ {};
+    struct Contiguous_ {};
+    struct Compressed_ {};
+
+    /**
+     * Dispatchering class. It tells by traits of a container (@see ContainerTraits) how it keeps
+     * its elements: "Contiguous_" (dense) containers in one array (@see getData), "Compressed_"
+     * ones in arrays of sorted indices and of values.
+     */
+    template<class Container, class Traits = ContainerTraits<Container> >
+    struct Dispatch_ {
+        typedef typename mpl::if_c<is_same<typename Traits::Shape,DenseShape>::value &&
+                                   Traits::IS_CONTIGUOUS,
+                                   Contiguous_,
+                                   typename mpl::if_c<Traits::IS_COMPRESSED,
+                                                      Compressed_,
+                                                      Generic_>::type>::type Category;
+        typedef typename Traits::Orientation OrientationType;
+        static const std::size_t INDEX_BASE = Traits::INDEX_BASE;
+
+        template<class Contiguous>
+        inline static const typename Contiguous::value_type* getData(const Contiguous& container)
         {
-            return current;
+            return &container.data()[0];
         }
+    };
+
+    /**
+     * Number of real numbers an element consists of, if SIMD kernels support it.
+     */
+    template<class Value>
+    struct Reals_ {
+        static const std::size_t COUNT = 0;
+    };
+
+    /*
+     * Cursors walking through elements of two containers. Every cursor has type "Position" (of an
+     * element), methods "isEnd()", "getEnd()" (position after the last element) and
+     * "accumulate(accumulator, count)", which accumulates difference of next "count" elements (or
+     * of all the rest) and returns position of the last of them. Cursors with IS_SEEKABLE flag also
+     * have "getCount()" (number of elements) and "seek(number)" (to go to any element)
+     */
+
+    template<class E1, class E2>
+    class ElementCursor_;
+
+    template<class E1, class E2>
+    class ContiguousCursor_;
+
+    template<class E1, class E2>
+    class ContiguousMatrixCursor_;
+
+    template<class E1, class E2>
+    class CompressedCursor_;
+
+    template<class E1, class E2>
+    class MatrixElementCursor_;
+
+    template<class E1, class E2>
+    class CompressedMatrixCursor_;
 
-        inline void accumulate(const value_type& item)
+    template<class E1, class E2>
+    class CompressedDenseCursor_;
+
+    template<class E1, class E2>
+    class CompressedDenseMatrixCursor_;
+
+    /**
+     * Cursor used for two vector types.
+     */
+    template<
+             class Accumulator, class E1, class E2,
+             class Category1 = typename Dispatch_<E1>::Category,
+             class Category2 = typename Dispatch_<E2>::Category
+            >
+    struct VectorCursor_ {
+        typedef ElementCursor_<E1,E2> Answer;
+    };
+
+    /**
+     * Cursor used for two matrix types.
+     */
+    template<
+             class Accumulator, class E1, class E2,
+             class Category1 = typename Dispatch_<E1>::Category,
+             class Category2 = typename Dispatch_<E2>::Category
+            >
+    struct MatrixCursor_ {
+        typedef MatrixElementCursor_<E1,E2> Answer;
+    };
+
+public:
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer: accumulates difference of two
+     * vectors of the same size.
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static void accumulate(Accumulator& accumulator, const vector_expression<E1>& vector1,
+                                  const vector_expression<E2>& vector2)
+    {
+        BOOST_UBLAS_CHECK(vector1().size() == vector2().size(), bad_size());
+        typename VectorCursor_<Accumulator,E1,E2>::Answer cursor(vector1(), vector2());
+        cursor.accumulate(accumulator, std::numeric_limits<std::size_t>::max());
+    }
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer: accumulates difference of two
+     * matrices of the same sizes.
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static void accumulate(Accumulator& accumulator, const matrix_expression<E1>& matrix1,
+                                  const matrix_expression<E2>& matrix2)
+    {
+        BOOST_UBLAS_CHECK(matrix1().size1() == matrix2().size1(), bad_size());
+        BOOST_UBLAS_CHECK(matrix1().size2() == matrix2().size2(), bad_size());
+        typename MatrixCursor_<Accumulator,E1,E2>::Answer cursor(matrix1(), matrix2());
+        cursor.accumulate(accumulator, std::numeric_limits<std::size_t>::max());
+    }
+
+    /**
+     * Dispatching function callable from RoughlyVectorComparer: accumulates difference of two
+     * vectors of the same size by blocks and stops at the first block after which the accumulated
+     * norm exceeds "maxDiff".
+     * @return Index of the first element at which the accumulated norm exceeds "maxDiff" or size of
+     * the vectors if it never does
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static std::size_t findExcess(Accumulator& accumulator,
+                                         const vector_expression<E1>& vector1,
+                                         const vector_expression<E2>& vector2,
+                                         typename Accumulator::Real maxDiff)
+    {
+        BOOST_UBLAS_CHECK(vector1().size() == vector2().size(), bad_size());
+        typename VectorCursor_<Accumulator,E1,E2>::Answer cursor(vector1(), vector2());
+        return findExcess_(accumulator, cursor, maxDiff);
+    }
+
+    /**
+     * Matrix variant of findExcess(Accumulator&, const vector_expression<E1>&, ...).
+     * @return Indices of the first element (in order of accumulating) at which the accumulated norm
+     * exceeds "maxDiff" or sizes of the matrices if it never does
+     */
+    template<class Accumulator, class E1, class E2>
+    inline static std::pair<std::size_t,std::size_t>
+    findExcess(Accumulator& accumulator, const matrix_expression<E1>& matrix1,
+               const matrix_expression<E2>& matrix2, typename Accumulator::Real maxDiff)
+    {
+        BOOST_UBLAS_CHECK(matrix1().size1() == matrix2().size1(), bad_size());
+        BOOST_UBLAS_CHECK(matrix1().size2() == matrix2().size2(), bad_size());
+        typename MatrixCursor_<Accumulator,E1,E2>::Answer cursor(matrix1(), matrix2());
+        return findExcess_(accumulator, cursor, maxDiff);
+    }
+
+private:
+
+    template<class Accumulator, class Cursor>
+    static typename Cursor::Position findExcess_(Accumulator& accumulator, Cursor& cursor,
+                                                 typename Accumulator::Real maxDiff)
+    {
+        while (!cursor.isEnd())
         {
-            current += type_traits<value_type>::type_abs(item);
+            Accumulator blockStart(accumulator);
+            Cursor cursorStart(cursor);
+            cursor.accumulate(accumulator, BLOCK_SIZE_);
+            if (accumulator.isWithin(maxDiff))
+                continue;
+
+            // Accumulated norms never decrease, so replaying the block finds the element
+            accumulator = blockStart;
+            cursor = cursorStart;
+            for (;;)
+            {
+                typename Cursor::Position position = cursor.accumulate(accumulator, 1);
+                if (!accumulator.isWithin(maxDiff) || cursor.isEnd())
+                    return position;
+            }
         }
+        return cursor.getEnd();
+    }
 
-    private:
+    /**
+     * Whether SIMD kernels can accumulate difference of contiguous storage of two containers.
+     */
+    template<class Accumulator, class E1, class E2>
+    struct IsKernelFriendly_ {
+        typedef typename E1::value_type Value;
+        static const bool VALUE = is_same<Value,typename E2::value_type>::value &&
+                                  is_same<Value,typename Accumulator::Value>::value &&
+                                  Reals_<Value>::COUNT != 0;
+    };
 
-        real_type current;
+    template<class Accumulator, class E1, class E2>
+    struct VectorCursor_<Accumulator,E1,E2,Contiguous_,Contiguous_> {
+        typedef typename mpl::if_c<IsKernelFriendly_<Accumulator,E1,E2>::VALUE,
+                                   ContiguousCursor_<E1,E2>,
+                                   ElementCursor_<E1,E2> >::type Answer;
     };
 
-/*
-    template<class E>
-    bool roughlyCompare(const vector_expression<E>& vector1, const vector_expression<E>& vector2)
+    template<class Accumulator, class E1, class E2>
+    struct MatrixCursor_<Accumulator,E1,E2,Contiguous_,Contiguous_> {
+        typedef typename mpl::if_c<IsKernelFriendly_<Accumulator,E1,E2>::VALUE &&
+                                   is_same<typename Dispatch_<E1>::OrientationType,
+                                           typename Dispatch_<E2>::OrientationType>::value,
+                                   ContiguousMatrixCursor_<E1,E2>,
+                                   MatrixElementCursor_<E1,E2> >::type Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct VectorCursor_<Accumulator,E1,E2,Compressed_,Compressed_> {
+        typedef CompressedCursor_<E1,E2> Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct MatrixCursor_<Accumulator,E1,E2,Compressed_,Compressed_> {
+        typedef typename mpl::if_c<is_same<typename Dispatch_<E1>::OrientationType,
+                                           typename Dispatch_<E2>::OrientationType>::value,
+                                   CompressedMatrixCursor_<E1,E2>,
+                                   MatrixElementCursor_<E1,E2> >::type Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct VectorCursor_<Accumulator,E1,E2,Compressed_,Contiguous_> {
+        typedef CompressedDenseCursor_<E1,E2> Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct VectorCursor_<Accumulator,E1,E2,Contiguous_,Compressed_> {
+        typedef CompressedDenseCursor_<E1,E2> Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct MatrixCursor_<Accumulator,E1,E2,Compressed_,Contiguous_> {
+        typedef CompressedDenseMatrixCursor_<E1,E2> Answer;
+    };
+
+    template<class Accumulator, class E1, class E2>
+    struct MatrixCursor_<Accumulator,E1,E2,Contiguous_,Compressed_> {
+        typedef CompressedDenseMatrixCursor_<E1,E2> Answer;
+    };
+
+    /* Constants */
+
+    /**
+     * Number of elements findExcess accumulates between checks of the norm.
+     */
+    static const std::size_t BLOCK_SIZE_ = 4096;
+
+}; //class StdDispatchComparer
+
+
+template<>
+struct StdDispatchComparer::Reals_<float> {
+    static const std::size_t COUNT = 1;
+};
+
+template<>
+struct StdDispatchComparer::Reals_<double> {
+    static const std::size_t COUNT = 1;
+};
+
+template<>
+struct StdDispatchComparer::Reals_< std::complex<float> > {
+    static const std::size_t COUNT = 2;
+};
+
+template<>
+struct StdDispatchComparer::Reals_< std::complex<double> > {
+    static const std::size_t COUNT = 2;
+};
+
+
+/**
+ * Cursor through all elements of two vectors.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::ElementCursor_ {
+public:
+    typedef std::size_t Position;
+
+    static const bool IS_SEEKABLE = false;
+
+    inline ElementCursor_(const E1& vector1, const E2& vector2):
+        vector1_(&vector1), vector2_(&vector2), position_(0) {}
+
+    inline bool isEnd() const
+    {
+        return position_ == vector1_->size();
+    }
+
+    inline Position getEnd() const
+    {
+        return vector1_->size();
+    }
+
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
     {
+        typedef typename Accumulator::Value Value;
+        std::size_t last = position_ + std::min(count, vector1_->size() - position_);
+        for (; position_ < last; ++position_)
+            accumulator.accumulate(Value((*vector1_)(position_)) - Value((*vector2_)(position_)));
+        return position_ - 1;
     }
-*/
+
+private:
+    const E1* vector1_;
+    const E2* vector2_;
+    std::size_t position_;
 };
 
 
-template<
-         template<class> class NormAccumulator,
-         template<class> class DispatchComparer = DispatchComparer
-        >
-struct RoughlyVectorComparer: protected StdDispatchComparer {
+/**
+ * Cursor through contiguous storage of two vectors passing it to SIMD kernels.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::ContiguousCursor_ {
+public:
+    typedef std::size_t Position;
+    typedef typename E1::value_type Value;
+    typedef typename type_traits<Value>::real_type Real;
 
-    template<class E>
-    inline static
-    bool compare(const vector_expression<E>& vector1, const vector_expression<E>& vector2,
-                 typename type_traits<typename E::value_type>::real_type maxDiff)
+    static const bool IS_SEEKABLE = true;
+
+    inline ContiguousCursor_(const E1& vector1, const E2& vector2):
+        data1_(getData_(vector1, vector1.size())), data2_(getData_(vector2, vector2.size())),
+        position_(0), count_(vector1.size()) {}
+
+    inline bool isEnd() const
     {
-        doCompare(vector1, vector2, maxDiff)
+        return position_ == count_;
     }
 
-};
+    inline Position getEnd() const
+    {
+        return count_;
+    }
+
+    inline std::size_t getCount() const
+    {
+        return count_;
+    }
 
+    inline void seek(std::size_t number)
+    {
+        position_ = number;
+    }
 
-class StdDispatchComparer {
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        const std::size_t reals = Reals_<Value>::COUNT;
+        count = std::min(count, count_ - position_);
+        accumulator.accumulate(data1_ + position_ * reals, data2_ + position_ * reals,
+                               count * reals);
+        position_ += count;
+        return position_ - 1;
+    }
+
+protected:
+
+    inline ContiguousCursor_(const E1& container1, const E2& container2, std::size_t count):
+        data1_(getData_(container1, count)), data2_(getData_(container2, count)),
+        position_(0), count_(count) {}
+
+private:
 
     template<class Container>
-    struct Dispatch_ {};
+    inline static const Real* getData_(const Container& container, std::size_t count)
+    {
+        return count ? reinterpret_cast<const Real*>(Dispatch_<Container>::getData(container)) : 0;
+    }
+
+    const Real* data1_;
+    const Real* data2_;
+    std::size_t position_, count_;
+};
+
+
+/**
+ * Cursor through contiguous storage of two matrices of the same orientation passing it to SIMD
+ * kernels.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::ContiguousMatrixCursor_: public ContiguousCursor_<E1,E2> {
+public:
+    typedef std::pair<std::size_t,std::size_t> Position;
+    typedef typename Dispatch_<E1>::OrientationType Orientation;
+
+    inline ContiguousMatrixCursor_(const E1& matrix1, const E2& matrix2):
+        ContiguousCursor_<E1,E2>(matrix1, matrix2, matrix1.size1() * matrix1.size2()),
+        size1_(matrix1.size1()), size2_(matrix1.size2()) {}
+
+    inline Position getEnd() const
+    {
+        return Position(size1_, size2_);
+    }
+
+    template<class Accumulator>
+    inline Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        std::size_t number = ContiguousCursor_<E1,E2>::accumulate(accumulator, count);
+        std::size_t minorCount = Orientation::size_m(size1_, size2_);
+        std::size_t major = number / minorCount, minor = number % minorCount;
+        return Position(Orientation::index_M(major, minor), Orientation::index_m(major, minor));
+    }
+
+private:
+    std::size_t size1_, size2_;
+};
+
+
+/**
+ * Cursor merging stored elements of two compressed vectors.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::CompressedCursor_ {
+public:
+    typedef std::size_t Position;
+
+    static const bool IS_SEEKABLE = false;
+
+    inline CompressedCursor_(const E1& vector1, const E2& vector2):
+        vector1_(&vector1), vector2_(&vector2), position1_(0), position2_(0) {}
+
+    inline bool isEnd() const
+    {
+        return position1_ == vector1_->filled() && position2_ == vector2_->filled();
+    }
+
+    inline Position getEnd() const
+    {
+        return vector1_->size();
+    }
+
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        typedef typename Accumulator::Value Value;
+        const std::size_t filled1 = vector1_->filled(), filled2 = vector2_->filled();
+        std::size_t index = 0;
+        for (; count > 0 && !isEnd(); --count)
+        {
+            std::size_t index1 = position1_ < filled1 ?
+                                 vector1_->index_data()[position1_] - Dispatch_<E1>::INDEX_BASE :
+                                 vector1_->size();
+            std::size_t index2 = position2_ < filled2 ?
+                                 vector2_->index_data()[position2_] - Dispatch_<E2>::INDEX_BASE :
+                                 vector2_->size();
+            index = std::min(index1, index2);
+            Value value1 = index1 == index ? Value(vector1_->value_data()[position1_++]) : Value();
+            Value value2 = index2 == index ? Value(vector2_->value_data()[position2_++]) : Value();
+            accumulator.accumulate(value1 - value2);
+        }
+        return index;
+    }
+
+private:
+    const E1* vector1_;
+    const E2* vector2_;
+    std::size_t position1_, position2_;
+};
+
+
+/**
+ * Cursor through all elements of two matrices row by row.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::MatrixElementCursor_ {
+public:
+    typedef std::pair<std::size_t,std::size_t> Position;
+
+    static const bool IS_SEEKABLE = false;
+
+    inline MatrixElementCursor_(const E1& matrix1, const E2& matrix2):
+        matrix1_(&matrix1), matrix2_(&matrix2), i_(0), j_(0)
+    {
+        if (matrix1.size2() == 0)
+            i_ = matrix1.size1();
+    }
+
+    inline bool isEnd() const
+    {
+        return i_ == matrix1_->size1();
+    }
+
+    inline Position getEnd() const
+    {
+        return Position(matrix1_->size1(), matrix1_->size2());
+    }
+
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        typedef typename Accumulator::Value Value;
+        Position last;
+        for (; count > 0 && !isEnd(); --count)
+        {
+            accumulator.accumulate(Value((*matrix1_)(i_, j_)) - Value((*matrix2_)(i_, j_)));
+            last = Position(i_, j_);
+            if (++j_ == matrix1_->size2())
+            {
+                j_ = 0;
+                ++i_;
+            }
+        }
+        return last;
+    }
+
+private:
+    const E1* matrix1_;
+    const E2* matrix2_;
+    std::size_t i_, j_;
+};
+
+
+/**
+ * Cursor merging stored elements of two compressed matrices of the same orientation major by major.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::CompressedMatrixCursor_ {
+public:
+    typedef std::pair<std::size_t,std::size_t> Position;
+
+    static const bool IS_SEEKABLE = false;
+    typedef typename Dispatch_<E1>::OrientationType Orientation;
+
+    inline CompressedMatrixCursor_(const E1& matrix1, const E2& matrix2):
+        matrix1_(&matrix1), matrix2_(&matrix2),
+        majorCount_(Orientation::size_M(matrix1.size1(), matrix1.size2())),
+        minorCount_(Orientation::size_m(matrix1.size1(), matrix1.size2())), major_(0)
+    {
+        startMajor_();
+    }
+
+    inline bool isEnd() const
+    {
+        return major_ == majorCount_;
+    }
+
+    inline Position getEnd() const
+    {
+        return Position(matrix1_->size1(), matrix1_->size2());
+    }
+
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        typedef typename Accumulator::Value Value;
+        std::size_t minor = 0, major = major_;
+        for (; count > 0 && !isEnd(); --count)
+        {
+            std::size_t minor1 = position1_ < last1_ ?
+                                 matrix1_->index2_data()[position1_] - Dispatch_<E1>::INDEX_BASE :
+                                 minorCount_;
+            std::size_t minor2 = position2_ < last2_ ?
+                                 matrix2_->index2_data()[position2_] - Dispatch_<E2>::INDEX_BASE :
+                                 minorCount_;
+            minor = std::min(minor1, minor2);
+            major = major_;
+            Value value1 = minor1 == minor ? Value(matrix1_->value_data()[position1_++]) : Value();
+            Value value2 = minor2 == minor ? Value(matrix2_->value_data()[position2_++]) : Value();
+            accumulator.accumulate(value1 - value2);
+            if (position1_ == last1_ && position2_ == last2_)
+            {
+                ++major_;
+                startMajor_();
+            }
+        }
+        return Position(Orientation::index_M(major, minor), Orientation::index_m(major, minor));
+    }
+
+private:
+
+    /**
+     * Skips majors having no stored elements in both matrices.
+     */
+    void startMajor_()
+    {
+        for (; major_ < majorCount_; ++major_)
+        {
+            getRange_(*matrix1_, Dispatch_<E1>::INDEX_BASE, position1_, last1_);
+            getRange_(*matrix2_, Dispatch_<E2>::INDEX_BASE, position2_, last2_);
+            if (position1_ < last1_ || position2_ < last2_)
+                return;
+        }
+    }
+
+    /**
+     * Gets range of stored elements of the current major in arrays of a matrix (only "filled1"
+     * first elements of its "index1_data" are valid).
+     */
+    template<class Matrix>
+    void getRange_(const Matrix& matr, std::size_t indexBase, std::size_t& first,
+                   std::size_t& last) const
+    {
+        if (major_ + 1 < matr.filled1())
+        {
+            first = matr.index1_data()[major_] - indexBase;
+            last = matr.index1_data()[major_ + 1] - indexBase;
+        }
+        else
+            first = last = 0;
+    }
+
+    const E1* matrix1_;
+    const E2* matrix2_;
+    std::size_t majorCount_, minorCount_, major_;
+    std::size_t position1_, last1_, position2_, last2_;
+};
+
 
+/**
+ * Cursor through all elements of a compressed vector and a contiguous dense one (in either order).
+ * Stored elements of the compressed vector are taken by walking its index array along with the
+ * dense elements, so the work is O(n + nnz) instead of O(n log nnz).
+ */
+template<class E1, class E2>
+class StdDispatchComparer::CompressedDenseCursor_ {
 public:
+    typedef std::size_t Position;
 
-    bool compare(const vector_expression<E>& vector1, const vector_expression<E>& vector2,
-                 typename type_traits<typename E::value_type>::real_type maxDiff)
+    static const bool IS_SEEKABLE = false;
+
+    inline CompressedDenseCursor_(const E1& vector1, const E2& vector2):
+        vector1_(&vector1), vector2_(&vector2), position_(0), stored_(0) {}
+
+    inline bool isEnd() const
+    {
+        return position_ == vector1_->size();
+    }
+
+    inline Position getEnd() const
     {
-        Dispatch_<E>::compare(vector1, vector2, maxDiff);
+        return vector1_->size();
     }
 
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        typedef typename Accumulator::Value Value;
+        std::size_t last = position_ + std::min(count, vector1_->size() - position_);
+        for (; position_ < last; ++position_)
+        {
+            Value value1 = take_<Value>(*vector1_, typename Dispatch_<E1>::Category());
+            Value value2 = take_<Value>(*vector2_, typename Dispatch_<E2>::Category());
+            accumulator.accumulate(value1 - value2);
+        }
+        return position_ - 1;
+    }
 
+private:
 
+    template<class Value, class Vector>
+    inline Value take_(const Vector& vect, Contiguous_) const
+    {
+        return Value(vect.data()[position_]);
+    }
+
+    template<class Value, class Vector>
+    inline Value take_(const Vector& vect, Compressed_)
+    {
+        if (stored_ < vect.filled() &&
+            vect.index_data()[stored_] - Dispatch_<Vector>::INDEX_BASE == position_)
+            return Value(vect.value_data()[stored_++]);
+        return Value();
+    }
+
+    const E1* vector1_;
+    const E2* vector2_;
+    std::size_t position_, stored_;
+};
+
+
+/**
+ * Cursor through all elements of a compressed matrix and a contiguous dense one (in either order)
+ * major by major of the compressed matrix, taking its stored elements as CompressedDenseCursor_
+ * does.
+ */
+template<class E1, class E2>
+class StdDispatchComparer::CompressedDenseMatrixCursor_ {
+public:
+    typedef std::pair<std::size_t,std::size_t> Position;
+
+    static const bool IS_SEEKABLE = false;
+    typedef typename mpl::if_c<is_same<typename Dispatch_<E1>::Category,Compressed_>::value,
+                               E1, E2>::type Compressed;
+    typedef typename Dispatch_<Compressed>::OrientationType Orientation;
+
+    inline CompressedDenseMatrixCursor_(const E1& matrix1, const E2& matrix2):
+        matrix1_(&matrix1), matrix2_(&matrix2),
+        compressed_(&getCompressed_(matrix1, matrix2, typename Dispatch_<E1>::Category())),
+        majorCount_(Orientation::size_M(matrix1.size1(), matrix1.size2())),
+        minorCount_(Orientation::size_m(matrix1.size1(), matrix1.size2())), major_(0), minor_(0)
+    {
+        if (minorCount_ == 0)
+            major_ = majorCount_;
+        startMajor_();
+    }
+
+    inline bool isEnd() const
+    {
+        return major_ == majorCount_;
+    }
+
+    inline Position getEnd() const
+    {
+        return Position(matrix1_->size1(), matrix1_->size2());
+    }
+
+    template<class Accumulator>
+    Position accumulate(Accumulator& accumulator, std::size_t count)
+    {
+        typedef typename Accumulator::Value Value;
+        Position last;
+        for (; count > 0 && !isEnd(); --count)
+        {
+            std::size_t i = Orientation::index_M(major_, minor_),
+                        j = Orientation::index_m(major_, minor_);
+            Value stored = Value();
+            if (stored_ < last_ &&
+                compressed_->index2_data()[stored_] - Dispatch_<Compressed>::INDEX_BASE == minor_)
+                stored = Value(compressed_->value_data()[stored_++]);
+            Value value1 = take_<Value>(*matrix1_, i, j, stored,
+                                        typename Dispatch_<E1>::Category());
+            Value value2 = take_<Value>(*matrix2_, i, j, stored,
+                                        typename Dispatch_<E2>::Category());
+            accumulator.accumulate(value1 - value2);
+            last = Position(i, j);
+            if (++minor_ == minorCount_)
+            {
+                minor_ = 0;
+                ++major_;
+                startMajor_();
+            }
+        }
+        return last;
+    }
 
 private:
 
-    template<class Item, class Storage>
-    struct Dispatch_< vector<Item,Storage> > {
+    inline static const Compressed& getCompressed_(const E1& matrix1, const E2&, Compressed_)
+    {
+        return matrix1;
+    }
+
+    inline static const Compressed& getCompressed_(const E1&, const E2& matrix2, Contiguous_)
+    {
+        return matrix2;
+    }
+
+    template<class Value, class Matrix>
+    inline static Value take_(const Matrix& matr, std::size_t i, std::size_t j, const Value&,
+                              Contiguous_)
+    {
+        return Value(matr(i, j));
+    }
+
+    template<class Value, class Matrix>
+    inline static Value take_(const Matrix&, std::size_t, std::size_t, const Value& stored,
+                              Compressed_)
+    {
+        return stored;
+    }
 
-        static
-        bool compare(const vector_expression<E>& vector1, const vector_expression<E>& vector2,
-                     typename type_traits<typename E::value_type>::real_type maxDiff)
+    /**
+     * Gets range of stored elements of the current major (only "filled1" first elements of
+     * "index1_data" are valid).
+     */
+    void startMajor_()
+    {
+        std::size_t indexBase = Dispatch_<Compressed>::INDEX_BASE;
+        if (major_ + 1 < compressed_->filled1())
         {
-            FullRandomizer_::randomizeVector(vect, engine, itemDist);
+            stored_ = compressed_->index1_data()[major_] - indexBase;
+            last_ = compressed_->index1_data()[major_ + 1] - indexBase;
         }
+        else
+            stored_ = last_ = 0;
+    }
+
+    const E1* matrix1_;
+    const E2* matrix2_;
+    const Compressed* compressed_;
+    std::size_t majorCount_, minorCount_, major_, minor_;
+    std::size_t stored_, last_;
+};
+
+
+/**
+ * Strategy-driven functor telling whether two vectors (or matrices) are roughly equal: whether a
+ * norm of their difference does not exceed "maxDiff". It is faster than
+ * "norm_inf(vector1 - vector2) <= maxDiff" and friends because it accumulates the norm in one pass
+ * without expression templates. Matrices are compared as vectors of their elements (so norm_2 is
+ * the Frobenius norm, and norm_1 and norm_inf are not the operator norms uBLAS computes for
+ * matrices).
+ * A NaN element of the difference makes containers unequal. This template implements "Monostate"
+ * pattern (only static methods).
+ * @author Anton Liaukevich
+ * @brief Comparison of vectors and matrices within a tolerance.
+ * @tparam NormAccumulator Norm of the difference: "Norm1Accumulator", "Norm2Accumulator" or
+ * "NormInfAccumulator" (class templates taking type of elements)
+ * @tparam DispatchComparer Strategy used to dispatch accumulating to partial specializations in
+ * order to implement different behaviour for different container types. Default strategy
+ * "StdDispatchComparer" supports all vector and matrix types and expressions.
+ */
+template<
+         template<class> class NormAccumulator,
+         class DispatchComparer = StdDispatchComparer
+        >
+struct RoughlyVectorComparer: protected DispatchComparer {
+
+    /* Types */
+
+    /**
+     * Accumulator used for two vector (or matrix) types.
+     */
+    template<class E1, class E2>
+    struct Accumulator {
+        typedef typename promote_traits<typename E1::value_type,
+                                        typename E2::value_type>::promote_type Value;
+        typedef NormAccumulator<Value> Answer;
     };
 
-}; //class StdDispatchComparer
+    /* Real actions */
+
+    /**
+     * @return Norm of difference of two vectors of the same size
+     */
+    template<class E1, class E2>
+    static typename Accumulator<E1,E2>::Answer::Real
+    getDistance(const vector_expression<E1>& vector1, const vector_expression<E2>& vector2)
+    {
+        typename Accumulator<E1,E2>::Answer accumulator;
+        DispatchComparer::accumulate(accumulator, vector1, vector2);
+        return accumulator.getResult();
+    }
+
+    /**
+     * @return Norm of difference of two matrices of the same sizes
+     */
+    template<class E1, class E2>
+    static typename Accumulator<E1,E2>::Answer::Real
+    getDistance(const matrix_expression<E1>& matrix1, const matrix_expression<E2>& matrix2)
+    {
+        typename Accumulator<E1,E2>::Answer accumulator;
+        DispatchComparer::accumulate(accumulator, matrix1, matrix2);
+        return accumulator.getResult();
+    }
+
+    /**
+     * Finds the first element at which norm of difference of leading elements of two vectors of the
+     * same size exceeds "maxDiff". Stops soon after it: for norm_inf it is the first element whose
+     * difference exceeds "maxDiff", for other norms the one at which their partial sum passes it.
+     * @return Index of the element or size of the vectors if norm of their difference does not
+     * exceed "maxDiff"
+     */
+    template<class E1, class E2>
+    static std::size_t findExcess(const vector_expression<E1>& vector1,
+                                  const vector_expression<E2>& vector2,
+                                  typename Accumulator<E1,E2>::Answer::Real maxDiff)
+    {
+        typename Accumulator<E1,E2>::Answer accumulator;
+        return DispatchComparer::findExcess(accumulator, vector1, vector2, maxDiff);
+    }
+
+    /**
+     * Matrix variant of findExcess(const vector_expression<E1>&, ...). Elements are taken in order
+     * the strategy accumulates them (row by row or in order of storage of compressed matrices).
+     * @return Indices of the element or sizes of the matrices if norm of their difference does not
+     * exceed "maxDiff"
+     */
+    template<class E1, class E2>
+    static std::pair<std::size_t,std::size_t>
+    findExcess(const matrix_expression<E1>& matrix1, const matrix_expression<E2>& matrix2,
+               typename Accumulator<E1,E2>::Answer::Real maxDiff)
+    {
+        typename Accumulator<E1,E2>::Answer accumulator;
+        return DispatchComparer::findExcess(accumulator, matrix1, matrix2, maxDiff);
+    }
+
+    /**
+     * @return true if norm of difference of two vectors of the same size does not exceed "maxDiff"
+     * (the same as "getDistance(vector1, vector2) <= maxDiff", but stops as soon as the answer is
+     * known)
+     */
+    template<class E1, class E2>
+    inline static
+    bool compare(const vector_expression<E1>& vector1, const vector_expression<E2>& vector2,
+                 typename Accumulator<E1,E2>::Answer::Real maxDiff)
+    {
+        return findExcess(vector1, vector2, maxDiff) == vector1().size();
+    }
+
+    /**
+     * @return true if norm of difference of two matrices of the same sizes does not exceed
+     * "maxDiff"
+     */
+    template<class E1, class E2>
+    inline static
+    bool compare(const matrix_expression<E1>& matrix1, const matrix_expression<E2>& matrix2,
+                 typename Accumulator<E1,E2>::Answer::Real maxDiff)
+    {
+        return findExcess(matrix1, matrix2, maxDiff).first == matrix1().size1();
+    }
+
+}; //template class RoughlyVectorComparer
 
 
 }}} //namespace boost::numeric::ublas
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BinarySerializer.h"
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <boost/cstdint.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/numeric/ublas/banded.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/numeric/ublas/vector_sparse.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+
+/**
+ * Banded matrices of any shape are read back as written (non-square ones used to set "failbit").
+ */
+template<class Orientation>
+void testBandedRoundTrip(std::size_t size1, std::size_t size2, std::size_t lower, std::size_t upper)
+{
+    typedef banded_matrix<double,Orientation> Matrix;
+    Matrix written(size1, size2, lower, upper);
+    for (std::size_t i = 0; i < size1; ++i)
+        for (std::size_t j = 0; j < size2; ++j)
+            if (j + lower >= i && j <= i + upper)
+                written(i, j) = double(i * size2 + j + 1);
+
+    std::stringstream stream;
+    BinarySerializer::write(stream, written);
+    Matrix read(2, 3, 0, 1);
+    BinarySerializer::read(stream, read);
+
+    BOOST_TEST(!stream.fail());
+    BOOST_TEST_EQ(read.size1(), size1);
+    BOOST_TEST_EQ(read.size2(), size2);
+    BOOST_TEST_EQ(read.lower(), lower);
+    BOOST_TEST_EQ(read.upper(), upper);
+    // Const access yields zero outside the band, while the non-const one throws "bad_index"
+    const Matrix& constRead = read;
+    const Matrix& constWritten = written;
+    for (std::size_t i = 0; i < size1; ++i)
+        for (std::size_t j = 0; j < size2; ++j)
+            BOOST_TEST_EQ(constRead(i, j), constWritten(i, j));
+}
+
+/**
+ * Overwrites a size field of a serialized header: 0 for "size1", 1 for "size2", ..., 5 for "count2".
+ */
+std::string forgeSize(const std::string& bytes, std::size_t field, boost::uint64_t value)
+{
+    std::string forged = bytes;
+    std::memcpy(&forged[24 + field * sizeof(value)], &value, sizeof(value));
+    return forged;
+}
+
+/**
+ * Sizes and counts read from a header which do not fit into the storage set "failbit" instead of
+ * overflowing it.
+ */
+void testForgedHeaders()
+{
+    {
+        std::stringstream stream;
+        BinarySerializer::write(stream, vector<double>(10, 1.0));
+        bounded_vector<double,4> read;
+        BinarySerializer::read(stream, read);
+        BOOST_TEST(stream.fail());
+    }
+    {
+        std::stringstream stream;
+        BinarySerializer::write(stream, matrix<double>(5, 5, 1.0));
+        bounded_matrix<double,4,4> read;
+        BinarySerializer::read(stream, read);
+        BOOST_TEST(stream.fail());
+    }
+    {
+        compressed_vector<double> written(3);
+        written(0) = 1.0;
+        written(2) = 2.0;
+        std::ostringstream output;
+        BinarySerializer::write(output, written);
+        std::istringstream input(forgeSize(output.str(), 4, 100));
+        compressed_vector<double> read;
+        BinarySerializer::read(input, read);
+        BOOST_TEST(input.fail());
+    }
+    {
+        compressed_matrix<double> written(2, 2);
+        written(0, 1) = 1.0;
+        written(1, 0) = 2.0;
+        std::ostringstream output;
+        BinarySerializer::write(output, written);
+        std::istringstream input(forgeSize(output.str(), 5, 100));
+        compressed_matrix<double> read;
+        BinarySerializer::read(input, read);
+        BOOST_TEST(input.fail());
+    }
+    {
+        coordinate_matrix<double> written(2, 2);
+        written.append_element(0, 1, 1.0);
+        std::ostringstream output;
+        BinarySerializer::write(output, written);
+        std::istringstream input(forgeSize(output.str(), 4, 100));
+        coordinate_matrix<double> read;
+        BinarySerializer::read(input, read);
+        BOOST_TEST(input.fail());
+    }
+    {
+        std::ostringstream output;
+        BinarySerializer::write(output, matrix<double>(3, 3, 1.0));
+        std::istringstream input(output.str().substr(0, output.str().size() - 1));
+        matrix<double> read;
+        BinarySerializer::read(input, read);
+        BOOST_TEST(input.fail());
+    }
+}
+
+/**
+ * Reads a container from a serialized one whose header has a forged size field.
+ * @return Whether "failbit" has been set
+ */
+template<class Read, class Written>
+bool failsWithForgedSize(const Written& written, std::size_t field, boost::uint64_t value)
+{
+    std::ostringstream output;
+    BinarySerializer::write(output, written);
+    std::istringstream input(forgeSize(output.str(), field, value));
+    Read read;
+    BinarySerializer::read(input, read);
+    return input.fail();
+}
+
+/**
+ * Huge counts of mapped containers are read only as far as the stream goes, and packed sizes
+ * whose storage would overflow are refused before resizing; all of them set "failbit".
+ */
+void testCorruptedHeaders()
+{
+    const boost::uint64_t HUGE_SIZE = boost::uint64_t(1) << 40;
+
+    mapped_vector<double> vect(5);
+    vect(1) = 1.0;
+    vect(3) = 2.0;
+    BOOST_TEST(failsWithForgedSize< mapped_vector<double> >(vect, 4, HUGE_SIZE));
+    BOOST_TEST(failsWithForgedSize< mapped_vector<double> >(vect, 4, ~boost::uint64_t()));
+
+    mapped_matrix<double> matr(3, 3);
+    matr(0, 2) = 1.0;
+    BOOST_TEST(failsWithForgedSize< mapped_matrix<double> >(matr, 4, HUGE_SIZE));
+
+    triangular_matrix<double,lower> triangle(3, 3);
+    BOOST_TEST((failsWithForgedSize< triangular_matrix<double,lower> >(triangle, 0, HUGE_SIZE)));
+    BOOST_TEST((failsWithForgedSize< triangular_matrix<double,lower> >(triangle, 1, ~boost::uint64_t())));
+
+    symmetric_matrix<double> symmetric(3, 3);
+    BOOST_TEST(failsWithForgedSize< symmetric_matrix<double> >(symmetric, 0, HUGE_SIZE));
+
+    banded_matrix<double> banded(4, 4, 1, 1);
+    BOOST_TEST(failsWithForgedSize< banded_matrix<double> >(banded, 2, HUGE_SIZE));
+    BOOST_TEST(failsWithForgedSize< banded_matrix<double> >(banded, 3, ~boost::uint64_t()));
+    BOOST_TEST(failsWithForgedSize< banded_matrix<double> >(banded, 0, HUGE_SIZE));
+}
+
+} //namespace
+
+
+int main()
+{
+    testBandedRoundTrip<row_major>(5, 6, 1, 2);
+    testBandedRoundTrip<row_major>(6, 5, 2, 1);
+    testBandedRoundTrip<row_major>(4, 4, 1, 1);
+    testBandedRoundTrip<column_major>(5, 6, 1, 2);
+    testBandedRoundTrip<column_major>(6, 5, 2, 1);
+    testBandedRoundTrip<column_major>(4, 4, 0, 3);
+    testForgedHeaders();
+    testCorruptedHeaders();
+    return boost::report_errors();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoxMullerNormalDistribution.h"
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+
+/**
+ * 32-bit engine returning one value forever.
+ */
+class ConstantEngine {
+public:
+    typedef boost::uint32_t result_type;
+
+    inline explicit ConstantEngine(result_type value): value_(value) {}
+
+    inline result_type (min)() const
+    {
+        return 0;
+    }
+
+    inline result_type (max)() const
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    inline result_type operator()()
+    {
+        return value_;
+    }
+
+private:
+    result_type value_;
+};
+
+/**
+ * The largest raw values must not give u1 = 0 (and infinite or NaN variates), also when rounded to
+ * "float".
+ */
+template<class Real>
+void testExtremeRawValues()
+{
+    const boost::uint32_t VALUES[] = { 0u, 0xFFFFFF80u, 0xFFFFFFFEu, 0xFFFFFFFFu };
+    for (std::size_t v = 0; v < sizeof(VALUES) / sizeof(VALUES[0]); ++v)
+    {
+        ConstantEngine engine(VALUES[v]);
+        BoxMullerNormalDistribution<Real> dist;
+        for (int k = 0; k < 4; ++k)
+            BOOST_TEST((boost::math::isfinite)(dist(engine)));
+
+        Real batch[100];
+        dist.reset();
+        dist.generate(engine, batch, 100);
+        for (std::size_t k = 0; k < 100; ++k)
+            BOOST_TEST((boost::math::isfinite)(batch[k]));
+    }
+}
+
+/**
+ * generate() gives the same values as calls of operator().
+ */
+template<class Real>
+void testGenerateEqualsCalls()
+{
+    boost::mt19937 engine1(42),
+                   engine2(42);
+    BoxMullerNormalDistribution<Real> dist1(1, 2),
+                                      dist2(1, 2);
+    Real batch[1001];
+    dist1.generate(engine1, batch, 1001);
+    for (std::size_t k = 0; k < 1001; ++k)
+        BOOST_TEST_EQ(batch[k], dist2(engine2));
+}
+
+} //namespace
+
+
+int main()
+{
+    testExtremeRawValues<float>();
+    testExtremeRawValues<double>();
+    testGenerateEqualsCalls<float>();
+    testGenerateEqualsCalls<double>();
+    return boost::report_errors();
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedMatrixFile.h"
+#include "BinarySerializer.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+const char* const PATH = "MappedMatrixFileTest.bin";
+
+
+template<class Container>
+void writeFile(const Container& container)
+{
+    std::ofstream output(PATH, std::ios::binary);
+    BinarySerializer::write(output, container);
+}
+
+/**
+ * @return true if an array points into the mapping rather than to its own memory
+ */
+template<class Value>
+bool isMapped(const MappedMatrixFile& file, const Value* array)
+{
+    const char* data = reinterpret_cast<const char*>(array);
+    return data >= file.getData() && data < file.getData() + file.getSize();
+}
+
+
+/**
+ * A dense vector is attached without copying (its values follow the 72-byte header, so they are
+ * aligned); a matrix is not attached to it.
+ */
+void testVector()
+{
+    typedef MappedMatrixFile::Vector<double>::Answer Vector;
+    vector<double> written(5);
+    for (std::size_t k = 0; k < written.size(); ++k)
+        written(k) = double(k) - 1.5;
+    writeFile(written);
+
+    {
+        MappedMatrixFile file(PATH);
+        Vector attached;
+        BOOST_TEST(file.attach(attached));
+        BOOST_TEST_EQ(attached.size(), written.size());
+        for (std::size_t k = 0; k < written.size(); ++k)
+            BOOST_TEST_EQ(attached(k), written(k));
+        BOOST_TEST(isMapped(file, &attached.data()[0]));
+
+        MappedMatrixFile::Matrix<double>::Answer matr;
+        BOOST_TEST(!file.attach(matr));
+    }
+    std::remove(PATH);
+}
+
+/**
+ * A dense matrix is attached to a file of the same orientation only.
+ */
+template<class Orientation, class OtherOrientation>
+void testMatrix()
+{
+    typedef typename MappedMatrixFile::Matrix<double,Orientation>::Answer Matrix;
+    matrix<double,Orientation> written(3, 4);
+    for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t j = 0; j < 4; ++j)
+            written(i, j) = double(i * 4 + j) + 0.25;
+    writeFile(written);
+
+    {
+        MappedMatrixFile file(PATH);
+        Matrix attached;
+        BOOST_TEST(file.attach(attached));
+        BOOST_TEST_EQ(attached.size1(), 3u);
+        BOOST_TEST_EQ(attached.size2(), 4u);
+        for (std::size_t i = 0; i < 3; ++i)
+            for (std::size_t j = 0; j < 4; ++j)
+                BOOST_TEST_EQ(attached(i, j), written(i, j));
+        BOOST_TEST(isMapped(file, &attached.data()[0]));
+
+        typename MappedMatrixFile::Matrix<double,OtherOrientation>::Answer other;
+        BOOST_TEST(!file.attach(other));
+    }
+    std::remove(PATH);
+}
+
+
+/**
+ * A 6x6 CSR matrix with 32-bit indices and "count" non-zeros (count1 = 7, count2 = count). With odd
+ * count1 + count2 its doubles are not aligned in the file and must be copied, otherwise they are
+ * attached.
+ */
+void testCompressedMatrix(std::size_t count)
+{
+    typedef MappedMatrixFile::CompressedMatrix<double,row_major,boost::uint32_t>::Answer Matrix;
+    Matrix written(6, 6);
+    for (std::size_t k = 0; k < count; ++k)
+        written(k * 7 % 36 / 6, k * 7 % 36 % 6) = double(k) + 0.5;
+    writeFile(written);
+
+    {
+        MappedMatrixFile file(PATH);
+        Matrix attached;
+        BOOST_TEST(file.attach(attached));
+        BOOST_TEST_EQ(attached.nnz(), written.nnz());
+        for (std::size_t i = 0; i < 6; ++i)
+            for (std::size_t j = 0; j < 6; ++j)
+                BOOST_TEST_EQ(attached(i, j), written(i, j));
+
+        BOOST_TEST_EQ(isMapped(file, &attached.value_data()[0]), (7 + count) % 2 == 0);
+    }
+    std::remove(PATH);
+}
+
+/**
+ * A compressed matrix is not attached if its header claims more non-zeros than the matrix can hold
+ * (they used to be copied past the reserved storage), even if the file is long enough.
+ */
+void testForgedCompressedMatrix()
+{
+    typedef MappedMatrixFile::CompressedMatrix<double,row_major,boost::uint32_t>::Answer Matrix;
+    Matrix written(2, 2);
+    written(0, 1) = 1.0;
+    written(1, 0) = 2.0;
+    std::ostringstream output;
+    BinarySerializer::write(output, written);
+
+    std::string bytes = output.str();
+    boost::uint64_t count2 = 40;
+    std::memcpy(&bytes[64], &count2, sizeof(count2));
+    bytes.resize(bytes.size() + count2 * (sizeof(boost::uint32_t) + sizeof(double)));
+    {
+        std::ofstream forged(PATH, std::ios::binary);
+        forged.write(bytes.data(), bytes.size());
+    }
+
+    {
+        MappedMatrixFile file(PATH);
+        Matrix attached;
+        BOOST_TEST(!file.attach(attached));
+    }
+    std::remove(PATH);
+}
+
+} //namespace
+
+
+int main()
+{
+    testCompressedMatrix(8);
+    testCompressedMatrix(10);
+    testCompressedMatrix(9);
+    testForgedCompressedMatrix();
+    testVector();
+    testMatrix<row_major,column_major>();
+    testMatrix<column_major,row_major>();
+    return boost::report_errors();
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelMatrixNiceOutputer.h"
+#include <cstddef>
+#include <ios>
+#include <sstream>
+#include <streambuf>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+const unsigned THREAD_COUNTS[] = { 1, 2, 3, 4, 7 };
+
+
+/**
+ * Stream buffer accepting "limit" characters and failing after them.
+ */
+class FailingStreambuf: public std::streambuf {
+public:
+
+    inline explicit FailingStreambuf(std::size_t limit): left_(limit) {}
+
+protected:
+
+    int_type overflow(int_type ch)
+    {
+        if (left_ == 0)
+            return traits_type::eof();
+        --left_;
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count)
+    {
+        std::streamsize accepted = count < std::streamsize(left_) ? count : std::streamsize(left_);
+        left_ -= std::size_t(accepted);
+        return accepted;
+    }
+
+private:
+
+    std::size_t left_;
+};
+
+
+/**
+ * A matrix of several blocks whose elements have text of different widths.
+ */
+matrix<double> makeMatrix()
+{
+    matrix<double> matr(300, 1000);
+    for (std::size_t i = 0; i < matr.size1(); ++i)
+        for (std::size_t j = 0; j < matr.size2(); ++j)
+            matr(i, j) = double((i * 7919 + j * 104729) % 100003) / double(j % 13 + 1) - 50.0;
+    return matr;
+}
+
+/**
+ * Text is the same byte for byte as the one of MatrixNiceOutputer whatever number of threads is
+ * used.
+ */
+void testSameAsSerial(const matrix<double>& matr, MatrixNiceOutputer::ElementPlacing placing)
+{
+    std::ostringstream serial;
+    MatrixNiceOutputer(placing, 2)(serial, matr);
+    for (std::size_t k = 0; k < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); ++k)
+    {
+        ParallelRunner::setThreadCount(THREAD_COUNTS[k]);
+        std::ostringstream parallel;
+        ParallelMatrixNiceOutputer(placing, 2)(parallel, matr);
+        BOOST_TEST(parallel.str() == serial.str());
+    }
+}
+
+/**
+ * A failing stream makes the call throw after all threads have finished.
+ */
+void testFailingStream(const matrix<double>& matr, MatrixNiceOutputer::ElementPlacing placing)
+{
+    ParallelRunner::setThreadCount(4);
+    FailingStreambuf buffer(100000);
+    std::ostream output(&buffer);
+    output.exceptions(std::ios_base::badbit);
+    ParallelMatrixNiceOutputer outputer(placing);
+    BOOST_TEST_THROWS(outputer(output, matr), std::ios_base::failure);
+}
+
+} //namespace
+
+
+int main()
+{
+    matrix<double> matr = makeMatrix();
+    testSameAsSerial(matr, MatrixNiceOutputer::SIMPLE);
+    testSameAsSerial(matr, MatrixNiceOutputer::BY_COLUMNS);
+    testSameAsSerial(matr, MatrixNiceOutputer::BY_EQUALWIDTH_COLUMNS);
+    testSameAsSerial(matr, MatrixNiceOutputer::BY_STREAMED_COLUMNS);
+    testSameAsSerial(matr, MatrixNiceOutputer::COORDINATE_LIST);
+    testSameAsSerial(matr, MatrixNiceOutputer::COMPACT_ROWS);
+    testFailingStream(matr, MatrixNiceOutputer::SIMPLE);
+    testFailingStream(matr, MatrixNiceOutputer::BY_COLUMNS);
+    return boost::report_errors();
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RandomGenerator.h"
+#include <cstddef>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/numeric/ublas/banded.hpp>
+#include <boost/numeric/ublas/symmetric.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+typedef RandomGenerator<boost::mt19937, boost::uniform_real<double> > Generator;
+
+
+/**
+ * Compares every streamed tile with the corresponding part of a matrix generated whole.
+ */
+template<class Matrix>
+class TileComparer {
+public:
+
+    inline explicit TileComparer(const Matrix& whole): whole_(&whole) {}
+
+    void operator()(std::size_t first1, std::size_t first2, const matrix<double>& tile) const
+    {
+        for (std::size_t i = 0; i < tile.size1(); ++i)
+            for (std::size_t j = 0; j < tile.size2(); ++j)
+                BOOST_TEST_EQ(tile(i, j), (*whole_)(first1 + i, first2 + j));
+    }
+
+private:
+
+    const Matrix* whole_;
+};
+
+
+/**
+ * Elements a matrix stores as a dense matrix. Only the lower part of a symmetric matrix is
+ * streamed, the upper one and unit diagonals are zeros.
+ */
+template<class Matrix>
+matrix<double> getStored(const Matrix& whole)
+{
+    return matrix<double>(whole);
+}
+
+template<class Orientation>
+matrix<double> getStored(const triangular_matrix<double,unit_upper,Orientation>& whole)
+{
+    return matrix<double>(whole) - identity_matrix<double>(whole.size1());
+}
+
+template<class Triangle, class Orientation>
+matrix<double> getStored(const symmetric_matrix<double,Triangle,Orientation>& whole)
+{
+    return matrix<double>(triangular_adaptor<const symmetric_matrix<double,Triangle,Orientation>,
+                                             lower>(whole));
+}
+
+/**
+ * Streamed tiles of a sequential engine hold the values "operator()" puts into a matrix of the
+ * same shape for the same seed in either fill order.
+ */
+template<class Matrix>
+void testStreamMatches(Matrix whole, const MatrixShape<Matrix>& shape, std::size_t tileSize1,
+                       std::size_t tileSize2, FillOrder::Order order = FillOrder::BY_STORAGE)
+{
+    FillOrder::setOrder(order);
+    {
+        boost::mt19937 engine(5);
+        Generator generator(engine, boost::uniform_real<double>(0, 1));
+        generator(whole);
+    }
+
+    boost::mt19937 engine(5);
+    Generator generator(engine, boost::uniform_real<double>(0, 1));
+    matrix<double> stored = getStored(whole);
+    TileComparer< matrix<double> > comparer(stored);
+    generator.stream(shape, tileSize1, tileSize2, comparer);
+    FillOrder::setOrder(FillOrder::BY_STORAGE);
+}
+
+template<class Orientation>
+void testStreamMatchesWholeMatrix(std::size_t size1, std::size_t size2,
+                                  std::size_t tileSize1, std::size_t tileSize2, FillOrder::Order order)
+{
+    typedef matrix<double,Orientation> Matrix;
+    testStreamMatches(Matrix(size1, size2), MatrixShape<Matrix>(size1, size2), tileSize1, tileSize2,
+                      order);
+}
+
+/**
+ * Column-major triangular, symmetric and banded matrices are streamed by column strips in the
+ * default order, and tiles still match the matrices.
+ */
+void testStreamMatchesColumnMajorShapes()
+{
+    typedef triangular_matrix<double,lower,column_major> Lower;
+    testStreamMatches(Lower(8, 8), MatrixShape<Lower>(8, 8), 3, 2);
+    typedef triangular_matrix<double,unit_upper,column_major> UnitUpper;
+    testStreamMatches(UnitUpper(7, 7), MatrixShape<UnitUpper>(7, 7), 7, 3);
+    typedef symmetric_matrix<double,lower,column_major> Symmetric;
+    testStreamMatches(Symmetric(9, 9), MatrixShape<Symmetric>(9, 9), 4, 4);
+    typedef symmetric_matrix<double,upper,row_major> UpperSymmetric;
+    testStreamMatches(UpperSymmetric(6, 6), MatrixShape<UpperSymmetric>(6, 6), 2, 5);
+    typedef banded_matrix<double,column_major> Banded;
+    testStreamMatches(Banded(9, 7, 2, 1), MatrixShape<Banded>(9, 7, 2, 1), 4, 3);
+    testStreamMatches(Banded(9, 7, 2, 1), MatrixShape<Banded>(9, 7, 2, 1), 4, 3, FillOrder::BY_ROWS);
+}
+
+/**
+ * In the default order a column-major matrix is filled along its storage: it gets the elements of
+ * the transposed row-major matrix for the same seed.
+ */
+void testColumnMajorFilledByStorage(std::size_t size1, std::size_t size2)
+{
+    matrix<double,column_major> columns(size1, size2);
+    matrix<double,row_major> rows(size2, size1);
+    {
+        boost::mt19937 engine(5);
+        Generator(engine, boost::uniform_real<double>(0, 1))(columns);
+    }
+    {
+        boost::mt19937 engine(5);
+        Generator(engine, boost::uniform_real<double>(0, 1))(rows);
+    }
+    for (std::size_t i = 0; i < size1; ++i)
+        for (std::size_t j = 0; j < size2; ++j)
+            BOOST_TEST_EQ(columns(i, j), rows(j, i));
+}
+
+/**
+ * Zero tile sizes are rejected whatever NDEBUG is (they used to make streaming loop forever).
+ */
+void testStreamRejectsZeroTiles()
+{
+    matrix<double> whole(2, 2);
+    boost::mt19937 engine(5);
+    Generator generator(engine, boost::uniform_real<double>(0, 1));
+    TileComparer< matrix<double> > comparer(whole);
+    BOOST_TEST_THROWS(generator.stream(MatrixShape< matrix<double> >(2, 2), 0, 1, comparer), bad_argument);
+    BOOST_TEST_THROWS(generator.stream(MatrixShape< matrix<double> >(2, 2), 1, 0, comparer), bad_argument);
+}
+
+} //namespace
+
+
+int main()
+{
+    testStreamMatchesWholeMatrix<row_major>(7, 9, 3, 4, FillOrder::BY_STORAGE);
+    testStreamMatchesWholeMatrix<row_major>(7, 9, 3, 4, FillOrder::BY_ROWS);
+    testStreamMatchesWholeMatrix<column_major>(7, 9, 3, 4, FillOrder::BY_ROWS);
+    testStreamMatchesWholeMatrix<column_major>(9, 7, 9, 1, FillOrder::BY_ROWS);
+    testStreamMatchesWholeMatrix<column_major>(7, 9, 3, 4, FillOrder::BY_STORAGE);
+    testStreamMatchesColumnMajorShapes();
+    testColumnMajorFilledByStorage(7, 9);
+    testStreamRejectsZeroTiles();
+    return boost::report_errors();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) Anton Liaukevich 2009 <leva.dev@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlockDiagonalPattern.h"
+#include "DiagonalsPattern.h"
+#include "RandomGenerator.h"
+#include "StencilPattern.h"
+#include <cstddef>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/numeric/ublas/matrix_sparse.hpp>
+
+namespace {
+
+using namespace boost::numeric::ublas;
+
+typedef RandomGenerator<boost::mt19937, boost::uniform_real<double> > Generator;
+
+
+/**
+ * Generates a matrix by a pattern and checks number of its non-zeros.
+ */
+template<class Pattern>
+void testNonZeroCount(const Pattern& pattern, std::size_t size1, std::size_t size2, std::size_t count)
+{
+    BOOST_TEST_EQ(pattern.getNonZeroCount(size1, size2), count);
+    compressed_matrix<double> matr(size1, size2);
+    boost::mt19937 engine(5);
+    Generator(engine, boost::uniform_real<double>(1, 2))(matr, pattern);
+    BOOST_TEST_EQ(matr.nnz(), count);
+}
+
+/**
+ * Two integers of any type make a band, not a range of offsets (they used to give one diagonal).
+ */
+template<class Integer>
+void testBandOfIntegers(Integer lower, Integer upper, std::size_t count)
+{
+    DiagonalsPattern pattern(lower, upper);
+    BOOST_TEST_EQ(pattern.getOffsets().size(), std::size_t(lower + upper + 1));
+    for (std::size_t k = 0; k < pattern.getOffsets().size(); ++k)
+        BOOST_TEST_EQ(pattern.getOffsets()[k], DiagonalsPattern::Offset(k) - DiagonalsPattern::Offset(lower));
+    testNonZeroCount(pattern, 50, 60, count);
+}
+
+/**
+ * A range of offsets is sorted and cleared of repetitions.
+ */
+void testRangeOfOffsets()
+{
+    const int offsets[] = { 3, -1, 3, 0 };
+    DiagonalsPattern pattern(offsets, offsets + 4);
+    BOOST_TEST_EQ(pattern.getOffsets().size(), 3u);
+    BOOST_TEST_EQ(pattern.getOffsets()[0], -1);
+    BOOST_TEST_EQ(pattern.getOffsets()[1], 0);
+    BOOST_TEST_EQ(pattern.getOffsets()[2], 3);
+    testNonZeroCount(pattern, 50, 60, 49 + 50 + 50);
+}
+
+/**
+ * Invalid arguments are rejected whatever NDEBUG is: zero block size used to make counting loop
+ * forever, and a stencil used to write past storage of a matrix of a wrong size.
+ */
+void testInvalidArguments()
+{
+    BOOST_TEST_THROWS(BlockDiagonalPattern(0), bad_argument);
+    testNonZeroCount(BlockDiagonalPattern(4), 10, 10, 4 * 4 + 4 * 4 + 2 * 2);
+
+    StencilPattern stencil(StencilPattern::FIVE_POINT, 4, 3);
+    testNonZeroCount(stencil, 12, 12, 12 + 2 * 3 * 3 + 2 * 4 * 2);
+    compressed_matrix<double> matr(10, 10);
+    boost::mt19937 engine(5);
+    Generator generator(engine, boost::uniform_real<double>(1, 2));
+    BOOST_TEST_THROWS(generator(matr, stencil), bad_size);
+    BOOST_TEST_THROWS(stencil.getNonZeroCount(12, 13), bad_size);
+}
+
+} //namespace
+
+
+int main()
+{
+    testBandOfIntegers(2, 3, 297);
+    testBandOfIntegers(1, 1, 149);
+    testBandOfIntegers(std::size_t(2), std::size_t(3), 297);
+    testBandOfIntegers(short(0), short(0), 50);
+    testRangeOfOffsets();
+    testInvalidArguments();
+    return boost::report_errors();
+}